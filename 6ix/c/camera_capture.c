@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+* @file camera_capture.c
+* @brief JPEG viewfinder frames handed to one waiting caller at a time.
+*
+* The viewfinder callback only copies a frame while a grab is waiting for
+* one, so an idle library costs nothing beyond the running viewfinder. The
+* copy goes straight into the caller's buffer and the grab returns as soon
+* as the callback signals it.
+*/
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <camera/camera_api.h>
+#include "camera_capture.h"
+
+/* --- The grab currently waiting for a frame. --- */
+typedef struct {
+    uint8_t *buf;
+    size_t capacity;
+    size_t size;
+    int status;
+    bool pending;               /* cleared by the callback once it has answered */
+} grab_request_t;
+
+static pthread_mutex_t g_capture_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t g_grab_mutex = PTHREAD_MUTEX_INITIALIZER;  /* one grab at a time */
+static pthread_cond_t g_frame_cond;
+static camera_handle_t g_capture_handle = CAMERA_HANDLE_INVALID;
+static size_t g_max_jpeg_size = 0;
+static grab_request_t g_request;
+
+static void deliverFrame(camera_handle_t handle, camera_buffer_t *buffer, void *arg)
+{
+    size_t size;
+
+    (void)handle;
+    (void)arg;
+
+    if (buffer->frametype != CAMERA_FRAMETYPE_JPEG) {
+        return;
+    }
+
+    // Never hold up the camera: if a grab is just being set up, the next frame will do
+    if (pthread_mutex_trylock(&g_capture_mutex) != 0) {
+        return;
+    }
+
+    if (g_request.pending) {
+        size = buffer->framedesc.jpeg.bufsize;
+        g_request.size = size;
+        if ((size == 0) || (size > g_request.capacity)) {
+            g_request.status = CAPTURE_BUFFER_TOO_SMALL;
+        } else {
+            memcpy(g_request.buf, buffer->framebuf, size);
+            g_request.status = CAPTURE_SUCCESS;
+        }
+        g_request.pending = false;
+        pthread_cond_signal(&g_frame_cond);
+    }
+
+    pthread_mutex_unlock(&g_capture_mutex);
+}
+
+int camera_capture_open(int unit, uint32_t width, uint32_t height)
+{
+    pthread_condattr_t attr;
+    camera_frametype_t frametype = CAMERA_FRAMETYPE_UNSPECIFIED;
+    int err;
+
+    pthread_mutex_lock(&g_capture_mutex);
+    if (g_capture_handle != CAMERA_HANDLE_INVALID) {
+        pthread_mutex_unlock(&g_capture_mutex);
+        return CAPTURE_FAILURE;
+    }
+
+    err = camera_open((camera_unit_t)unit, CAMERA_MODE_RO, &g_capture_handle);
+    if ((err != CAMERA_EOK) || (g_capture_handle == CAMERA_HANDLE_INVALID)) {
+        printf("Failed to open CAMERA_UNIT_%d: err = %d\n", unit, err);
+        g_capture_handle = CAMERA_HANDLE_INVALID;
+        pthread_mutex_unlock(&g_capture_mutex);
+        return CAPTURE_FAILURE;
+    }
+
+    // The camera encodes each viewfinder frame, so there is nothing to convert here
+    err = camera_set_vf_property(g_capture_handle, CAMERA_IMGPROP_FORMAT, CAMERA_FRAMETYPE_JPEG);
+    if ((err == CAMERA_EOK) && (width != 0) && (height != 0)) {
+        err = camera_set_vf_property(g_capture_handle,
+                                     CAMERA_IMGPROP_WIDTH, width,
+                                     CAMERA_IMGPROP_HEIGHT, height);
+        if (err != CAMERA_EOK) {
+            printf("Camera does not support a %ux%u viewfinder: err = %d\n", width, height, err);
+        }
+    }
+    if (err == CAMERA_EOK) {
+        width = 0;
+        height = 0;
+        err = camera_get_vf_property(g_capture_handle,
+                                     CAMERA_IMGPROP_FORMAT, &frametype,
+                                     CAMERA_IMGPROP_WIDTH, &width,
+                                     CAMERA_IMGPROP_HEIGHT, &height);
+    }
+    if ((err != CAMERA_EOK) || (frametype != CAMERA_FRAMETYPE_JPEG) || (width == 0) || (height == 0)) {
+        printf("Camera does not provide JPEG viewfinder frames: err = %d\n", err);
+        camera_close(g_capture_handle);
+        g_capture_handle = CAMERA_HANDLE_INVALID;
+        pthread_mutex_unlock(&g_capture_mutex);
+        return CAPTURE_FAILURE;
+    }
+
+    // Room for the YUV422 frame the JPEG came from. Real JPEGs are far
+    // smaller, but nothing guarantees it, so grabs still check bufsize.
+    g_max_jpeg_size = (size_t)width * height * 2;
+
+    // Grab timeouts are CLOCK_MONOTONIC deadlines
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_frame_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    memset(&g_request, 0, sizeof(g_request));
+
+    err = camera_start_viewfinder(g_capture_handle, deliverFrame, NULL, NULL);
+    if (err != CAMERA_EOK) {
+        printf("Failed to start CAMERA_UNIT_%d: err = %d\n", unit, err);
+        pthread_cond_destroy(&g_frame_cond);
+        camera_close(g_capture_handle);
+        g_capture_handle = CAMERA_HANDLE_INVALID;
+        g_max_jpeg_size = 0;
+        pthread_mutex_unlock(&g_capture_mutex);
+        return CAPTURE_FAILURE;
+    }
+
+    pthread_mutex_unlock(&g_capture_mutex);
+    return CAPTURE_SUCCESS;
+}
+
+size_t camera_capture_max_jpeg_size(void)
+{
+    size_t size;
+
+    pthread_mutex_lock(&g_capture_mutex);
+    size = g_max_jpeg_size;
+    pthread_mutex_unlock(&g_capture_mutex);
+    return size;
+}
+
+int camera_capture_grab_jpeg(uint8_t *buf, size_t capacity, size_t *size, uint32_t timeout_ms)
+{
+    struct timespec deadline;
+    int status;
+    int err = 0;
+
+    if ((buf == NULL) || (size == NULL)) {
+        return CAPTURE_FAILURE;
+    }
+    *size = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    deadline.tv_sec += (timeout_ms / 1000) + (deadline.tv_nsec / 1000000000L);
+    deadline.tv_nsec %= 1000000000L;
+
+    pthread_mutex_lock(&g_grab_mutex);
+    pthread_mutex_lock(&g_capture_mutex);
+
+    if (g_capture_handle == CAMERA_HANDLE_INVALID) {
+        pthread_mutex_unlock(&g_capture_mutex);
+        pthread_mutex_unlock(&g_grab_mutex);
+        return CAPTURE_FAILURE;
+    }
+
+    // The callback fills the caller's buffer directly
+    g_request.buf = buf;
+    g_request.capacity = capacity;
+    g_request.size = 0;
+    g_request.status = CAPTURE_TIMEOUT;
+    g_request.pending = true;
+
+    while (g_request.pending && (err != ETIMEDOUT)) {
+        if (timeout_ms == 0) {
+            err = pthread_cond_wait(&g_frame_cond, &g_capture_mutex);
+        } else {
+            err = pthread_cond_timedwait(&g_frame_cond, &g_capture_mutex, &deadline);
+        }
+    }
+
+    // On a timeout the request is withdrawn under the mutex, so a late
+    // frame can't be copied into a buffer the caller has already reused
+    g_request.pending = false;
+    status = g_request.status;
+    *size = g_request.size;
+
+    pthread_mutex_unlock(&g_capture_mutex);
+    pthread_mutex_unlock(&g_grab_mutex);
+    return status;
+}
+
+void camera_capture_close(void)
+{
+    camera_handle_t handle;
+
+    // No grab can be in progress, and none can start, while the viewfinder stops
+    pthread_mutex_lock(&g_grab_mutex);
+    pthread_mutex_lock(&g_capture_mutex);
+    handle = g_capture_handle;
+    g_capture_handle = CAMERA_HANDLE_INVALID;
+    g_max_jpeg_size = 0;
+    pthread_mutex_unlock(&g_capture_mutex);
+
+    // The callback takes g_capture_mutex, so it must be free while stopping
+    if (handle != CAMERA_HANDLE_INVALID) {
+        camera_stop_viewfinder(handle);
+        camera_close(handle);
+        pthread_cond_destroy(&g_frame_cond);
+    }
+    pthread_mutex_unlock(&g_grab_mutex);
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+* @file camera_capture.h
+* @brief In-process still capture for Python callers, built as a shared library.
+*
+* The camera runs its JPEG viewfinder for as long as the library is open, so
+* a grab only waits for the next frame and copies it into the caller's
+* buffer; nothing is spawned, written to disk or converted off-device. All
+* functions are plain C with fixed-width arguments so they can be called
+* through ctypes:
+*
+*     qcc -Vgcc_ntoaarch64le -shared -fPIC -o libcamera_capture.so camera_capture.c -lcamapi
+*
+* One camera is open at a time. Grabs may come from any thread; they are
+* serialized internally.
+*/
+
+#ifndef CAMERA_CAPTURE_H
+#define CAMERA_CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Return Codes */
+#define CAPTURE_SUCCESS 0
+#define CAPTURE_FAILURE -1
+#define CAPTURE_TIMEOUT -2
+#define CAPTURE_BUFFER_TOO_SMALL -3
+
+/**
+* @brief Opens the camera unit and starts its JPEG viewfinder. A smaller
+*        resolution is applied before the camera's encoder, which is the
+*        cheapest place to downscale an upload.
+*
+* @param unit camera unit, as listed by camera_client without -u
+* @param width viewfinder width, 0 together with height keeps the camera default
+* @param height viewfinder height
+* @return int CAPTURE_SUCCESS on success, CAPTURE_FAILURE if the camera can't
+*         be opened, has no JPEG viewfinder or another unit is already open.
+*/
+int camera_capture_open(int unit, uint32_t width, uint32_t height);
+
+/**
+* @brief Suggested buffer size for camera_capture_grab_jpeg. It has room for
+*        an uncompressed YUV422 frame, which real images stay well under; a
+*        larger one is reported as CAPTURE_BUFFER_TOO_SMALL with its size.
+*
+* @return size_t suggested buffer size in bytes, 0 if not open.
+*/
+size_t camera_capture_max_jpeg_size(void);
+
+/**
+* @brief Copies the next viewfinder frame into buf. Frames that arrived
+*        before the call are never returned, so the image is taken after
+*        the button press that asked for it.
+*
+* @param buf destination for the JPEG image
+* @param capacity size of buf
+* @param size receives the image size, or the size needed if buf is too small
+* @param timeout_ms how long to wait for a frame, 0 to wait forever
+* @return int CAPTURE_SUCCESS, CAPTURE_TIMEOUT, CAPTURE_BUFFER_TOO_SMALL or
+*         CAPTURE_FAILURE if the camera isn't open.
+*/
+int camera_capture_grab_jpeg(uint8_t *buf, size_t capacity, size_t *size, uint32_t timeout_ms);
+
+/**
+* @brief Stops the viewfinder and closes the camera.
+*/
+void camera_capture_close(void);
+
+#endif /* CAMERA_CAPTURE_H */
@@ -19,16 +19,29 @@
 #include <unistd.h>
 #include <string.h>
 #include <time.h>
+#include <signal.h>
 #include <termios.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
 #include <sys/time.h>
 
 #include <camera/camera_api.h>
 #include "rainbowhat.h"
+#include "stream_protocol.h"
+#include "frame_preprocess.h"
+#include "trace.h"
+#include "recording_segment.h"
 
 /**
  * @brief Number of channels for supported frametypes
@@ -36,15 +49,63 @@
 #define NUM_CHANNELS (3)
 
 /**
- * @brief Maximum number of frames to buffer during recording
+ * @brief Number of frames queued between the camera callback and the sender
+ *        thread (must be a power of two)
  */
-#define MAX_FRAME_BUFFER 1000
+#define FRAME_RING_SIZE 32
+
+/**
+ * @brief Upper bound on the memory reserved up front for recorded frames
+ */
+#define FRAME_POOL_MAX_BYTES (512UL * 1024UL * 1024UL)
+
+/**
+ * @brief How long framePoolInit() waits for the first viewfinder frame
+ */
+#define FRAME_POOL_PROBE_TIMEOUT_S 5
+
+/**
+ * @brief Minimum time between display refreshes (10 Hz)
+ */
+#define UI_REFRESH_INTERVAL_US 100000
+
+/**
+ * @brief Minimum time between reports of dropped frames (1 Hz)
+ */
+#define DROP_REPORT_INTERVAL_NS 1000000000ULL
 
 /**
  * @brief Server configuration for sending data
  */
 #define SERVER_IP "192.168.1.100"  // Update with your processing server IP
-#define SERVER_PORT 8080
+#define SERVER_PORT STREAM_PROTOCOL_DEFAULT_PORT
+
+/**
+ * @brief How long connectToServer() waits for the server to accept
+ */
+#define CONNECT_TIMEOUT_MS 2000
+
+/**
+ * @brief Socket send buffer requested for streaming, enough for a few frames in flight
+ */
+#define SOCKET_SEND_BUFFER_SIZE (4 * 1024 * 1024)
+
+/**
+ * @brief Space reserved on disk for one recording with -r
+ */
+#define RECORDING_SEGMENT_BYTES (1024ULL * 1024ULL * 1024ULL)
+#define RECORDING_SEGMENT_FRAMES 65536
+
+/**
+ * @brief How long a send may stall before the connection is given up
+ */
+#define SEND_TIMEOUT_S 5
+
+/**
+ * @brief Reconnect attempts for a recording upload and the delay between them
+ */
+#define UPLOAD_RETRY_LIMIT 5
+#define UPLOAD_RETRY_DELAY_US 1000000
 
 /**
  * @brief List of frametypes that @c processCameraData can operate on
@@ -57,6 +118,16 @@ const camera_frametype_t cSupportedFrametypes[] = {
 };
 #define NUM_SUPPORTED_FRAMETYPES (sizeof(cSupportedFrametypes) / sizeof(cSupportedFrametypes[0]))
 
+/**
+ * @brief What the client records and uploads. The compressed modes send
+ *        encoder output as-is so the server only has to remux it.
+ */
+typedef enum {
+    CAPTURE_MODE_RAW,   /* viewfinder frames, optionally preprocessed */
+    CAPTURE_MODE_H264,  /* camera encoder bitstream */
+    CAPTURE_MODE_JPEG,  /* one JPEG per viewfinder frame */
+} capture_mode_t;
+
 /**
  * @brief Structure to hold frame data during recording
  */
@@ -64,8 +135,77 @@ typedef struct {
     uint8_t* data;
     size_t size;
     struct timeval timestamp;
+    uint32_t frametype;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    uint64_t enqueue_ns;        /* trace clock when the frame entered the ring */
 } frame_data_t;
 
+/**
+ * @brief Fixed-size frame slots carved out of a single arena, allocated once
+ *        before the viewfinder starts. Slot i always backs ring entry i.
+ */
+typedef struct {
+    uint8_t* arena;
+    size_t slot_size;
+    unsigned int num_slots;
+} frame_pool_t;
+
+/**
+ * @brief Layout of the first viewfinder frame. The viewfinder properties
+ *        don't report stride or buffer size, so the frame pool is sized
+ *        from a real buffer instead.
+ */
+typedef struct {
+    camera_frametype_t frametype;
+    preprocess_format_t format;     /* raw frames only */
+    size_t size;                    /* bytes one frame needs in a pool slot */
+} vf_probe_t;
+
+/**
+ * @brief Lock-free SPSC queue of recorded frames. Only the capture callback
+ *        advances @c head and only the sender thread advances @c tail. An
+ *        entry with a zero size marks the end of a recording session; the
+ *        button thread only requests it, see @c g_end_requested.
+ */
+typedef struct {
+    frame_data_t frames[FRAME_RING_SIZE];
+    unsigned int mask;
+    atomic_uint head;
+    atomic_uint tail;
+} frame_ring_t;
+
+/**
+ * @brief Hand-off between the sender thread spilling a recording and the
+ *        uploader thread streaming it live. The sender only appends to the
+ *        segment and publishes @c committed; the uploader sends frames from
+ *        the mapping up to it, so a stalled link never holds up the spill.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    uint32_t committed;         /* frames appended to the segment so far */
+    bool ended;                 /* the recording has stopped */
+    int socket_fd;              /* left open by the uploader, or -1 */
+    uint32_t frames_sent;
+} live_upload_t;
+
+/**
+ * @brief Status shown on the alphanumeric display and RGB LEDs. Threads post
+ *        updates here and the UI thread applies the latest one at most every
+ *        @c UI_REFRESH_INTERVAL_US, so slow HAT I/O never runs on the capture
+ *        or network paths.
+ */
+typedef struct {
+    char text[5];
+    bool show_frame_count;
+    uint8_t rgb[3];
+    uint8_t brightness;
+    unsigned int rgb_version;
+    uint64_t posted_ns;         /* trace clock of the last text update */
+} ui_status_t;
+
 /**
  * @brief Structure to hold environment data
  */
@@ -80,24 +220,81 @@ typedef struct {
 /**
  * @brief Global variables for recording state
  */
-static bool g_recording = false;
-static frame_data_t g_frame_buffer[MAX_FRAME_BUFFER];
-static int g_frame_count = 0;
+static atomic_bool g_recording = false;
+static atomic_bool g_session_active = false;
+static atomic_bool g_segment_pending = false;
+static atomic_bool g_end_requested = false;
+static atomic_int g_frame_count = 0;
+static atomic_uint g_frames_dropped = 0;
+static atomic_uint g_frames_oversized = 0;
 static environment_data_t g_env_data;
-static pthread_mutex_t g_recording_mutex = PTHREAD_MUTEX_INITIALIZER;
+static frame_pool_t g_frame_pool;
+static vf_probe_t g_vf_probe;
+static atomic_bool g_vf_probed = false;
+static sem_t g_vf_probe_ready;
+static frame_ring_t g_frame_ring;
+static sem_t g_frames_ready;
+static sem_t g_session_start;
+static pthread_mutex_t g_env_mutex = PTHREAD_MUTEX_INITIALIZER;
+static ui_status_t g_ui_status;
+static pthread_mutex_t g_ui_mutex = PTHREAD_MUTEX_INITIALIZER;
 static camera_handle_t g_camera_handle = CAMERA_HANDLE_INVALID;
+static preprocess_config_t g_preprocess = { .luma_only = false, .decimation = 1, .target_fps = 0 };
+static capture_mode_t g_capture_mode = CAPTURE_MODE_RAW;
+static uint32_t g_vf_width = 0;
+static uint32_t g_vf_height = 0;
+static const char* g_trace_path = NULL;
+static const char* g_segment_path = NULL;
+static segment_t g_segment = { .fd = -1, .map = MAP_FAILED };
+static live_upload_t g_live_upload = { .lock = PTHREAD_MUTEX_INITIALIZER, .changed = PTHREAD_COND_INITIALIZER };
 
 /**
  * @brief Function prototypes
  */
 static void listAvailableCameras(void);
 static void processCameraData(camera_handle_t handle, camera_buffer_t* buffer, void* arg);
+static void processEncodedData(camera_handle_t handle, camera_buffer_t* buffer, void* arg);
+static void queueEncodedFrame(const camera_buffer_t* buffer, uint32_t wire_frametype, size_t size,
+                              const struct timeval* timestamp);
+static void queueEndOfStream(void);
+static int configureCaptureMode(void);
 static void* buttonMonitorThread(void* arg);
-static int sendDataToServer(void);
+static void* senderThread(void* arg);
+static void* uiRefreshThread(void* arg);
+static void uiSetText(const char* text, bool show_frame_count);
+static void uiSetRgb(uint8_t r, uint8_t g, uint8_t b, uint8_t brightness);
+static int connectToServer(void);
+static int sendFrame(int socket_fd, const frame_data_t* frame);
+static int sendAll(int socket_fd, struct iovec* iov, int iovcnt);
+static int recvAll(int socket_fd, void* buf, size_t len);
+static uint64_t hostToNet64(uint64_t value);
+static uint64_t timevalToMicros(const struct timeval* tv);
+static int streamSession(void);
+static int sendSessionHeader(int socket_fd, int32_t temperature_centi, uint32_t pressure_centi,
+                             uint64_t button_press_time_us, uint32_t flags, uint32_t session_id);
+static int sendEndOfStream(int socket_fd, uint64_t button_release_time_us);
+static int sendSegmentFrame(int socket_fd, const segment_t* segment, uint32_t index);
+static int sendSegmentEntry(int socket_fd, const segment_entry_t* entry, const uint8_t* data);
+static int recordSession(void);
+static void* uploaderThread(void* arg);
+static void liveUploadPublish(uint32_t committed, bool ended);
+static int resumeUpload(const segment_t* segment, uint32_t* next_frame);
+static int uploadSegment(segment_t* segment, int socket_fd, uint32_t next_frame);
+static int recoverSegment(void);
+static void prepareSegment(void);
 static int receiveAnalysisResult(int socket_fd, char* result);
 static void displayResult(const char* result);
 static void initializeHardware(void);
 static void cleanupHardware(void);
+static int framePoolInit(void);
+static void probeViewfinder(const camera_buffer_t* buffer);
+static bool bufferLayout(const camera_buffer_t* buffer, preprocess_format_t* format);
+static bool skipFrame(const struct timeval* now);
+static void framePoolDestroy(void);
+static frame_data_t* frameRingReserve(unsigned int spare);
+static void frameRingCommit(void);
+static frame_data_t* frameRingPeek(void);
+static void frameRingRelease(void);
 
 int main(int argc, char* argv[])
 {
@@ -106,19 +303,62 @@ int main(int argc, char* argv[])
     camera_unit_t unit = CAMERA_UNIT_NONE;
     camera_frametype_t frametype = CAMERA_FRAMETYPE_UNSPECIFIED;
     pthread_t button_thread;
+    pthread_t sender_thread;
+    pthread_t ui_thread;
 
     // Read command line options
-    while ((opt = getopt(argc, argv, "u:")) != -1 || (optind < argc)) {
+    while ((opt = getopt(argc, argv, "u:ls:f:c:t:r:")) != -1 || (optind < argc)) {
         switch (opt) {
         case 'u':
             unit = (camera_unit_t)strtol(optarg, NULL, 10);
             break;
+        case 'l':
+            // Upload luma only
+            g_preprocess.luma_only = true;
+            break;
+        case 's':
+            // Decimate by 2 or 4 in both directions
+            g_preprocess.decimation = (unsigned int)strtoul(optarg, NULL, 10);
+            if ((g_preprocess.decimation != 1) && (g_preprocess.decimation != 2) && (g_preprocess.decimation != 4)) {
+                printf("Decimation must be 1, 2 or 4\n");
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'f':
+            // Skip frames to stay at or below this rate
+            g_preprocess.target_fps = (unsigned int)strtoul(optarg, NULL, 10);
+            break;
+        case 'c':
+            // Upload compressed frames instead of raw ones
+            if (strcmp(optarg, "h264") == 0) {
+                g_capture_mode = CAPTURE_MODE_H264;
+            } else if (strcmp(optarg, "jpeg") == 0) {
+                g_capture_mode = CAPTURE_MODE_JPEG;
+            } else {
+                printf("Compressed mode must be h264 or jpeg\n");
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'r':
+            // Spill each recording to this file and upload it from there
+            g_segment_path = optarg;
+            break;
+        case 't':
+            // Record latency spans, written as a Chrome trace after each session
+            g_trace_path = optarg;
+            trace_enable();
+            break;
         default:
             printf("Ignoring unrecognized option: %s\n", optarg);
             break;
         }
     }
 
+    if ((g_capture_mode != CAPTURE_MODE_RAW) && preprocess_is_active(&g_preprocess)) {
+        printf("Luma extraction and decimation only apply to raw capture\n");
+        exit(EXIT_FAILURE);
+    }
+
     // If no camera unit has been specified, list the options and exit
     if ((unit == CAMERA_UNIT_NONE) || (unit >= CAMERA_UNIT_NUM_UNITS)) {
         listAvailableCameras();
@@ -133,14 +373,22 @@ int main(int argc, char* argv[])
         exit(EXIT_FAILURE);
     }
 
-    // Open a read-only handle for the specified camera unit
-    err = camera_open(unit, CAMERA_MODE_RO, &g_camera_handle);
+    // Open a handle for the specified camera unit; encoding needs write access
+    err = camera_open(unit, (g_capture_mode == CAPTURE_MODE_H264) ? CAMERA_MODE_RW : CAMERA_MODE_RO,
+                      &g_camera_handle);
     if ((err != CAMERA_EOK) || (g_camera_handle == CAMERA_HANDLE_INVALID)) {
         printf("Failed to open CAMERA_UNIT_%d: err = %d\n", (int)unit, err);
         cleanupHardware();
         exit(EXIT_FAILURE);
     }
 
+    // Select the encoder or JPEG viewfinder before the format is checked
+    if (configureCaptureMode() != 0) {
+        camera_close(g_camera_handle);
+        cleanupHardware();
+        exit(EXIT_FAILURE);
+    }
+
     // Make sure that this camera defaults to a supported frametype
     err = camera_get_vf_property(g_camera_handle, CAMERA_IMGPROP_FORMAT, &frametype);
     if (err != CAMERA_EOK) {
@@ -150,8 +398,8 @@ int main(int argc, char* argv[])
         exit(EXIT_FAILURE);
     }
 
-    bool unsupportedFrametype = true;
-    for (uint i = 0; i < NUM_SUPPORTED_FRAMETYPES; i++) {
+    bool unsupportedFrametype = !((g_capture_mode == CAPTURE_MODE_JPEG) && (frametype == CAMERA_FRAMETYPE_JPEG));
+    for (uint i = 0; unsupportedFrametype && (i < NUM_SUPPORTED_FRAMETYPES); i++) {
         if (frametype == cSupportedFrametypes[i]) {
             unsupportedFrametype = false;
             break;
@@ -164,10 +412,16 @@ int main(int argc, char* argv[])
         exit(EXIT_FAILURE);
     }
 
+    // A dropped server connection must fail the send, not kill the process
+    signal(SIGPIPE, SIG_IGN);
+
     // Initialize environment data structure
     memset(&g_env_data, 0, sizeof(g_env_data));
+    sem_init(&g_frames_ready, 0, 0);
+    sem_init(&g_session_start, 0, 0);
+    sem_init(&g_vf_probe_ready, 0, 0);
 
-    // Start the camera streaming
+    // Start the camera streaming; the first frame only sizes the frame pool
     err = camera_start_viewfinder(g_camera_handle, processCameraData, NULL, NULL);
     if (err != CAMERA_EOK) {
         printf("Failed to start CAMERA_UNIT_%d: err = %d\n", (int)unit, err);
@@ -176,10 +430,42 @@ int main(int argc, char* argv[])
         exit(EXIT_FAILURE);
     }
 
+    // Reserve all frame memory before recording can start
+    if (framePoolInit() != 0) {
+        camera_stop_viewfinder(g_camera_handle);
+        camera_close(g_camera_handle);
+        cleanupHardware();
+        exit(EXIT_FAILURE);
+    }
+
+    // Start the display thread before anything posts status updates
+    if (pthread_create(&ui_thread, NULL, uiRefreshThread, NULL) != 0) {
+        printf("Failed to create display refresh thread\n");
+        camera_stop_viewfinder(g_camera_handle);
+        framePoolDestroy();
+        camera_close(g_camera_handle);
+        cleanupHardware();
+        exit(EXIT_FAILURE);
+    }
+
+    // Start the sender thread that streams frames while recording. With -r
+    // it first uploads what the previous run left on disk, and Button A
+    // must not start a session in the meantime.
+    atomic_store(&g_session_active, g_segment_path != NULL);
+    if (pthread_create(&sender_thread, NULL, senderThread, NULL) != 0) {
+        printf("Failed to create sender thread\n");
+        camera_stop_viewfinder(g_camera_handle);
+        framePoolDestroy();
+        camera_close(g_camera_handle);
+        cleanupHardware();
+        exit(EXIT_FAILURE);
+    }
+
     // Start button monitoring thread
     if (pthread_create(&button_thread, NULL, buttonMonitorThread, NULL) != 0) {
         printf("Failed to create button monitoring thread\n");
         camera_stop_viewfinder(g_camera_handle);
+        framePoolDestroy();
         camera_close(g_camera_handle);
         cleanupHardware();
         exit(EXIT_FAILURE);
@@ -196,9 +482,19 @@ int main(int argc, char* argv[])
     pthread_join(button_thread, NULL);
 
     camera_stop_viewfinder(g_camera_handle);
+    pthread_cancel(sender_thread);
+    pthread_join(sender_thread, NULL);
+    segment_close(&g_segment);
+    pthread_cancel(ui_thread);
+    pthread_join(ui_thread, NULL);
+    framePoolDestroy();
     camera_close(g_camera_handle);
     cleanupHardware();
 
+    if ((g_trace_path != NULL) && (trace_dump_chrome(g_trace_path) == TRACE_SUCCESS)) {
+        printf("Trace written to %s\n", g_trace_path);
+    }
+
     printf("System shut down successfully.\n");
     return 0;
 }
@@ -221,8 +517,16 @@ static void initializeHardware(void)
     init_button(Button_B);
     init_button(Button_C);
 
-    // Initialize BMP280 sensor
-    if (init_bmp() != RH_SUCCESS) {
+    // Record start/stop is driven by edge pulses rather than polling
+    if ((init_button_events(BUTTON_DEBOUNCE_MS) != RH_SUCCESS) ||
+        (enable_button_event(Button_A) != RH_SUCCESS) ||
+        (enable_button_event(Button_B) != RH_SUCCESS)) {
+        fprintf(stderr, "Failed to register button events\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Sample the BMP280 in the background so recording never waits on the bus
+    if (start_bmp_service(BMP_SAMPLE_PERIOD_MS) != RH_SUCCESS) {
         fprintf(stderr, "Failed to initialize BMP280 sensor\n");
         exit(EXIT_FAILURE);
     }
@@ -256,164 +560,709 @@ static void cleanupHardware(void)
     
     clear_rbg_leds();
     clear_alphanum();
+    cleanup_button_events();
+    stop_bmp_service();
+}
+
+static int framePoolInit(void)
+{
+    int err;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    size_t arena_size;
+    struct timespec deadline;
+
+    err = camera_get_vf_property(g_camera_handle,
+                                 CAMERA_IMGPROP_WIDTH, &width,
+                                 CAMERA_IMGPROP_HEIGHT, &height);
+    if ((err != CAMERA_EOK) || (width == 0) || (height == 0)) {
+        printf("Failed to get viewfinder resolution: err = %d\n", err);
+        return -1;
+    }
+    g_vf_width = width;
+    g_vf_height = height;
+
+    // The camera callback records the first frame's layout and posts
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += FRAME_POOL_PROBE_TIMEOUT_S;
+    while (sem_timedwait(&g_vf_probe_ready, &deadline) != 0) {
+        if (errno != EINTR) {
+            printf("No viewfinder frame arrived within %d s\n", FRAME_POOL_PROBE_TIMEOUT_S);
+            return -1;
+        }
+    }
+
+    memset(&g_frame_pool, 0, sizeof(g_frame_pool));
+    switch (g_vf_probe.frametype) {
+    case CAMERA_FRAMETYPE_RGB8888:
+    case CAMERA_FRAMETYPE_BGR8888:
+    case CAMERA_FRAMETYPE_YCBYCR:
+    case CAMERA_FRAMETYPE_CBYCRY:
+        // Rows as the driver lays them out, padding included. H.264 output
+        // is always smaller than the viewfinder frame it was encoded from.
+        g_frame_pool.slot_size = g_vf_probe.size;
+        break;
+    case CAMERA_FRAMETYPE_JPEG:
+        // The camera buffer bounds its JPEGs; failing that, a JPEG never
+        // needs more room than the YUV422 frame it came from
+        g_frame_pool.slot_size = g_vf_probe.size;
+        if (g_frame_pool.slot_size == 0) {
+            g_frame_pool.slot_size = (size_t)width * height * 2;
+        }
+        break;
+    default:
+        printf("Camera frametype %d is not supported\n", (int)g_vf_probe.frametype);
+        return -1;
+    }
+
+    // Preprocessed frames are packed, so their size is known exactly
+    if (preprocess_is_active(&g_preprocess)) {
+        preprocess_format_t out;
+
+        if (preprocess_output_format(&g_preprocess, &g_vf_probe.format, &out) != PREPROCESS_SUCCESS) {
+            printf("Unsupported preprocessing settings for frametype %d\n", (int)g_vf_probe.frametype);
+            return -1;
+        }
+        g_frame_pool.slot_size = (size_t)out.stride * out.height;
+        printf("Preprocessing frames to %ux%u, %u bytes per row\n", out.width, out.height, out.stride);
+    }
+    if (g_frame_pool.slot_size == 0) {
+        printf("Viewfinder frame has no size\n");
+        return -1;
+    }
+    g_frame_pool.num_slots = (unsigned int)(FRAME_POOL_MAX_BYTES / g_frame_pool.slot_size);
+    if (g_frame_pool.num_slots > FRAME_RING_SIZE) {
+        g_frame_pool.num_slots = FRAME_RING_SIZE;
+    }
+
+    // The ring indexes slots with a mask, so keep a power of two
+    while (g_frame_pool.num_slots & (g_frame_pool.num_slots - 1)) {
+        g_frame_pool.num_slots &= g_frame_pool.num_slots - 1;
+    }
+
+    // One entry is always kept free for the end-of-stream marker
+    if (g_frame_pool.num_slots < 2) {
+        printf("Viewfinder frame of %zu bytes exceeds the frame pool budget\n", g_frame_pool.slot_size);
+        return -1;
+    }
+
+    arena_size = g_frame_pool.slot_size * g_frame_pool.num_slots;
+    g_frame_pool.arena = malloc(arena_size);
+    if (g_frame_pool.arena == NULL) {
+        printf("Failed to allocate frame pool of %u x %zu bytes\n",
+               g_frame_pool.num_slots, g_frame_pool.slot_size);
+        return -1;
+    }
+
+    // Fault every page in now and keep them resident, so the first frames
+    // of a recording don't take page faults in the camera callback
+    if (mlock(g_frame_pool.arena, arena_size) != 0) {
+        printf("Warning: Failed to lock the frame pool in memory: %s\n", strerror(errno));
+    }
+    memset(g_frame_pool.arena, 0, arena_size);
+
+    // Bind every ring entry to its slot once, so recording never allocates
+    memset(&g_frame_ring, 0, sizeof(g_frame_ring));
+    for (unsigned int i = 0; i < g_frame_pool.num_slots; i++) {
+        g_frame_ring.frames[i].data = g_frame_pool.arena + ((size_t)i * g_frame_pool.slot_size);
+    }
+    g_frame_ring.mask = g_frame_pool.num_slots - 1;
+    atomic_init(&g_frame_ring.head, 0);
+    atomic_init(&g_frame_ring.tail, 0);
+
+    printf("Frame pool ready: %u slots of %zu bytes (%ux%u)\n",
+           g_frame_pool.num_slots, g_frame_pool.slot_size, width, height);
+    return 0;
+}
+
+static int configureCaptureMode(void)
+{
+    int err;
+
+    switch (g_capture_mode) {
+    case CAPTURE_MODE_H264:
+        // The encoder runs off the video viewfinder; its output arrives
+        // in processEncodedData while the raw viewfinder frames are ignored
+        err = camera_set_vf_mode(g_camera_handle, CAMERA_VFMODE_VIDEO);
+        if (err == CAMERA_EOK) {
+            err = camera_set_video_property(g_camera_handle, CAMERA_IMGPROP_VIDEOCODEC, CAMERA_VIDEOCODEC_H264);
+        }
+        if (err != CAMERA_EOK) {
+            printf("Failed to configure the H.264 encoder: err = %d\n", err);
+            return -1;
+        }
+        break;
+    case CAPTURE_MODE_JPEG:
+        err = camera_set_vf_property(g_camera_handle, CAMERA_IMGPROP_FORMAT, CAMERA_FRAMETYPE_JPEG);
+        if (err != CAMERA_EOK) {
+            printf("Camera does not provide JPEG viewfinder frames: err = %d\n", err);
+            return -1;
+        }
+        break;
+    case CAPTURE_MODE_RAW:
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+static bool skipFrame(const struct timeval* now)
+{
+    static uint64_t next_frame_us = 0;
+    uint64_t now_us;
+    uint64_t interval_us;
+
+    if (g_preprocess.target_fps == 0) {
+        return false;
+    }
+
+    now_us = timevalToMicros(now);
+    interval_us = 1000000ULL / g_preprocess.target_fps;
+    if (now_us < next_frame_us) {
+        return true;
+    }
+
+    // Keep a steady cadence, but don't try to catch up after a stall
+    next_frame_us += interval_us;
+    if (next_frame_us <= now_us) {
+        next_frame_us = now_us + interval_us;
+    }
+    return false;
+}
+
+static void framePoolDestroy(void)
+{
+    if (g_frame_pool.arena != NULL) {
+        munlock(g_frame_pool.arena, g_frame_pool.slot_size * g_frame_pool.num_slots);
+    }
+    free(g_frame_pool.arena);
+    memset(&g_frame_pool, 0, sizeof(g_frame_pool));
+}
+
+static frame_data_t* frameRingReserve(unsigned int spare)
+{
+    unsigned int head = atomic_load_explicit(&g_frame_ring.head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&g_frame_ring.tail, memory_order_acquire);
+
+    // Producer side: hand out the entry at head if at least spare more are free
+    if ((head - tail) + spare >= g_frame_pool.num_slots) {
+        return NULL;
+    }
+
+    return &g_frame_ring.frames[head & g_frame_ring.mask];
+}
+
+static void frameRingCommit(void)
+{
+    atomic_fetch_add_explicit(&g_frame_ring.head, 1, memory_order_release);
+    sem_post(&g_frames_ready);
+}
+
+static frame_data_t* frameRingPeek(void)
+{
+    unsigned int tail = atomic_load_explicit(&g_frame_ring.tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&g_frame_ring.head, memory_order_acquire);
+
+    if (head == tail) {
+        return NULL;
+    }
+
+    return &g_frame_ring.frames[tail & g_frame_ring.mask];
+}
+
+static void frameRingRelease(void)
+{
+    // Consumer side: the entry and its pool slot go back to the producer
+    atomic_fetch_add_explicit(&g_frame_ring.tail, 1, memory_order_release);
 }
 
 static void* buttonMonitorThread(void* arg)
 {
-    bool button_a_prev = false;
-    bool button_b_prev = false;
-    bool button_a_current, button_b_current;
+    button_event_t event;
+    int err;
 
     (void)arg; // Suppress unused parameter warning
 
     while (1) {
-        button_a_current = read_button(Button_A);
-        button_b_current = read_button(Button_B);
+        // Sleeps until a debounced edge arrives on A or B
+        err = wait_button_event(&event, 0);
+        if (err == RH_TIMEOUT) {
+            continue;
+        }
+        if (err != RH_SUCCESS) {
+            printf("Failed to wait for button events\n");
+            break;
+        }
 
-        // Button A pressed (start recording)
-        if (button_a_current && !button_a_prev && !g_recording) {
-            pthread_mutex_lock(&g_recording_mutex);
+        // Button A pressed with a recording still on disk: retry its upload
+        // instead, a new recording would overwrite the segment file
+        if ((event.button == Button_A) && event.pressed && !atomic_load(&g_session_active) &&
+            atomic_load(&g_segment_pending)) {
+            printf("Button A pressed - Retrying the upload of %s\n", g_segment_path);
+            atomic_store(&g_session_active, true);
+            sem_post(&g_session_start);
+
+            set_led(Led_RED, true);
+            set_led(Led_GREEN, true);
+            uiSetText("SEND", false);
+            uiSetRgb(255, 255, 0, 50);
+            continue;
+        }
+
+        // Button A pressed (start recording), once the previous upload is done
+        if ((event.button == Button_A) && event.pressed && !atomic_load(&g_recording) && !atomic_load(&g_session_active)) {
+            bmp_snapshot_t env;
+            bool env_valid = (get_bmp_snapshot(&env) == RH_SUCCESS);
+
+            pthread_mutex_lock(&g_env_mutex);
             
             printf("Button A pressed - Starting recording\n");
             gettimeofday(&g_env_data.button_press_time, NULL);
             
-            // Get current environment data
-            if (get_bmp_data(&g_env_data.temperature, &g_env_data.pressure) != RH_SUCCESS) {
+            // Latest background sample, no I2C traffic while the mutex is held
+            if (env_valid) {
+                g_env_data.temperature = env.temperature;
+                g_env_data.pressure = env.pressure;
+            } else {
                 printf("Warning: Failed to read environment data\n");
                 g_env_data.temperature = 0.0;
                 g_env_data.pressure = 0.0;
             }
             
-            g_recording = true;
             g_env_data.is_recording = true;
-            g_frame_count = 0;
+            pthread_mutex_unlock(&g_env_mutex);
+
+            // Wake the sender thread so it connects while frames are queued
+            atomic_store_explicit(&g_frame_count, 0, memory_order_relaxed);
+            atomic_store(&g_session_active, true);
+            atomic_store(&g_recording, true);
+            sem_post(&g_session_start);
+
+            // The encoder callback replaces the viewfinder as ring producer
+            if (g_capture_mode == CAPTURE_MODE_H264) {
+                err = camera_start_encode(g_camera_handle, processEncodedData, NULL, NULL, NULL);
+                if (err != CAMERA_EOK) {
+                    printf("Failed to start the encoder: err = %d\n", err);
+                    atomic_store(&g_recording, false);
+                    atomic_store(&g_end_requested, true);
+                }
+            }
             
             // Visual feedback - red LED and display
             set_led(Led_RED, true);
             set_led(Led_GREEN, false);
-            set_alphanum_string("REC");
-            show_alphanum();
+            uiSetText("REC", true);
             
             // Set RGB LEDs to red for recording
-            for (int i = 0; i < 7; i++) {
-                set_rgb_led(i, 255, 0, 0, 50);
-            }
-            show_rgb_leds();
-            
-            pthread_mutex_unlock(&g_recording_mutex);
+            uiSetRgb(255, 0, 0, 50);
         }
 
         // Button A released
-        if (!button_a_current && button_a_prev && g_recording) {
-            pthread_mutex_lock(&g_recording_mutex);
+        if ((event.button == Button_A) && !event.pressed && atomic_load(&g_recording)) {
+            pthread_mutex_lock(&g_env_mutex);
             gettimeofday(&g_env_data.button_release_time, NULL);
-            pthread_mutex_unlock(&g_recording_mutex);
+            pthread_mutex_unlock(&g_env_mutex);
             printf("Button A released\n");
         }
 
-        // Button B pressed (stop recording and send data)
-        if (button_b_current && !button_b_prev && g_recording) {
-            pthread_mutex_lock(&g_recording_mutex);
-            
+        // Button B pressed (stop recording, sender thread finishes the upload)
+        if ((event.button == Button_B) && event.pressed && atomic_load(&g_recording)) {
             printf("Button B pressed - Stopping recording and sending data\n");
-            g_recording = false;
+
+            pthread_mutex_lock(&g_env_mutex);
             g_env_data.is_recording = false;
+            pthread_mutex_unlock(&g_env_mutex);
+            atomic_store(&g_recording, false);
+
+            // The viewfinder callback queues the end-of-stream marker on its
+            // next frame, so the ring keeps a single producer. It keeps running
+            // while encoding, and camera_stop_encode() only returns once the
+            // encoder callback is done, so the last encoded frame comes first.
+            if (g_capture_mode == CAPTURE_MODE_H264) {
+                camera_stop_encode(g_camera_handle);
+            }
+            atomic_store(&g_end_requested, true);
             
             // Visual feedback - yellow LED and display
             set_led(Led_RED, true);
             set_led(Led_GREEN, true);
-            set_alphanum_string("SEND");
-            show_alphanum();
+            uiSetText("SEND", false);
             
             // Set RGB LEDs to yellow for processing
-            for (int i = 0; i < 7; i++) {
-                set_rgb_led(i, 255, 255, 0, 50);
-            }
-            show_rgb_leds();
-            
-            pthread_mutex_unlock(&g_recording_mutex);
-            
-            // Send data to server in separate thread or blocking call
-            if (sendDataToServer() == 0) {
-                printf("Data sent successfully, waiting for analysis result...\n");
-            } else {
-                printf("Failed to send data to server\n");
-                // Display error
-                set_alphanum_string("ERR");
-                show_alphanum();
-                set_led(Led_RED, true);
-                set_led(Led_GREEN, false);
-            }
+            uiSetRgb(255, 255, 0, 50);
         }
-
-        button_a_prev = button_a_current;
-        button_b_prev = button_b_current;
-        
-        usleep(50000); // 50ms polling interval
     }
 
     return NULL;
 }
 
+static bool bufferLayout(const camera_buffer_t* buffer, preprocess_format_t* format)
+{
+    switch (buffer->frametype) {
+    case CAMERA_FRAMETYPE_RGB8888:
+        format->frametype = STREAM_FRAMETYPE_RGB8888;
+        format->width = buffer->framedesc.rgb8888.width;
+        format->height = buffer->framedesc.rgb8888.height;
+        format->stride = buffer->framedesc.rgb8888.stride;
+        return true;
+    case CAMERA_FRAMETYPE_BGR8888:
+        format->frametype = STREAM_FRAMETYPE_BGR8888;
+        format->width = buffer->framedesc.bgr8888.width;
+        format->height = buffer->framedesc.bgr8888.height;
+        format->stride = buffer->framedesc.bgr8888.stride;
+        return true;
+    case CAMERA_FRAMETYPE_YCBYCR:
+        format->frametype = STREAM_FRAMETYPE_YCBYCR;
+        format->width = buffer->framedesc.ycbycr.width;
+        format->height = buffer->framedesc.ycbycr.height;
+        format->stride = buffer->framedesc.ycbycr.stride;
+        return true;
+    case CAMERA_FRAMETYPE_CBYCRY:
+        format->frametype = STREAM_FRAMETYPE_CBYCRY;
+        format->width = buffer->framedesc.cbycry.width;
+        format->height = buffer->framedesc.cbycry.height;
+        format->stride = buffer->framedesc.cbycry.stride;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void probeViewfinder(const camera_buffer_t* buffer)
+{
+    memset(&g_vf_probe, 0, sizeof(g_vf_probe));
+    g_vf_probe.frametype = buffer->frametype;
+    if (bufferLayout(buffer, &g_vf_probe.format)) {
+        g_vf_probe.size = (size_t)g_vf_probe.format.height * g_vf_probe.format.stride;
+    } else if (buffer->frametype == CAMERA_FRAMETYPE_JPEG) {
+        // JPEG sizes vary frame to frame; the buffer they arrive in is the bound
+        g_vf_probe.size = (size_t)buffer->framesize;
+    }
+
+    atomic_store_explicit(&g_vf_probed, true, memory_order_release);
+    sem_post(&g_vf_probe_ready);
+}
+
 static void processCameraData(camera_handle_t handle, camera_buffer_t* buffer, void* arg)
 {
+    bool recording;
+    frame_data_t* frame;
+    uint64_t enqueue_ns;
+
     (void)handle;
     (void)arg;
 
-    pthread_mutex_lock(&g_recording_mutex);
-    
-    if (g_recording && g_frame_count < MAX_FRAME_BUFFER) {
-        // Calculate buffer size based on frametype
+    // framePoolInit() is waiting to learn the real buffer layout
+    if (!atomic_load_explicit(&g_vf_probed, memory_order_acquire)) {
+        probeViewfinder(buffer);
+        return;
+    }
+
+    // Button B stops the recording before it asks for the marker, so no
+    // frame read as recording below can follow it
+    if (atomic_exchange(&g_end_requested, false)) {
+        queueEndOfStream();
+    }
+    recording = atomic_load(&g_recording);
+
+    // While encoding, the session is fed from processEncodedData
+    if (g_capture_mode == CAPTURE_MODE_H264) {
+        return;
+    }
+
+    if (recording) {
         size_t buffer_size = 0;
-        
-        switch (buffer->frametype) {
-        case CAMERA_FRAMETYPE_RGB8888:
-            buffer_size = buffer->framedesc.rgb8888.height * buffer->framedesc.rgb8888.stride;
-            break;
-        case CAMERA_FRAMETYPE_BGR8888:
-            buffer_size = buffer->framedesc.bgr8888.height * buffer->framedesc.bgr8888.stride;
-            break;
-        case CAMERA_FRAMETYPE_YCBYCR:
-            buffer_size = buffer->framedesc.ycbycr.height * buffer->framedesc.ycbycr.stride;
-            break;
-        case CAMERA_FRAMETYPE_CBYCRY:
-            buffer_size = buffer->framedesc.cbycry.height * buffer->framedesc.cbycry.stride;
-            break;
-        default:
-            pthread_mutex_unlock(&g_recording_mutex);
+        struct timeval timestamp;
+        uint64_t capture_ns = trace_now_ns();
+        preprocess_format_t in;
+
+        trace_thread_name("camera");
+        gettimeofday(&timestamp, NULL);
+        if (skipFrame(&timestamp)) {
+            return;
+        }
+
+        if (buffer->frametype == CAMERA_FRAMETYPE_JPEG) {
+            queueEncodedFrame(buffer, STREAM_FRAMETYPE_JPEG, buffer->framedesc.jpeg.bufsize, &timestamp);
+            return;
+        }
+        if (!bufferLayout(buffer, &in)) {
             return;
         }
+        buffer_size = (size_t)in.height * in.stride;
+
+        preprocess_format_t out = in;
+        bool preprocess = preprocess_is_active(&g_preprocess);
+        if (preprocess) {
+            if (preprocess_output_format(&g_preprocess, &in, &out) != PREPROCESS_SUCCESS) {
+                return;
+            }
+            buffer_size = (size_t)out.stride * out.height;
+        }
         
-        // Allocate memory for frame data
-        g_frame_buffer[g_frame_count].data = malloc(buffer_size);
-        if (g_frame_buffer[g_frame_count].data != NULL) {
-            memcpy(g_frame_buffer[g_frame_count].data, buffer->framebuf, buffer_size);
-            g_frame_buffer[g_frame_count].size = buffer_size;
-            gettimeofday(&g_frame_buffer[g_frame_count].timestamp, NULL);
-            g_frame_count++;
-            
-            // Update frame count display
-            char frame_str[5];
-            snprintf(frame_str, sizeof(frame_str), "%04d", g_frame_count);
-            set_alphanum_string(frame_str);
-            show_alphanum();
+        // Counted for the UI thread, the capture path must not block on stdout
+        if ((buffer_size == 0) || (buffer_size > g_frame_pool.slot_size)) {
+            atomic_fetch_add_explicit(&g_frames_oversized, 1, memory_order_relaxed);
+            return;
+        }
+
+        // Keep the last ring entry free for the end-of-stream marker
+        frame = frameRingReserve(1);
+        if (frame == NULL) {
+            // Reported by the UI thread, the capture path must not block on stdout
+            atomic_fetch_add_explicit(&g_frames_dropped, 1, memory_order_relaxed);
+            return;
+        }
+
+        // The entry's pool slot is already bound, just fill it. The
+        // preprocessing kernels replace the copy rather than adding a pass.
+        if (preprocess) {
+            preprocess_frame(&g_preprocess, &in, buffer->framebuf, &out, frame->data);
         } else {
-            printf("Failed to allocate memory for frame %d\n", g_frame_count);
+            memcpy(frame->data, buffer->framebuf, buffer_size);
         }
+        frame->size = buffer_size;
+        frame->frametype = out.frametype;
+        frame->width = out.width;
+        frame->height = out.height;
+        frame->stride = out.stride;
+        frame->timestamp = timestamp;
+        frame->enqueue_ns = enqueue_ns = trace_now_ns();
+        frameRingCommit();
+
+        // The UI thread picks the new count up on its next refresh
+        trace_span("capture", capture_ns, enqueue_ns,
+                   (uint32_t)atomic_fetch_add_explicit(&g_frame_count, 1, memory_order_relaxed));
     }
-    
-    pthread_mutex_unlock(&g_recording_mutex);
 }
 
-static int sendDataToServer(void)
+static void processEncodedData(camera_handle_t handle, camera_buffer_t* buffer, void* arg)
 {
-    int socket_fd;
-    struct sockaddr_in server_addr;
-    char result[5] = {0};
+    struct timeval timestamp;
 
-    // Create socket
-    socket_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (socket_fd < 0) {
+    (void)handle;
+    (void)arg;
+
+    if ((buffer->frametype != CAMERA_FRAMETYPE_COMPRESSEDVIDEO) ||
+        !atomic_load_explicit(&g_recording, memory_order_acquire)) {
+        return;
+    }
+
+    trace_thread_name("encoder");
+    gettimeofday(&timestamp, NULL);
+    queueEncodedFrame(buffer, STREAM_FRAMETYPE_H264, buffer->framedesc.compvid.bufsize, &timestamp);
+}
+
+static void queueEncodedFrame(const camera_buffer_t* buffer, uint32_t wire_frametype, size_t size,
+                              const struct timeval* timestamp)
+{
+    frame_data_t* frame;
+    uint64_t capture_ns = trace_now_ns();
+    uint64_t enqueue_ns;
+
+    // Reported by the UI thread, like oversized raw frames
+    if ((size == 0) || (size > g_frame_pool.slot_size)) {
+        atomic_fetch_add_explicit(&g_frames_oversized, 1, memory_order_relaxed);
+        return;
+    }
+
+    // Keep the last ring entry free for the end-of-stream marker
+    frame = frameRingReserve(1);
+    if (frame == NULL) {
+        atomic_fetch_add_explicit(&g_frames_dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    // Compressed payloads have no row layout, stride stays zero
+    memcpy(frame->data, buffer->framebuf, size);
+    frame->size = size;
+    frame->frametype = wire_frametype;
+    frame->width = g_vf_width;
+    frame->height = g_vf_height;
+    frame->stride = 0;
+    frame->timestamp = *timestamp;
+    frame->enqueue_ns = enqueue_ns = trace_now_ns();
+    frameRingCommit();
+
+    trace_span("capture", capture_ns, enqueue_ns,
+               (uint32_t)atomic_fetch_add_explicit(&g_frame_count, 1, memory_order_relaxed));
+}
+
+static void queueEndOfStream(void)
+{
+    frame_data_t* frame;
+
+    // Close the session with a zero-size entry. Frames never use the
+    // last free entry, so this always fits.
+    frame = frameRingReserve(0);
+    if (frame != NULL) {
+        frame->size = 0;
+        frameRingCommit();
+    }
+}
+
+static void* senderThread(void* arg)
+{
+    (void)arg;
+
+    trace_thread_name("sender");
+
+    // Finish an upload the previous run didn't get to and reserve the
+    // segment for the next recording. main() marked the session active,
+    // so Button A waits until this is done.
+    if (g_segment_path != NULL) {
+        recoverSegment();
+        prepareSegment();
+        atomic_store(&g_session_active, false);
+    }
+
+    while (1) {
+        // Wait for Button A to open a recording session
+        while (sem_wait(&g_session_start) != 0) {
+            if (errno != EINTR) {
+                return NULL;
+            }
+        }
+
+        if (atomic_load(&g_segment_pending)) {
+            // Button A asked for the segment left on disk to be sent again
+            if (recoverSegment() == 0) {
+                printf("Data sent successfully\n");
+            }
+            prepareSegment();
+        } else if (streamSession() == 0) {
+            printf("Data sent successfully\n");
+        } else {
+            printf("Failed to send data to server\n");
+            // Display error
+            uiSetText("ERR", false);
+            set_led(Led_RED, true);
+            set_led(Led_GREEN, false);
+        }
+
+        atomic_store(&g_session_active, false);
+
+        // Refresh the trace file once the session's spans are all in
+        if ((g_trace_path != NULL) && (trace_dump_chrome(g_trace_path) != TRACE_SUCCESS)) {
+            printf("Failed to write trace to %s\n", g_trace_path);
+        }
+    }
+
+    return NULL;
+}
+
+static void uiSetText(const char* text, bool show_frame_count)
+{
+    pthread_mutex_lock(&g_ui_mutex);
+    snprintf(g_ui_status.text, sizeof(g_ui_status.text), "%s", text);
+    g_ui_status.show_frame_count = show_frame_count;
+    g_ui_status.posted_ns = trace_now_ns();
+    pthread_mutex_unlock(&g_ui_mutex);
+}
+
+static void uiSetRgb(uint8_t r, uint8_t g, uint8_t b, uint8_t brightness)
+{
+    pthread_mutex_lock(&g_ui_mutex);
+    g_ui_status.rgb[0] = r;
+    g_ui_status.rgb[1] = g;
+    g_ui_status.rgb[2] = b;
+    g_ui_status.brightness = brightness;
+    g_ui_status.rgb_version++;
+    pthread_mutex_unlock(&g_ui_mutex);
+}
+
+static void* uiRefreshThread(void* arg)
+{
+    ui_status_t status;
+    char shown_text[5] = "RDY";
+    unsigned int shown_rgb_version = 0;
+    unsigned int reported_drops = 0;
+    unsigned int reported_oversized = 0;
+    unsigned int dropped;
+    unsigned int oversized;
+    uint64_t next_drop_report_ns = 0;
+    uint64_t now_ns;
+    int frame_count;
+    struct sched_param param;
+    int policy;
+
+    (void)arg;
+
+    trace_thread_name("ui");
+
+    // Run below the capture and sender threads
+    if (pthread_getschedparam(pthread_self(), &policy, &param) == 0) {
+        if (param.sched_priority > sched_get_priority_min(policy)) {
+            pthread_setschedprio(pthread_self(), param.sched_priority - 1);
+        }
+    }
+
+    while (1) {
+        pthread_mutex_lock(&g_ui_mutex);
+        status = g_ui_status;
+        pthread_mutex_unlock(&g_ui_mutex);
+
+        // While recording, the frame counter replaces the status text
+        frame_count = atomic_load_explicit(&g_frame_count, memory_order_relaxed);
+        if (status.show_frame_count && (frame_count > 0)) {
+            snprintf(status.text, sizeof(status.text), "%04d", frame_count);
+        }
+
+        // Only touch the HAT when something actually changed
+        if ((status.text[0] != '\0') && (strcmp(status.text, shown_text) != 0)) {
+            uint64_t display_ns = trace_now_ns();
+
+            set_alphanum_string(status.text);
+            show_alphanum();
+            memcpy(shown_text, status.text, sizeof(shown_text));
+
+            // How long the text waited for a refresh, then the HAT write itself
+            trace_span("ui_wait", status.posted_ns, display_ns, 0);
+            trace_span("display", display_ns, trace_now_ns(), 0);
+        }
+
+        if (status.rgb_version != shown_rgb_version) {
+            for (int i = 0; i < 7; i++) {
+                set_rgb_led(i, status.rgb[0], status.rgb[1], status.rgb[2], status.brightness);
+            }
+            show_rgb_leds();
+            shown_rgb_version = status.rgb_version;
+        }
+
+        // One line for all the frames dropped since the last report
+        dropped = atomic_load_explicit(&g_frames_dropped, memory_order_relaxed);
+        oversized = atomic_load_explicit(&g_frames_oversized, memory_order_relaxed);
+        now_ns = trace_now_ns();
+        if (((dropped != reported_drops) || (oversized != reported_oversized)) && (now_ns >= next_drop_report_ns)) {
+            if (dropped != reported_drops) {
+                printf("Sender is falling behind, %u frames dropped so far\n", dropped);
+                reported_drops = dropped;
+            }
+            if (oversized != reported_oversized) {
+                printf("%u frames so far did not fit a pool slot of %zu bytes\n", oversized,
+                       g_frame_pool.slot_size);
+                reported_oversized = oversized;
+            }
+            next_drop_report_ns = now_ns + DROP_REPORT_INTERVAL_NS;
+        }
+
+        usleep(UI_REFRESH_INTERVAL_US);
+    }
+
+    return NULL;
+}
+
+static int connectToServer(void)
+{
+    int socket_fd;
+    int flags;
+    int err;
+    struct sockaddr_in server_addr;
+
+    // Create socket
+    socket_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (socket_fd < 0) {
         printf("Failed to create socket: %s\n", strerror(errno));
         return -1;
     }
@@ -428,79 +1277,701 @@ static int sendDataToServer(void)
         return -1;
     }
 
-    // Connect to server
-    if (connect(socket_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        printf("Failed to connect to server: %s\n", strerror(errno));
-        close(socket_fd);
-        return -1;
+    // Frames are large and sent back to back: disable Nagle and allow
+    // several frames in flight. Failures only cost throughput.
+    int nodelay = 1;
+    int sndbuf = SOCKET_SEND_BUFFER_SIZE;
+    if (setsockopt(socket_fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)) < 0) {
+        printf("Warning: Failed to set TCP_NODELAY: %s\n", strerror(errno));
+    }
+    if (setsockopt(socket_fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)) < 0) {
+        printf("Warning: Failed to set SO_SNDBUF: %s\n", strerror(errno));
+    }
+
+    // A stalled link fails the send instead of blocking the sender for good
+    struct timeval send_timeout = { .tv_sec = SEND_TIMEOUT_S, .tv_usec = 0 };
+    if (setsockopt(socket_fd, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout)) < 0) {
+        printf("Warning: Failed to set SO_SNDTIMEO: %s\n", strerror(errno));
     }
 
-    // Send metadata first
-    if (send(socket_fd, &g_env_data, sizeof(g_env_data), 0) < 0) {
-        printf("Failed to send environment data: %s\n", strerror(errno));
+    // Connect without blocking, so an unreachable server costs at most
+    // CONNECT_TIMEOUT_MS rather than the stack's own connect timeout
+    flags = fcntl(socket_fd, F_GETFL, 0);
+    if ((flags < 0) || (fcntl(socket_fd, F_SETFL, flags | O_NONBLOCK) < 0)) {
+        printf("Failed to make socket non-blocking: %s\n", strerror(errno));
         close(socket_fd);
         return -1;
     }
 
-    // Send frame count
-    if (send(socket_fd, &g_frame_count, sizeof(g_frame_count), 0) < 0) {
-        printf("Failed to send frame count: %s\n", strerror(errno));
+    err = connect(socket_fd, (struct sockaddr*)&server_addr, sizeof(server_addr));
+    if ((err < 0) && (errno == EINPROGRESS)) {
+        struct pollfd pfd = { .fd = socket_fd, .events = POLLOUT };
+        int so_error = 0;
+        socklen_t len = sizeof(so_error);
+
+        do {
+            err = poll(&pfd, 1, CONNECT_TIMEOUT_MS);
+        } while ((err < 0) && (errno == EINTR));
+
+        if (err == 0) {
+            errno = ETIMEDOUT;
+            err = -1;
+        } else if (err > 0) {
+            err = getsockopt(socket_fd, SOL_SOCKET, SO_ERROR, &so_error, &len);
+            if ((err == 0) && (so_error != 0)) {
+                errno = so_error;
+                err = -1;
+            }
+        }
+    }
+
+    // Sends and receives block again from here on
+    if ((err < 0) || (fcntl(socket_fd, F_SETFL, flags) < 0)) {
+        printf("Failed to connect to server: %s\n", strerror(errno));
         close(socket_fd);
         return -1;
     }
 
-    // Send frame data
-    for (int i = 0; i < g_frame_count; i++) {
-        // Send frame size first
-        if (send(socket_fd, &g_frame_buffer[i].size, sizeof(g_frame_buffer[i].size), 0) < 0) {
-            printf("Failed to send frame size: %s\n", strerror(errno));
-            close(socket_fd);
+    return socket_fd;
+}
+
+static uint64_t hostToNet64(uint64_t value)
+{
+    uint8_t bytes[sizeof(value)];
+    uint64_t net;
+
+    // Most significant byte first, whatever the host byte order
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        bytes[i] = (uint8_t)(value >> (8 * (sizeof(bytes) - 1 - i)));
+    }
+    memcpy(&net, bytes, sizeof(net));
+    return net;
+}
+
+static int sendAll(int socket_fd, struct iovec* iov, int iovcnt)
+{
+    ssize_t written;
+
+    while (iovcnt > 0) {
+        written = writev(socket_fd, iov, iovcnt);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
             return -1;
         }
-        
-        // Send timestamp
-        if (send(socket_fd, &g_frame_buffer[i].timestamp, sizeof(g_frame_buffer[i].timestamp), 0) < 0) {
-            printf("Failed to send frame timestamp: %s\n", strerror(errno));
-            close(socket_fd);
-            return -1;
+
+        // Skip the vectors that went out completely and trim a partial one
+        while ((iovcnt > 0) && ((size_t)written >= iov->iov_len)) {
+            written -= iov->iov_len;
+            iov++;
+            iovcnt--;
         }
-        
-        // Send frame data
-        if (send(socket_fd, g_frame_buffer[i].data, g_frame_buffer[i].size, 0) < 0) {
-            printf("Failed to send frame data: %s\n", strerror(errno));
-            close(socket_fd);
+        if (iovcnt > 0) {
+            iov->iov_base = (uint8_t*)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+
+    return 0;
+}
+
+static int recvAll(int socket_fd, void* buf, size_t len)
+{
+    ssize_t received;
+    size_t total = 0;
+
+    while (total < len) {
+        received = recv(socket_fd, (uint8_t*)buf + total, len - total, 0);
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
             return -1;
         }
-        
-        // Free the frame data after sending
-        free(g_frame_buffer[i].data);
-        g_frame_buffer[i].data = NULL;
+        if (received == 0) {
+            // Connection closed before everything arrived
+            return (int)total;
+        }
+        total += received;
+    }
+
+    return (int)total;
+}
+
+static uint64_t timevalToMicros(const struct timeval* tv)
+{
+    return ((uint64_t)tv->tv_sec * 1000000ULL) + tv->tv_usec;
+}
+
+static int sendFrame(int socket_fd, const frame_data_t* frame)
+{
+    stream_frame_header_t header;
+    struct iovec iov[2];
+
+    header.msg_type = htonl(STREAM_MSG_FRAME);
+    header.frametype = htonl(frame->frametype);
+    header.width = htonl(frame->width);
+    header.height = htonl(frame->height);
+    header.stride = htonl(frame->stride);
+    header.payload_size = htonl((uint32_t)frame->size);
+    header.timestamp_us = hostToNet64(timevalToMicros(&frame->timestamp));
+
+    // Header and payload go out in one gathered write, straight from the pool slot
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = frame->data;
+    iov[1].iov_len = frame->size;
+
+    if (sendAll(socket_fd, iov, 2) != 0) {
+        printf("Failed to send frame: %s\n", strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+static int sendSessionHeader(int socket_fd, int32_t temperature_centi, uint32_t pressure_centi,
+                             uint64_t button_press_time_us, uint32_t flags, uint32_t session_id)
+{
+    stream_session_header_t session_header;
+    struct iovec iov[1];
+
+    memset(&session_header, 0, sizeof(session_header));
+    session_header.magic = htonl(STREAM_PROTOCOL_MAGIC);
+    session_header.version = htons(STREAM_PROTOCOL_VERSION);
+    session_header.header_size = htons(sizeof(session_header));
+    session_header.flags = htonl(flags);
+    session_header.temperature_centi = (int32_t)htonl((uint32_t)temperature_centi);
+    session_header.pressure_centi = htonl(pressure_centi);
+    session_header.session_id = htonl(session_id);
+    session_header.button_press_time_us = hostToNet64(button_press_time_us);
+
+    iov[0].iov_base = &session_header;
+    iov[0].iov_len = sizeof(session_header);
+    if (sendAll(socket_fd, iov, 1) != 0) {
+        printf("Failed to send session header: %s\n", strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+static int sendEndOfStream(int socket_fd, uint64_t button_release_time_us)
+{
+    stream_frame_header_t end_of_stream;
+    struct iovec iov[1];
+
+    // The end-of-stream marker carries the button release time
+    memset(&end_of_stream, 0, sizeof(end_of_stream));
+    end_of_stream.msg_type = htonl(STREAM_MSG_END_OF_STREAM);
+    end_of_stream.timestamp_us = hostToNet64(button_release_time_us);
+
+    iov[0].iov_base = &end_of_stream;
+    iov[0].iov_len = sizeof(end_of_stream);
+    if (sendAll(socket_fd, iov, 1) != 0) {
+        printf("Failed to send end of stream: %s\n", strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+static int streamSession(void)
+{
+    int socket_fd;
+    bool end_of_session = false;
+    environment_data_t env_data;
+    frame_data_t* frame;
+    char result[5] = {0};
+    uint64_t session_ns = trace_now_ns();
+    uint64_t span_ns;
+    uint32_t frames_sent = 0;
+
+    // Recordings spilled to disk are uploaded from the segment file instead
+    if (g_segment_path != NULL) {
+        return recordSession();
+    }
+
+    // Connect while recording; frames queue in the ring in the meantime
+    socket_fd = connectToServer();
+    trace_span("connect", session_ns, trace_now_ns(), 0);
+
+    pthread_mutex_lock(&g_env_mutex);
+    env_data = g_env_data;
+    pthread_mutex_unlock(&g_env_mutex);
+
+    // Send the session header first
+    if ((socket_fd >= 0) &&
+        (sendSessionHeader(socket_fd, (int32_t)(env_data.temperature * 100.0), (uint32_t)(env_data.pressure * 100.0),
+                           timevalToMicros(&env_data.button_press_time), 0, 0) != 0)) {
+        close(socket_fd);
+        socket_fd = -1;
+    }
+
+    // Drain the ring until the end-of-stream marker. If the connection is
+    // lost the frames are still consumed so their slots return to the pool.
+    while (!end_of_session) {
+        if (sem_wait(&g_frames_ready) != 0) {
+            continue;
+        }
+
+        frame = frameRingPeek();
+        if (frame == NULL) {
+            continue;
+        }
+
+        if (frame->size == 0) {
+            end_of_session = true;
+        } else if (socket_fd >= 0) {
+            span_ns = trace_now_ns();
+            trace_span("queue_wait", frame->enqueue_ns, span_ns, frames_sent);
+            if (sendFrame(socket_fd, frame) != 0) {
+                close(socket_fd);
+                socket_fd = -1;
+            } else {
+                trace_span("send", span_ns, trace_now_ns(), frames_sent++);
+            }
+        }
+
+        // Return the entry and its slot to the camera callback
+        frameRingRelease();
+    }
+
+    if (socket_fd < 0) {
+        trace_span("session", session_ns, trace_now_ns(), frames_sent);
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_env_mutex);
+    env_data = g_env_data;
+    pthread_mutex_unlock(&g_env_mutex);
+
+    if (sendEndOfStream(socket_fd, timevalToMicros(&env_data.button_release_time)) != 0) {
+        close(socket_fd);
+        return -1;
     }
 
     printf("All data sent successfully, waiting for analysis result...\n");
 
     // Receive analysis result
+    span_ns = trace_now_ns();
     if (receiveAnalysisResult(socket_fd, result) == 0) {
+        trace_span("wait_result", span_ns, trace_now_ns(), frames_sent);
         displayResult(result);
     }
 
     close(socket_fd);
+    trace_span("session", session_ns, trace_now_ns(), frames_sent);
     return 0;
 }
 
+static int sendSegmentFrame(int socket_fd, const segment_t* segment, uint32_t index)
+{
+    const segment_entry_t* entry;
+    const uint8_t* data;
+
+    entry = segment_frame(segment, index, &data);
+    if (entry == NULL) {
+        return -1;
+    }
+    return sendSegmentEntry(socket_fd, entry, data);
+}
+
+static int sendSegmentEntry(int socket_fd, const segment_entry_t* entry, const uint8_t* data)
+{
+    frame_data_t frame;
+
+    // Sent straight from the mapping, no copy back into memory
+    frame.data = (uint8_t*)data;
+    frame.size = entry->size;
+    frame.timestamp.tv_sec = (time_t)(entry->timestamp_us / 1000000ULL);
+    frame.timestamp.tv_usec = (suseconds_t)(entry->timestamp_us % 1000000ULL);
+    frame.frametype = entry->frametype;
+    frame.width = entry->width;
+    frame.height = entry->height;
+    frame.stride = entry->stride;
+    return sendFrame(socket_fd, &frame);
+}
+
+static void liveUploadPublish(uint32_t committed, bool ended)
+{
+    pthread_mutex_lock(&g_live_upload.lock);
+    g_live_upload.committed = committed;
+    g_live_upload.ended = ended;
+    pthread_cond_signal(&g_live_upload.changed);
+    pthread_mutex_unlock(&g_live_upload.lock);
+}
+
+static void* uploaderThread(void* arg)
+{
+    const segment_header_t* header = g_segment.header;
+    uint32_t committed = 0;
+    uint32_t frames_sent = 0;
+    bool ended = false;
+    uint64_t span_ns;
+    int socket_fd;
+
+    (void)arg;
+
+    trace_thread_name("uploader");
+
+    // Connecting here lets the spill start the moment Button A is pressed
+    span_ns = trace_now_ns();
+    socket_fd = connectToServer();
+    trace_span("connect", span_ns, trace_now_ns(), 0);
+    if ((socket_fd >= 0) &&
+        (sendSessionHeader(socket_fd, header->temperature_centi, header->pressure_centi,
+                           header->button_press_time_us, 0, header->session_id) != 0)) {
+        close(socket_fd);
+        socket_fd = -1;
+    }
+
+    // Stream committed frames as they arrive. A lost link just ends the
+    // live upload; uploadSegment() catches up from the file afterwards.
+    while (socket_fd >= 0) {
+        pthread_mutex_lock(&g_live_upload.lock);
+        while ((frames_sent == g_live_upload.committed) && !g_live_upload.ended) {
+            pthread_cond_wait(&g_live_upload.changed, &g_live_upload.lock);
+        }
+        committed = g_live_upload.committed;
+        ended = g_live_upload.ended;
+        pthread_mutex_unlock(&g_live_upload.lock);
+
+        if (ended && (frames_sent == committed)) {
+            break;
+        }
+
+        // Entries below committed were written before it was published under
+        // the lock, so read them directly: segment_frame() would check the
+        // header counters the drain is still updating.
+        while (frames_sent < committed) {
+            const segment_entry_t* entry = &g_segment.index[frames_sent];
+
+            span_ns = trace_now_ns();
+            if (sendSegmentEntry(socket_fd, entry, g_segment.data + entry->offset) != 0) {
+                close(socket_fd);
+                socket_fd = -1;
+                break;
+            }
+            trace_span("send", span_ns, trace_now_ns(), frames_sent++);
+        }
+    }
+
+    pthread_mutex_lock(&g_live_upload.lock);
+    g_live_upload.socket_fd = socket_fd;
+    g_live_upload.frames_sent = frames_sent;
+    pthread_mutex_unlock(&g_live_upload.lock);
+    return NULL;
+}
+
+static int recordSession(void)
+{
+    segment_entry_t entry;
+    environment_data_t env_data;
+    frame_data_t* frame;
+    pthread_t uploader;
+    bool uploading = false;
+    bool end_of_session = false;
+    bool segment_full = false;
+    uint32_t session_id;
+    uint64_t session_ns = trace_now_ns();
+    uint64_t span_ns;
+    int socket_fd = -1;
+    uint32_t frames_sent = 0;
+    int err;
+
+    pthread_mutex_lock(&g_env_mutex);
+    env_data = g_env_data;
+    pthread_mutex_unlock(&g_env_mutex);
+
+    // Unique enough to tell this session from the last one on the server
+    session_id = (uint32_t)(timevalToMicros(&env_data.button_press_time) ^ ((uint64_t)getpid() << 16));
+    if (session_id == 0) {
+        session_id = 1;
+    }
+
+    // The file was reserved at startup, this only rewrites its header
+    err = segment_reset(&g_segment, session_id);
+    if (err != SEGMENT_SUCCESS) {
+        printf("No recording segment, %s could not be created\n", g_segment_path);
+    } else {
+        g_segment.header->temperature_centi = (int32_t)(env_data.temperature * 100.0);
+        g_segment.header->pressure_centi = (uint32_t)(env_data.pressure * 100.0);
+        g_segment.header->button_press_time_us = timevalToMicros(&env_data.button_press_time);
+
+        // Without an uploader the recording is only spilled, and sent once it ends
+        liveUploadPublish(0, false);
+        g_live_upload.socket_fd = -1;
+        g_live_upload.frames_sent = 0;
+        uploading = (pthread_create(&uploader, NULL, uploaderThread, NULL) == 0);
+        if (!uploading) {
+            printf("Failed to create uploader thread, sending after the recording\n");
+        }
+    }
+
+    // This loop only spills: every frame is copied to the segment and its
+    // slot released at once, so the ring has to keep up with the disk alone
+    while (!end_of_session) {
+        if (sem_wait(&g_frames_ready) != 0) {
+            continue;
+        }
+
+        frame = frameRingPeek();
+        if (frame == NULL) {
+            continue;
+        }
+
+        if (frame->size == 0) {
+            end_of_session = true;
+        } else if (err == SEGMENT_SUCCESS) {
+            memset(&entry, 0, sizeof(entry));
+            entry.timestamp_us = timevalToMicros(&frame->timestamp);
+            entry.size = (uint32_t)frame->size;
+            entry.frametype = frame->frametype;
+            entry.width = frame->width;
+            entry.height = frame->height;
+            entry.stride = frame->stride;
+
+            span_ns = trace_now_ns();
+            trace_span("queue_wait", frame->enqueue_ns, span_ns, g_segment.header->frame_count);
+            if (segment_append(&g_segment, &entry, frame->data) != SEGMENT_SUCCESS) {
+                if (!segment_full) {
+                    printf("Recording segment is full after %u frames\n", g_segment.header->frame_count);
+                    segment_full = true;
+                }
+            } else {
+                trace_span("spill", span_ns, trace_now_ns(), g_segment.header->frame_count - 1);
+                liveUploadPublish(g_segment.header->frame_count, false);
+            }
+        }
+
+        frameRingRelease();
+    }
+
+    if (err != SEGMENT_SUCCESS) {
+        return -1;
+    }
+
+    // The uploader finishes what is committed, or gives up within
+    // SEND_TIMEOUT_S, and hands its connection over
+    liveUploadPublish(g_segment.header->frame_count, true);
+    if (uploading) {
+        pthread_join(uploader, NULL);
+        socket_fd = g_live_upload.socket_fd;
+        frames_sent = g_live_upload.frames_sent;
+    }
+
+    pthread_mutex_lock(&g_env_mutex);
+    env_data = g_env_data;
+    pthread_mutex_unlock(&g_env_mutex);
+    g_segment.header->button_release_time_us = timevalToMicros(&env_data.button_release_time);
+    segment_set_state(&g_segment, SEGMENT_STATE_COMPLETE);
+
+    // A failed upload keeps the file; Button A retries it before recording again
+    err = uploadSegment(&g_segment, socket_fd, frames_sent);
+    atomic_store(&g_segment_pending, err != 0);
+    trace_span("session", session_ns, trace_now_ns(), g_segment.header->frame_count);
+    return err;
+}
+
+static int resumeUpload(const segment_t* segment, uint32_t* next_frame)
+{
+    stream_result_header_t ack;
+    int socket_fd;
+
+    socket_fd = connectToServer();
+    if (socket_fd < 0) {
+        return -1;
+    }
+
+    if (sendSessionHeader(socket_fd, segment->header->temperature_centi, segment->header->pressure_centi,
+                          segment->header->button_press_time_us, STREAM_FLAG_RESUME,
+                          segment->header->session_id) != 0) {
+        close(socket_fd);
+        return -1;
+    }
+
+    if ((recvAll(socket_fd, &ack, sizeof(ack)) != (int)sizeof(ack)) ||
+        (ntohl(ack.msg_type) != STREAM_MSG_RESUME)) {
+        printf("No resume reply from server\n");
+        close(socket_fd);
+        return -1;
+    }
+
+    if ((ntohl(ack.status) == STREAM_RESULT_OK) && (ntohl(ack.frames_received) <= segment->header->frame_count)) {
+        *next_frame = ntohl(ack.frames_received);
+        printf("Resuming upload at frame %u of %u\n", *next_frame, segment->header->frame_count);
+        return socket_fd;
+    }
+
+    // The server has no record of this session, or it expired or restarted
+    // since: start it again from frame 0
+    close(socket_fd);
+    socket_fd = connectToServer();
+    if ((socket_fd >= 0) &&
+        (sendSessionHeader(socket_fd, segment->header->temperature_centi, segment->header->pressure_centi,
+                           segment->header->button_press_time_us, 0, segment->header->session_id) != 0)) {
+        close(socket_fd);
+        return -1;
+    }
+
+    *next_frame = 0;
+    printf("Server lost the session, uploading all %u frames again\n", segment->header->frame_count);
+    return socket_fd;
+}
+
+static int uploadSegment(segment_t* segment, int socket_fd, uint32_t next_frame)
+{
+    char result[5] = {0};
+    uint64_t span_ns;
+    int attempt;
+    int err;
+
+    for (attempt = 0; attempt <= UPLOAD_RETRY_LIMIT; attempt++) {
+        if (socket_fd < 0) {
+            if (attempt > 0) {
+                usleep(UPLOAD_RETRY_DELAY_US);
+            }
+            socket_fd = resumeUpload(segment, &next_frame);
+            if (socket_fd < 0) {
+                continue;
+            }
+        }
+
+        while (next_frame < segment->header->frame_count) {
+            span_ns = trace_now_ns();
+            if (sendSegmentFrame(socket_fd, segment, next_frame) != 0) {
+                break;
+            }
+            trace_span("send", span_ns, trace_now_ns(), next_frame++);
+        }
+
+        if ((next_frame == segment->header->frame_count) &&
+            (sendEndOfStream(socket_fd, segment->header->button_release_time_us) == 0)) {
+            printf("All data sent successfully, waiting for analysis result...\n");
+
+            span_ns = trace_now_ns();
+            err = receiveAnalysisResult(socket_fd, result);
+            if (err == 0) {
+                trace_span("wait_result", span_ns, trace_now_ns(), next_frame);
+                segment_set_state(segment, SEGMENT_STATE_UPLOADED);
+                displayResult(result);
+                close(socket_fd);
+                return 0;
+            }
+
+            if (err > 0) {
+                close(socket_fd);
+                return -1;
+            }
+
+            // The server keeps a finished session's result for a while, so
+            // resuming the same session id at its own frame count (all of
+            // them) just has it send the result again
+            printf("Lost the analysis result, asking the server for it again\n");
+        }
+
+        close(socket_fd);
+        socket_fd = -1;
+    }
+
+    printf("Giving up on the upload; the recording stays in %s, press Button A to retry\n", g_segment_path);
+    return -1;
+}
+
+static int recoverSegment(void)
+{
+    const segment_entry_t* last;
+    const uint8_t* data;
+    int err;
+
+    // Nothing left to upload, a new recording may reuse the file
+    atomic_store(&g_segment_pending, false);
+    if ((g_segment.header == NULL) && (segment_open(&g_segment, g_segment_path) != SEGMENT_SUCCESS)) {
+        return 0;
+    }
+
+    if ((g_segment.header->state == SEGMENT_STATE_UPLOADED) || (g_segment.header->frame_count == 0)) {
+        return 0;
+    }
+
+    // A recording cut short by a crash ends at its last committed frame
+    if (g_segment.header->state == SEGMENT_STATE_RECORDING) {
+        last = segment_frame(&g_segment, g_segment.header->frame_count - 1, &data);
+        g_segment.header->button_release_time_us = (last != NULL) ? last->timestamp_us : 0;
+        segment_set_state(&g_segment, SEGMENT_STATE_COMPLETE);
+    }
+
+    printf("Uploading %u frames left in %s\n", g_segment.header->frame_count, g_segment_path);
+    uiSetText("SEND", false);
+    err = uploadSegment(&g_segment, -1, 0);
+    if (err != 0) {
+        atomic_store(&g_segment_pending, true);
+        uiSetText("ERR", false);
+    }
+    return err;
+}
+
+static void prepareSegment(void)
+{
+    // A recording still waiting for its upload keeps the file as it is
+    if (atomic_load(&g_segment_pending)) {
+        return;
+    }
+
+    // Reuse whatever file is already open if it has the size we need
+    if ((g_segment.header != NULL) && (g_segment.header->max_frames == RECORDING_SEGMENT_FRAMES) &&
+        (g_segment.header->data_capacity == RECORDING_SEGMENT_BYTES)) {
+        return;
+    }
+
+    // Reserving a whole segment takes a while, so it is done here between
+    // sessions and never after Button A
+    segment_close(&g_segment);
+    if (segment_create(&g_segment, g_segment_path, RECORDING_SEGMENT_BYTES, RECORDING_SEGMENT_FRAMES, 0) !=
+        SEGMENT_SUCCESS) {
+        printf("Failed to create recording segment %s\n", g_segment_path);
+    }
+}
+
 static int receiveAnalysisResult(int socket_fd, char* result)
 {
-    int bytes_received = recv(socket_fd, result, 4, 0);
+    stream_result_header_t header;
+    char payload[STREAM_RESULT_MAX_PAYLOAD];
+    uint32_t payload_size;
+
+    int bytes_received = recvAll(socket_fd, &header, sizeof(header));
     if (bytes_received < 0) {
         printf("Failed to receive analysis result: %s\n", strerror(errno));
         return -1;
     }
     
-    if (bytes_received != 4) {
+    if (bytes_received != sizeof(header)) {
         printf("Received incomplete analysis result\n");
         return -1;
     }
-    
+
+    payload_size = ntohl(header.payload_size);
+    if ((ntohl(header.msg_type) != STREAM_MSG_RESULT) || (payload_size > sizeof(payload))) {
+        printf("Received malformed analysis result\n");
+        return -1;
+    }
+
+    if (recvAll(socket_fd, payload, payload_size) != (int)payload_size) {
+        printf("Received incomplete analysis result\n");
+        return -1;
+    }
+
+    // A reply that did arrive is final; only a lost one is worth asking for again
+    if (ntohl(header.status) != STREAM_RESULT_OK) {
+        printf("Server reported an error after %u frames\n", ntohl(header.frames_received));
+        return 1;
+    }
+
+    // The display shows four characters
+    memset(result, ' ', 4);
+    memcpy(result, payload, (payload_size < 4) ? payload_size : 4);
     result[4] = '\0'; // Null terminate
     printf("Received analysis result: %s\n", result);
     return 0;
@@ -509,14 +1980,10 @@ static int receiveAnalysisResult(int socket_fd, char* result)
 static void displayResult(const char* result)
 {
     // Display result on alphanumeric display
-    set_alphanum_string(result);
-    show_alphanum();
+    uiSetText(result, false);
     
     // Set RGB LEDs to green for success
-    for (int i = 0; i < 7; i++) {
-        set_rgb_led(i, 0, 255, 0, 50);
-    }
-    show_rgb_leds();
+    uiSetRgb(0, 255, 0, 50);
     
     // Set green LED
     set_led(Led_RED, false);
@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PREPROCESS_USE_NEON 1
+#endif
+
+#include "frame_preprocess.h"
+#include "stream_protocol.h"
+
+/**
+ * @brief BT.601 luma weights in 1/256ths (sum to 256)
+ */
+#define LUMA_R_WEIGHT 77
+#define LUMA_G_WEIGHT 150
+#define LUMA_B_WEIGHT 29
+
+/**
+ * @brief Byte offsets of the first luma sample and the colour channels
+ *        within a pixel for each supported input layout
+ */
+typedef struct {
+    unsigned int y_offset;      /* YUV422: first Y within a macropixel */
+    unsigned int r_offset;      /* RGB32: red channel */
+    unsigned int b_offset;      /* RGB32: blue channel */
+} pixel_layout_t;
+
+static bool isYuv422(uint32_t frametype)
+{
+    return (frametype == STREAM_FRAMETYPE_YCBYCR) || (frametype == STREAM_FRAMETYPE_CBYCRY);
+}
+
+static bool isRgb32(uint32_t frametype)
+{
+    return (frametype == STREAM_FRAMETYPE_RGB8888) || (frametype == STREAM_FRAMETYPE_BGR8888);
+}
+
+static pixel_layout_t pixelLayout(uint32_t frametype)
+{
+    pixel_layout_t layout = { 0, 0, 2 };
+
+    switch (frametype) {
+    case STREAM_FRAMETYPE_YCBYCR:
+        layout.y_offset = 0;
+        break;
+    case STREAM_FRAMETYPE_CBYCRY:
+        layout.y_offset = 1;
+        break;
+    case STREAM_FRAMETYPE_BGR8888:
+        layout.r_offset = 2;
+        layout.b_offset = 0;
+        break;
+    default:
+        break;
+    }
+
+    return layout;
+}
+
+static inline uint8_t lumaFromRgb(uint8_t r, uint8_t g, uint8_t b)
+{
+    return (uint8_t)(((LUMA_R_WEIGHT * r) + (LUMA_G_WEIGHT * g) + (LUMA_B_WEIGHT * b) + 128) >> 8);
+}
+
+/*-----------------------------------------------------------
+* Row kernels. Each converts out_count output samples from one
+* source row, taking every step-th source pixel. Returns the
+* number of samples handled so the scalar code can finish the tail.
+*-----------------------------------------------------------
+*/
+
+#ifdef PREPROCESS_USE_NEON
+
+static unsigned int lumaRowYuv422Neon(const uint8_t* src, uint8_t* dst, unsigned int out_count,
+                                      unsigned int step, unsigned int y_offset)
+{
+    unsigned int x = 0;
+
+    for (; x + 16 <= out_count; x += 16) {
+        uint8x16_t y;
+
+        if (step == 1) {
+            // 16 pixels = 32 bytes, Y sits on every other byte
+            uint8x16x2_t px = vld2q_u8(src + (2 * x));
+            y = px.val[y_offset];
+        } else if (step == 2) {
+            // 16 macropixels = 64 bytes, first Y of each
+            uint8x16x4_t mp = vld4q_u8(src + (4 * x));
+            y = mp.val[y_offset];
+        } else {
+            // 32 macropixels = 128 bytes, first Y of every other one
+            uint8x16x4_t a = vld4q_u8(src + (8 * x));
+            uint8x16x4_t b = vld4q_u8(src + (8 * x) + 64);
+            y = vuzp1q_u8(a.val[y_offset], b.val[y_offset]);
+        }
+
+        vst1q_u8(dst + x, y);
+    }
+
+    return x;
+}
+
+static inline void loadRgb32Planes(const uint8_t* src, unsigned int step, uint8x16x4_t* planes)
+{
+    if (step == 1) {
+        *planes = vld4q_u8(src);
+    } else if (step == 2) {
+        uint8x16x4_t a = vld4q_u8(src);
+        uint8x16x4_t b = vld4q_u8(src + 64);
+        for (int c = 0; c < 4; c++) {
+            planes->val[c] = vuzp1q_u8(a.val[c], b.val[c]);
+        }
+    } else {
+        uint8x16x4_t a = vld4q_u8(src);
+        uint8x16x4_t b = vld4q_u8(src + 64);
+        uint8x16x4_t c = vld4q_u8(src + 128);
+        uint8x16x4_t d = vld4q_u8(src + 192);
+        for (int p = 0; p < 4; p++) {
+            planes->val[p] = vuzp1q_u8(vuzp1q_u8(a.val[p], b.val[p]), vuzp1q_u8(c.val[p], d.val[p]));
+        }
+    }
+}
+
+static unsigned int lumaRowRgb32Neon(const uint8_t* src, uint8_t* dst, unsigned int out_count,
+                                     unsigned int step, const pixel_layout_t* layout)
+{
+    const uint8x8_t wr = vdup_n_u8(LUMA_R_WEIGHT);
+    const uint8x8_t wg = vdup_n_u8(LUMA_G_WEIGHT);
+    const uint8x8_t wb = vdup_n_u8(LUMA_B_WEIGHT);
+    unsigned int x = 0;
+
+    for (; x + 16 <= out_count; x += 16) {
+        uint8x16x4_t px;
+        loadRgb32Planes(src + (4 * step * x), step, &px);
+
+        uint8x16_t r = px.val[layout->r_offset];
+        uint8x16_t g = px.val[1];
+        uint8x16_t b = px.val[layout->b_offset];
+
+        uint16x8_t lo = vmull_u8(vget_low_u8(r), wr);
+        lo = vmlal_u8(lo, vget_low_u8(g), wg);
+        lo = vmlal_u8(lo, vget_low_u8(b), wb);
+
+        uint16x8_t hi = vmull_high_u8(r, vcombine_u8(wr, wr));
+        hi = vmlal_high_u8(hi, g, vcombine_u8(wg, wg));
+        hi = vmlal_high_u8(hi, b, vcombine_u8(wb, wb));
+
+        vst1q_u8(dst + x, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+    }
+
+    return x;
+}
+
+static unsigned int decimateRowYuv422Neon(const uint8_t* src, uint8_t* dst, unsigned int out_macropixels,
+                                          unsigned int step, unsigned int y_offset)
+{
+    unsigned int k = 0;
+
+    // Output macropixel k takes the first Y and the chroma of source
+    // macropixel step*k, and the first Y of macropixel step*k + step/2
+    for (; k + 16 <= out_macropixels; k += 16) {
+        uint8x16x4_t lo, hi, out;
+
+        if (step == 2) {
+            lo = vld4q_u8(src + (8 * k));
+            hi = vld4q_u8(src + (8 * k) + 64);
+        } else {
+            uint8x16x4_t a = vld4q_u8(src + (16 * k));
+            uint8x16x4_t b = vld4q_u8(src + (16 * k) + 64);
+            uint8x16x4_t c = vld4q_u8(src + (16 * k) + 128);
+            uint8x16x4_t d = vld4q_u8(src + (16 * k) + 192);
+            for (int p = 0; p < 4; p++) {
+                lo.val[p] = vuzp1q_u8(a.val[p], b.val[p]);
+                hi.val[p] = vuzp1q_u8(c.val[p], d.val[p]);
+            }
+        }
+
+        for (unsigned int p = 0; p < 4; p++) {
+            if (p == y_offset + 2) {
+                out.val[p] = vuzp2q_u8(lo.val[y_offset], hi.val[y_offset]);
+            } else {
+                out.val[p] = vuzp1q_u8(lo.val[p], hi.val[p]);
+            }
+        }
+
+        vst4q_u8(dst + (4 * k), out);
+    }
+
+    return k;
+}
+
+static unsigned int decimateRowRgb32Neon(const uint8_t* src, uint8_t* dst, unsigned int out_count,
+                                         unsigned int step)
+{
+    const uint32_t* in = (const uint32_t*)src;
+    uint32_t* out = (uint32_t*)dst;
+    unsigned int x = 0;
+
+    for (; x + 4 <= out_count; x += 4) {
+        if (step == 2) {
+            vst1q_u32(out + x, vld2q_u32(in + (2 * x)).val[0]);
+        } else {
+            vst1q_u32(out + x, vld4q_u32(in + (4 * x)).val[0]);
+        }
+    }
+
+    return x;
+}
+
+#endif /* PREPROCESS_USE_NEON */
+
+static void lumaRowYuv422(const uint8_t* src, uint8_t* dst, unsigned int out_count,
+                          unsigned int step, unsigned int y_offset)
+{
+    unsigned int x = 0;
+
+#ifdef PREPROCESS_USE_NEON
+    x = lumaRowYuv422Neon(src, dst, out_count, step, y_offset);
+#endif
+
+    for (; x < out_count; x++) {
+        dst[x] = src[(2 * step * x) + y_offset];
+    }
+}
+
+static void lumaRowRgb32(const uint8_t* src, uint8_t* dst, unsigned int out_count,
+                         unsigned int step, const pixel_layout_t* layout)
+{
+    unsigned int x = 0;
+
+#ifdef PREPROCESS_USE_NEON
+    x = lumaRowRgb32Neon(src, dst, out_count, step, layout);
+#endif
+
+    for (; x < out_count; x++) {
+        const uint8_t* px = src + (4 * step * x);
+        dst[x] = lumaFromRgb(px[layout->r_offset], px[1], px[layout->b_offset]);
+    }
+}
+
+static void decimateRowYuv422(const uint8_t* src, uint8_t* dst, unsigned int out_macropixels,
+                              unsigned int step, unsigned int y_offset)
+{
+    unsigned int k = 0;
+
+#ifdef PREPROCESS_USE_NEON
+    k = decimateRowYuv422Neon(src, dst, out_macropixels, step, y_offset);
+#endif
+
+    for (; k < out_macropixels; k++) {
+        const uint8_t* first = src + (4 * step * k);
+        const uint8_t* second = first + (2 * step);
+        uint8_t* out = dst + (4 * k);
+
+        for (unsigned int p = 0; p < 4; p++) {
+            out[p] = (p == y_offset + 2) ? second[y_offset] : first[p];
+        }
+    }
+}
+
+static void decimateRowRgb32(const uint8_t* src, uint8_t* dst, unsigned int out_count, unsigned int step)
+{
+    unsigned int x = 0;
+
+#ifdef PREPROCESS_USE_NEON
+    x = decimateRowRgb32Neon(src, dst, out_count, step);
+#endif
+
+    for (; x < out_count; x++) {
+        memcpy(dst + (4 * x), src + (4 * step * x), 4);
+    }
+}
+
+/*-----------------------------------------------------------
+* Public API
+*-----------------------------------------------------------
+*/
+
+bool preprocess_is_active(const preprocess_config_t* config)
+{
+    return config->luma_only || (config->decimation > 1);
+}
+
+int preprocess_output_format(const preprocess_config_t* config, const preprocess_format_t* in,
+                             preprocess_format_t* out)
+{
+    unsigned int step = (config->decimation == 0) ? 1 : config->decimation;
+
+    if (((step != 1) && (step != 2) && (step != 4)) || (!isYuv422(in->frametype) && !isRgb32(in->frametype))) {
+        return PREPROCESS_ERROR_BAD_ARGUMENT;
+    }
+
+    out->width = in->width / step;
+    out->height = in->height / step;
+
+    if (config->luma_only) {
+        out->frametype = STREAM_FRAMETYPE_GRAY8;
+        out->stride = out->width;
+    } else if (isYuv422(in->frametype)) {
+        // Chroma is shared by pixel pairs, keep whole macropixels
+        out->frametype = in->frametype;
+        out->width &= ~1U;
+        out->stride = out->width * 2;
+    } else {
+        out->frametype = in->frametype;
+        out->stride = out->width * 4;
+    }
+
+    return PREPROCESS_SUCCESS;
+}
+
+size_t preprocess_frame(const preprocess_config_t* config, const preprocess_format_t* in, const uint8_t* src,
+                        const preprocess_format_t* out, uint8_t* dst)
+{
+    unsigned int step = (config->decimation == 0) ? 1 : config->decimation;
+    pixel_layout_t layout = pixelLayout(in->frametype);
+
+    if ((src == NULL) || (dst == NULL) || ((out->height * step) > in->height)) {
+        return 0;
+    }
+
+    for (uint32_t y = 0; y < out->height; y++) {
+        const uint8_t* src_row = src + ((size_t)y * step * in->stride);
+        uint8_t* dst_row = dst + ((size_t)y * out->stride);
+
+        if (out->frametype == STREAM_FRAMETYPE_GRAY8) {
+            if (isYuv422(in->frametype)) {
+                lumaRowYuv422(src_row, dst_row, out->width, step, layout.y_offset);
+            } else {
+                lumaRowRgb32(src_row, dst_row, out->width, step, &layout);
+            }
+        } else if (step == 1) {
+            memcpy(dst_row, src_row, out->stride);
+        } else if (isYuv422(in->frametype)) {
+            decimateRowYuv422(src_row, dst_row, out->width / 2, step, layout.y_offset);
+        } else {
+            decimateRowRgb32(src_row, dst_row, out->width, step);
+        }
+    }
+
+    return (size_t)out->stride * out->height;
+}
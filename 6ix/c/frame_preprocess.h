@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+* @file frame_preprocess.h
+* @brief Client-side frame reduction applied before frames are queued for upload.
+*
+* Frames are copied out of the camera buffer through one of these kernels
+* instead of a plain memcpy:
+*  - luma-only extraction (YCBYCR/CBYCRY/RGB8888/BGR8888 -> GRAY8)
+*  - 2x / 4x decimation in both directions
+*
+* Frame skipping to a target rate is decided by the caller from the config.
+* The kernels use NEON on aarch64 and fall back to scalar C elsewhere.
+*/
+
+#ifndef FRAME_PREPROCESS_H
+#define FRAME_PREPROCESS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Return Codes */
+#define PREPROCESS_SUCCESS 0
+#define PREPROCESS_ERROR_BAD_ARGUMENT -1
+
+/* --- Preprocessing settings. --- */
+typedef struct {
+    bool luma_only;             /* emit STREAM_FRAMETYPE_GRAY8 */
+    unsigned int decimation;    /* 1, 2 or 4 */
+    unsigned int target_fps;    /* 0 keeps every frame */
+} preprocess_config_t;
+
+/* --- Frame layout, frametype is one of STREAM_FRAMETYPE_*. --- */
+typedef struct {
+    uint32_t frametype;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+} preprocess_format_t;
+
+/**
+* @brief Checks whether the config does anything beyond a plain copy.
+*
+* @param config preprocessing settings
+* @return true if frames need to go through preprocess_frame.
+*/
+bool preprocess_is_active(const preprocess_config_t *config);
+
+/**
+* @brief Computes the layout of a preprocessed frame. Output rows are packed.
+*
+* @param config preprocessing settings
+* @param in layout of the camera frame
+* @param out receives the layout of the preprocessed frame
+* @return int PREPROCESS_SUCCESS on success, PREPROCESS_ERROR_BAD_ARGUMENT for
+*         an unsupported frametype or decimation factor.
+*/
+int preprocess_output_format(const preprocess_config_t *config, const preprocess_format_t *in,
+                             preprocess_format_t *out);
+
+/**
+* @brief Converts one frame from the camera buffer into the destination buffer.
+*
+* @param config preprocessing settings
+* @param in layout of the camera frame
+* @param src camera frame data
+* @param out layout from preprocess_output_format
+* @param dst destination, at least out->stride * out->height bytes
+* @return size_t number of bytes written to dst, 0 on bad arguments.
+*/
+size_t preprocess_frame(const preprocess_config_t *config, const preprocess_format_t *in, const uint8_t *src,
+                        const preprocess_format_t *out, uint8_t *dst);
+
+#endif /* FRAME_PREPROCESS_H */
@@ -40,6 +40,7 @@
 /* Return Codes */
 #define RH_SUCCESS 0
 #define RH_FAILURE -1
+#define RH_TIMEOUT -2
  
 /* Global pointer for accessing GPIO registers */
 extern volatile uint32_t *__RPI_GPIO_REGS;
@@ -89,6 +90,54 @@ int init_button(enum Buttons button);
 bool read_button(enum Buttons button);
 
 
+/*-----------------------------------------------------------
+* Button events
+*-----------------------------------------------------------
+*/
+
+#define BUTTON_DEBOUNCE_MS      20
+
+/* --- One debounced press or release. --- */
+typedef struct {
+    enum Buttons button;
+    bool pressed;               /* true on press, false on release */
+    uint64_t timestamp_ns;      /* CLOCK_MONOTONIC time the edge was seen */
+} button_event_t;
+
+/**
+* @brief Creates the pulse channel that GPIO edge events are delivered on.
+*
+* @param debounce_ms Edges closer together than this are treated as contact bounce.
+* @return int RH_SUCCESS on success, RH_FAILURE on failure.
+*/
+int init_button_events(unsigned int debounce_ms);
+
+/**
+* @brief Registers for press and release edges on a button. Call init_button() first.
+*
+* @param button The button, from Buttons.
+* @return int RH_SUCCESS on success, RH_FAILURE on failure.
+*/
+int enable_button_event(enum Buttons button);
+
+/**
+* @brief Waits for the next debounced button event. The caller sleeps in
+*        MsgReceivePulse until an edge arrives, so nothing is polled.
+*        Only one thread may wait at a time.
+*
+* @param event Receives the button and its new state.
+* @param timeout_ms How long to wait, 0 to wait forever.
+* @return int RH_SUCCESS on an event, RH_TIMEOUT if none arrived in time, RH_FAILURE on error.
+*/
+int wait_button_event(button_event_t *event, uint32_t timeout_ms);
+
+/**
+* @brief Releases the button event channel.
+*
+*/
+void cleanup_button_events(void);
+
+
 /*-----------------------------------------------------------
 * Plain LEDs (A/B/C)
 *-----------------------------------------------------------
@@ -129,7 +178,7 @@ int set_led(enum Leds led, bool state);
 #define APA102_NUMLEDS          7
 
 /**
-* @brief Initializes the APA102 LED driver.
+* @brief Initializes the APA102 LED driver on hardware SPI0 (DAT/CLK/CS are MOSI/SCLK/CE0).
 *
 * @return int RH_SUCCESS on success, RH_FAILURE on error.
 */
@@ -148,6 +197,8 @@ void set_rgb_led(uint8_t led_index, uint8_t r, uint8_t g, uint8_t b, uint8_t bri
 
 /**
 * @brief Display the pixel buffer on the LEDs. Change the buffer with set_rgb_led(..).
+*        The whole strip goes out as one SPI transfer, skipped if the buffer
+*        is unchanged since the last show.
 *
 */
 void show_rgb_leds(void);
@@ -239,6 +290,52 @@ void set_buzzer_freq(unsigned int freq, uint32_t millis);
 */
 void stop_buzzer(void);
 
+/* --- Buzzer sequencer: notes are queued and played from a background thread. --- */
+#define BUZZER_QUEUE_LEN        32
+
+/* --- One queued note. --- */
+typedef struct {
+    unsigned int freq;          /* Hz, 0 for a rest */
+    uint32_t millis;            /* how long to hold it */
+} buzzer_note_t;
+
+/**
+* @brief Starts the sequencer thread. The buzzer is driven with
+*        rpi_gpio_setup_pwm()/rpi_gpio_set_pwm_duty_cycle() from that thread only,
+*        so don't mix this with set_buzzer_freq().
+*
+* @return int RH_SUCCESS on success, RH_FAILURE on error.
+*/
+int init_buzzer_sequencer(void);
+
+/**
+* @brief Appends notes to the queue and returns straight away. Each note
+*        starts exactly when the previous one ends.
+*
+* @param notes Notes to play, in order.
+* @param count Number of notes.
+* @return int RH_SUCCESS if all notes were queued, RH_FAILURE if the sequencer
+*         isn't running or the queue hasn't room for all of them (none are queued).
+*/
+int queue_buzzer_notes(const buzzer_note_t *notes, unsigned int count);
+
+/**
+* @brief Drops the queued notes and silences the buzzer.
+*/
+void flush_buzzer_notes(void);
+
+/**
+* @brief Checks whether the sequencer is playing or has notes queued.
+*
+* @return bool true while notes are playing.
+*/
+bool buzzer_busy(void);
+
+/**
+* @brief Silences the buzzer and stops the sequencer thread.
+*/
+void cleanup_buzzer_sequencer(void);
+
 /*-----------------------------------------------------------
 * BMP280 temp/humidity functions
 *-----------------------------------------------------------
@@ -297,4 +394,44 @@ int init_bmp(void);
 */
 int get_bmp_data(double *temperature, double *pressure);
 
+
+/*-----------------------------------------------------------
+* BMP280 sampling service
+*-----------------------------------------------------------
+*/
+
+#define BMP_SAMPLE_PERIOD_MS    500 // matches BMP280_T_SB, a new result every 500ms
+
+/* --- Latest compensated BMP280 reading. --- */
+typedef struct {
+    double temperature;         /* degrees C */
+    double pressure;            /* hPa */
+    uint64_t timestamp_ns;      /* CLOCK_MONOTONIC time the registers were read */
+    uint32_t sample_count;      /* samples published since the service started */
+} bmp_snapshot_t;
+
+/**
+* @brief Puts the BMP280 in normal mode (BMP280_CTRL_MEAS / BMP280_CONFIG) and
+*        starts a thread that burst-reads the data registers every period and
+*        publishes the result. Takes the first sample before returning.
+*
+* @param period_ms How often to read the sensor, BMP_SAMPLE_PERIOD_MS normally.
+* @return int RH_SUCCESS on success, RH_FAILURE on error.
+*/
+int start_bmp_service(uint32_t period_ms);
+
+/**
+* @brief Gets the latest published reading. This never touches the I2C bus and
+*        never blocks, so it is safe to call from any thread at any rate.
+*
+* @param snapshot Receives the reading.
+* @return int RH_SUCCESS on success, RH_FAILURE if the service has no sample yet.
+*/
+int get_bmp_snapshot(bmp_snapshot_t *snapshot);
+
+/**
+* @brief Stops the sampling thread and puts the BMP280 back to sleep.
+*/
+void stop_bmp_service(void);
+
 #endif // RAINBOWHAT_H
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+* @file rainbowhat_apa102.c
+* @brief APA102 RGB LEDs on the Rainbow HAT, driven over hardware SPI0.
+*
+* DAT/CLK/CS are the SPI0 MOSI/SCLK/CE0 pins, so the whole strip is sent as
+* one SPI transfer: start frame, one 4-byte frame per LED, end frame. The
+* LED frames live in the transfer buffer itself, so set_rgb_led() encodes in
+* place and show_rgb_leds() skips the transfer if nothing changed since the
+* last one that was sent.
+*/
+
+#include <pthread.h>
+#include <string.h>
+
+#include "rainbowhat.h"
+#include "rpi_spi.h"
+
+#define APA102_SPI_BUS          0
+#define APA102_SPI_DEVICE       0   /* CE0, APA102_CS */
+#define APA102_SPI_SPEED_HZ     4000000
+#define APA102_SPI_DEVICE_MODE  0b00010000010000001000  /* same as the ws281x strips, 8-bit words */
+
+#define APA102_START_BYTES      4
+#define APA102_LED_BYTES        4
+#define APA102_END_BYTES        5   /* 36+ clocks to latch the small dark die parts */
+#define APA102_FRAME_BYTES      (APA102_START_BYTES + (APA102_NUMLEDS * APA102_LED_BYTES) + APA102_END_BYTES)
+#define APA102_LED_HEADER       0xE0
+#define APA102_MAX_BRIGHTNESS   31
+#define APA102_DEFAULT_BRIGHTNESS 7
+
+static pthread_mutex_t g_apa102_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t g_frame[APA102_FRAME_BYTES];     /* start/end frames stay zero */
+static uint8_t g_sent_frame[APA102_FRAME_BYTES];
+static bool g_sent_valid = false;
+static bool g_initialized = false;
+
+static uint8_t *ledFrame(uint8_t led_index)
+{
+    return &g_frame[APA102_START_BYTES + (led_index * APA102_LED_BYTES)];
+}
+
+int init_rgb_led(void)
+{
+    uint8_t i;
+
+    pthread_mutex_lock(&g_apa102_mutex);
+
+    if (!g_initialized) {
+        if (rpi_spi_configure_device(APA102_SPI_BUS, APA102_SPI_DEVICE, APA102_SPI_DEVICE_MODE,
+                                     APA102_SPI_SPEED_HZ) != SPI_SUCCESS) {
+            pthread_mutex_unlock(&g_apa102_mutex);
+            fprintf(stderr, "Failed to configure SPI%d for the APA102 LEDs\n", APA102_SPI_BUS);
+            return RH_FAILURE;
+        }
+
+        memset(g_frame, 0, sizeof(g_frame));
+        for (i = 0; i < APA102_NUMLEDS; i++) {
+            ledFrame(i)[0] = APA102_LED_HEADER | APA102_DEFAULT_BRIGHTNESS;
+        }
+        g_sent_valid = false;
+        g_initialized = true;
+    }
+
+    pthread_mutex_unlock(&g_apa102_mutex);
+    return RH_SUCCESS;
+}
+
+void set_rgb_led(uint8_t led_index, uint8_t r, uint8_t g, uint8_t b, uint8_t brightness)
+{
+    uint8_t *led;
+
+    if (led_index >= APA102_NUMLEDS) {
+        return;
+    }
+
+    if (brightness > 100) {
+        brightness = 100;
+    }
+
+    pthread_mutex_lock(&g_apa102_mutex);
+
+    led = ledFrame(led_index);
+    led[0] = APA102_LED_HEADER | (uint8_t)((brightness * APA102_MAX_BRIGHTNESS) / 100);
+    led[1] = b;
+    led[2] = g;
+    led[3] = r;
+
+    pthread_mutex_unlock(&g_apa102_mutex);
+}
+
+void show_rgb_leds(void)
+{
+    pthread_mutex_lock(&g_apa102_mutex);
+
+    // The strip already shows this buffer
+    if (!g_initialized || (g_sent_valid && memcmp(g_frame, g_sent_frame, sizeof(g_frame)) == 0)) {
+        pthread_mutex_unlock(&g_apa102_mutex);
+        return;
+    }
+
+    if (rpi_spi_write_read_data(APA102_SPI_BUS, APA102_SPI_DEVICE, g_frame, NULL, sizeof(g_frame)) == SPI_SUCCESS) {
+        memcpy(g_sent_frame, g_frame, sizeof(g_frame));
+        g_sent_valid = true;
+    } else {
+        // Resend next time even if the buffer is unchanged
+        g_sent_valid = false;
+    }
+
+    pthread_mutex_unlock(&g_apa102_mutex);
+}
+
+void clear_rbg_leds(void)
+{
+    uint8_t i;
+
+    pthread_mutex_lock(&g_apa102_mutex);
+    for (i = 0; i < APA102_NUMLEDS; i++) {
+        memset(&ledFrame(i)[1], 0, APA102_LED_BYTES - 1);
+    }
+    pthread_mutex_unlock(&g_apa102_mutex);
+
+    show_rgb_leds();
+}
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+* @file rainbowhat_bmp280.c
+* @brief Background BMP280 sampling with a lock-free latest-value snapshot.
+*
+* The sensor runs in normal mode, measuring on its own every standby period.
+* A sampling thread burst-reads the six pressure/temperature data registers
+* in one transfer (which the BMP280 guarantees come from the same
+* measurement), compensates them and publishes the result under a sequence
+* lock. Readers copy the snapshot and retry if the writer was in the middle of
+* an update, so they never wait on the bus or on a mutex.
+*/
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "rainbowhat.h"
+#include "rpi_i2c.h"
+
+#define BMP280_CALIB_BYTES      24  /* dig_T1 .. dig_P9, 0x88 - 0x9F */
+#define BMP280_DATA_BYTES       6   /* press msb/lsb/xlsb, temp msb/lsb/xlsb, 0xF7 - 0xFC */
+
+/* --- Factory calibration, see the BMP280 datasheet section 3.11.2. --- */
+typedef struct {
+    uint16_t dig_T1;
+    int16_t dig_T2;
+    int16_t dig_T3;
+    uint16_t dig_P1;
+    int16_t dig_P2;
+    int16_t dig_P3;
+    int16_t dig_P4;
+    int16_t dig_P5;
+    int16_t dig_P6;
+    int16_t dig_P7;
+    int16_t dig_P8;
+    int16_t dig_P9;
+} bmp280_calib_t;
+
+/* --- Seqlock protected snapshot: odd sequence means an update is in progress. --- */
+typedef struct {
+    atomic_uint sequence;
+    atomic_uint_fast64_t temperature_bits;
+    atomic_uint_fast64_t pressure_bits;
+    atomic_uint_fast64_t timestamp_ns;
+    atomic_uint sample_count;
+} bmp_shared_t;
+
+static bmp280_calib_t g_calib;
+static bmp_shared_t g_snapshot;
+static pthread_t g_sample_thread;
+static uint32_t g_period_ms;
+static atomic_bool g_service_running = false;
+
+static uint64_t monotonicNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static uint16_t le16(const uint8_t *bytes)
+{
+    return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+static int readCalibration(void)
+{
+    uint8_t raw[BMP280_CALIB_BYTES];
+
+    if (smbus_read_block_data(I2C_BUS, BMP280_ADDR, BMP280_DIG_T1, raw, sizeof(raw)) != I2C_SUCCESS) {
+        return RH_FAILURE;
+    }
+
+    g_calib.dig_T1 = le16(&raw[0]);
+    g_calib.dig_T2 = (int16_t)le16(&raw[2]);
+    g_calib.dig_T3 = (int16_t)le16(&raw[4]);
+    g_calib.dig_P1 = le16(&raw[6]);
+    g_calib.dig_P2 = (int16_t)le16(&raw[8]);
+    g_calib.dig_P3 = (int16_t)le16(&raw[10]);
+    g_calib.dig_P4 = (int16_t)le16(&raw[12]);
+    g_calib.dig_P5 = (int16_t)le16(&raw[14]);
+    g_calib.dig_P6 = (int16_t)le16(&raw[16]);
+    g_calib.dig_P7 = (int16_t)le16(&raw[18]);
+    g_calib.dig_P8 = (int16_t)le16(&raw[20]);
+    g_calib.dig_P9 = (int16_t)le16(&raw[22]);
+    return RH_SUCCESS;
+}
+
+/**
+* @brief Burst-reads one measurement and compensates it (datasheet section 8.1,
+*        double precision version).
+*/
+static int readSample(double *temperature, double *pressure)
+{
+    uint8_t raw[BMP280_DATA_BYTES];
+    int32_t adc_P, adc_T;
+    double var1, var2, t_fine, p;
+
+    if (smbus_read_block_data(I2C_BUS, BMP280_ADDR, BMP280_PRESSDATA_MSB, raw, sizeof(raw)) != I2C_SUCCESS) {
+        return RH_FAILURE;
+    }
+
+    adc_P = ((int32_t)raw[0] << 12) | ((int32_t)raw[1] << 4) | (raw[2] >> 4);
+    adc_T = ((int32_t)raw[3] << 12) | ((int32_t)raw[4] << 4) | (raw[5] >> 4);
+
+    var1 = (((double)adc_T) / 16384.0 - ((double)g_calib.dig_T1) / 1024.0) * ((double)g_calib.dig_T2);
+    var2 = ((((double)adc_T) / 131072.0 - ((double)g_calib.dig_T1) / 8192.0) *
+            (((double)adc_T) / 131072.0 - ((double)g_calib.dig_T1) / 8192.0)) * ((double)g_calib.dig_T3);
+    t_fine = var1 + var2;
+    *temperature = t_fine / 5120.0;
+
+    var1 = (t_fine / 2.0) - 64000.0;
+    var2 = var1 * var1 * ((double)g_calib.dig_P6) / 32768.0;
+    var2 = var2 + var1 * ((double)g_calib.dig_P5) * 2.0;
+    var2 = (var2 / 4.0) + (((double)g_calib.dig_P4) * 65536.0);
+    var1 = (((double)g_calib.dig_P3) * var1 * var1 / 524288.0 + ((double)g_calib.dig_P2) * var1) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * ((double)g_calib.dig_P1);
+    if (var1 == 0.0) {
+        return RH_FAILURE; // avoid a division by zero on bad calibration data
+    }
+    p = 1048576.0 - (double)adc_P;
+    p = (p - (var2 / 4096.0)) * 6250.0 / var1;
+    var1 = ((double)g_calib.dig_P9) * p * p / 2147483648.0;
+    var2 = p * ((double)g_calib.dig_P8) / 32768.0;
+    p = p + (var1 + var2 + ((double)g_calib.dig_P7)) / 16.0;
+
+    *pressure = p / 100.0; // Pa to hPa
+    return RH_SUCCESS;
+}
+
+static uint64_t doubleBits(double value)
+{
+    uint64_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double bitsDouble(uint64_t bits)
+{
+    double value;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+* @brief Single writer side of the seqlock.
+*/
+static void publishSample(double temperature, double pressure, uint64_t timestamp_ns)
+{
+    unsigned seq = atomic_load_explicit(&g_snapshot.sequence, memory_order_relaxed);
+
+    atomic_store_explicit(&g_snapshot.sequence, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&g_snapshot.temperature_bits, doubleBits(temperature), memory_order_relaxed);
+    atomic_store_explicit(&g_snapshot.pressure_bits, doubleBits(pressure), memory_order_relaxed);
+    atomic_store_explicit(&g_snapshot.timestamp_ns, timestamp_ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&g_snapshot.sample_count, 1, memory_order_relaxed);
+
+    atomic_store_explicit(&g_snapshot.sequence, seq + 2, memory_order_release);
+}
+
+static int sampleOnce(void)
+{
+    double temperature, pressure;
+
+    if (readSample(&temperature, &pressure) != RH_SUCCESS) {
+        return RH_FAILURE;
+    }
+
+    publishSample(temperature, pressure, monotonicNs());
+    return RH_SUCCESS;
+}
+
+static void *sampleThread(void *arg)
+{
+    struct timespec next;
+
+    (void)arg;
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (atomic_load(&g_service_running)) {
+        // Absolute deadlines so the read time doesn't add to the period
+        next.tv_nsec += (long)(g_period_ms % 1000) * 1000000L;
+        next.tv_sec += (g_period_ms / 1000) + (next.tv_nsec / 1000000000L);
+        next.tv_nsec %= 1000000000L;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) {
+        }
+
+        if (!atomic_load(&g_service_running)) {
+            break;
+        }
+
+        // A failed read keeps the previous snapshot; its timestamp shows its age
+        sampleOnce();
+    }
+
+    return NULL;
+}
+
+int start_bmp_service(uint32_t period_ms)
+{
+    uint8_t chip_id;
+
+    if (atomic_load(&g_service_running)) {
+        return RH_SUCCESS;
+    }
+
+    if ((smbus_read_byte_data(I2C_BUS, BMP280_ADDR, BMP280_CHIPID, &chip_id) != I2C_SUCCESS) ||
+        (chip_id != BMP280_ID)) {
+        fprintf(stderr, "BMP280 not found on I2C bus %d\n", I2C_BUS);
+        return RH_FAILURE;
+    }
+
+    if (readCalibration() != RH_SUCCESS) {
+        fprintf(stderr, "Failed to read the BMP280 calibration\n");
+        return RH_FAILURE;
+    }
+
+    // The config register is only guaranteed to be written in sleep mode
+    if ((smbus_write_byte_data(I2C_BUS, BMP280_ADDR, BMP280_CONTROL, 0) != I2C_SUCCESS) ||
+        (smbus_write_byte_data(I2C_BUS, BMP280_ADDR, BMP280_CONFIG_REG, BMP280_CONFIG) != I2C_SUCCESS) ||
+        (smbus_write_byte_data(I2C_BUS, BMP280_ADDR, BMP280_CONTROL, BMP280_CTRL_MEAS) != I2C_SUCCESS)) {
+        fprintf(stderr, "Failed to configure the BMP280\n");
+        return RH_FAILURE;
+    }
+
+    // Wait out the first measurement (about 44ms at x16 oversampling) so readers have a value from the start
+    usleep(50000);
+    if (sampleOnce() != RH_SUCCESS) {
+        fprintf(stderr, "Failed to read the BMP280\n");
+        return RH_FAILURE;
+    }
+
+    g_period_ms = (period_ms != 0) ? period_ms : BMP_SAMPLE_PERIOD_MS;
+    atomic_store(&g_service_running, true);
+    if (pthread_create(&g_sample_thread, NULL, sampleThread, NULL) != 0) {
+        atomic_store(&g_service_running, false);
+        perror("pthread_create");
+        return RH_FAILURE;
+    }
+
+    return RH_SUCCESS;
+}
+
+int get_bmp_snapshot(bmp_snapshot_t *snapshot)
+{
+    unsigned seq_before, seq_after;
+
+    if (snapshot == NULL) {
+        return RH_FAILURE;
+    }
+
+    do {
+        seq_before = atomic_load_explicit(&g_snapshot.sequence, memory_order_acquire);
+
+        snapshot->temperature = bitsDouble(atomic_load_explicit(&g_snapshot.temperature_bits, memory_order_relaxed));
+        snapshot->pressure = bitsDouble(atomic_load_explicit(&g_snapshot.pressure_bits, memory_order_relaxed));
+        snapshot->timestamp_ns = atomic_load_explicit(&g_snapshot.timestamp_ns, memory_order_relaxed);
+        snapshot->sample_count = atomic_load_explicit(&g_snapshot.sample_count, memory_order_relaxed);
+
+        atomic_thread_fence(memory_order_acquire);
+        seq_after = atomic_load_explicit(&g_snapshot.sequence, memory_order_relaxed);
+    } while ((seq_before & 1) || (seq_before != seq_after));
+
+    return (snapshot->sample_count != 0) ? RH_SUCCESS : RH_FAILURE;
+}
+
+void stop_bmp_service(void)
+{
+    if (!atomic_exchange(&g_service_running, false)) {
+        return;
+    }
+
+    pthread_join(g_sample_thread, NULL);
+
+    // Back to sleep mode
+    smbus_write_byte_data(I2C_BUS, BMP280_ADDR, BMP280_CONTROL, 0);
+}
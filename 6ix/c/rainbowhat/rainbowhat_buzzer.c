@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+* @file rainbowhat_buzzer.c
+* @brief Queued, non-blocking note playback on the Rainbow HAT piezo buzzer.
+*
+* Callers append notes to a ring buffer and return immediately. One thread
+* owns the PWM pin: it starts each note and then sleeps on a condition
+* variable until that note's absolute end time, so note lengths don't drift
+* with scheduling latency and a flush wakes it up early.
+*/
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+
+#include "rainbowhat.h"
+#include "rpi_gpio.h"
+
+static pthread_mutex_t g_buzzer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_buzzer_cond;
+static pthread_t g_buzzer_thread;
+static buzzer_note_t g_queue[BUZZER_QUEUE_LEN];
+static unsigned int g_queue_head;   /* next note to play */
+static unsigned int g_queue_count;
+static unsigned int g_generation;  /* bumped by a flush to cut the current note short */
+static bool g_playing = false;
+static bool g_running = false;
+static bool g_stop = false;
+
+/**
+* @brief Starts or silences the tone. Called with the mutex released.
+*/
+static void buzzerTone(unsigned int freq)
+{
+    if (freq == 0) {
+        rpi_gpio_set_pwm_duty_cycle(BUZZER_PIN, 0);
+        return;
+    }
+
+    if ((rpi_gpio_setup_pwm(BUZZER_PIN, freq, GPIO_PWM_MODE_PWM) != GPIO_SUCCESS) ||
+        (rpi_gpio_set_pwm_duty_cycle(BUZZER_PIN, BUZZER_DUTY_CYCLE) != GPIO_SUCCESS)) {
+        fprintf(stderr, "Failed to drive the buzzer at %u Hz\n", freq);
+    }
+}
+
+static void addMillis(struct timespec *ts, uint32_t millis)
+{
+    ts->tv_nsec += (long)(millis % 1000) * 1000000L;
+    ts->tv_sec += (millis / 1000) + (ts->tv_nsec / 1000000000L);
+    ts->tv_nsec %= 1000000000L;
+}
+
+static void *sequencerThread(void *arg)
+{
+    struct timespec note_end;
+
+    (void)arg;
+
+    pthread_mutex_lock(&g_buzzer_mutex);
+    while (!g_stop) {
+        buzzer_note_t note;
+        unsigned int generation;
+
+        if (g_queue_count == 0) {
+            // Queue ran dry: silence and sleep until more notes arrive
+            if (g_playing) {
+                g_playing = false;
+                pthread_mutex_unlock(&g_buzzer_mutex);
+                buzzerTone(0);
+                pthread_mutex_lock(&g_buzzer_mutex);
+                continue;
+            }
+            pthread_cond_wait(&g_buzzer_cond, &g_buzzer_mutex);
+            continue;
+        }
+
+        note = g_queue[g_queue_head];
+        g_queue_head = (g_queue_head + 1) % BUZZER_QUEUE_LEN;
+        g_queue_count--;
+        generation = g_generation;
+
+        // Back to back notes are timed from the previous end, not from now
+        if (!g_playing) {
+            clock_gettime(CLOCK_MONOTONIC, &note_end);
+        }
+        g_playing = true;
+        addMillis(&note_end, note.millis);
+
+        pthread_mutex_unlock(&g_buzzer_mutex);
+        buzzerTone(note.freq);
+        pthread_mutex_lock(&g_buzzer_mutex);
+
+        while (!g_stop && (generation == g_generation)) {
+            if (pthread_cond_timedwait(&g_buzzer_cond, &g_buzzer_mutex, &note_end) == ETIMEDOUT) {
+                break;
+            }
+        }
+
+        // A flush ends the current note now
+        if (generation != g_generation) {
+            g_playing = false;
+            pthread_mutex_unlock(&g_buzzer_mutex);
+            buzzerTone(0);
+            pthread_mutex_lock(&g_buzzer_mutex);
+        }
+    }
+    pthread_mutex_unlock(&g_buzzer_mutex);
+
+    buzzerTone(0);
+    return NULL;
+}
+
+int init_buzzer_sequencer(void)
+{
+    pthread_condattr_t attr;
+
+    pthread_mutex_lock(&g_buzzer_mutex);
+    if (g_running) {
+        pthread_mutex_unlock(&g_buzzer_mutex);
+        return RH_SUCCESS;
+    }
+
+    // Note end times are CLOCK_MONOTONIC deadlines
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_buzzer_cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    g_queue_head = 0;
+    g_queue_count = 0;
+    g_playing = false;
+    g_stop = false;
+
+    if (pthread_create(&g_buzzer_thread, NULL, sequencerThread, NULL) != 0) {
+        pthread_cond_destroy(&g_buzzer_cond);
+        pthread_mutex_unlock(&g_buzzer_mutex);
+        perror("pthread_create");
+        return RH_FAILURE;
+    }
+
+    g_running = true;
+    pthread_mutex_unlock(&g_buzzer_mutex);
+    return RH_SUCCESS;
+}
+
+int queue_buzzer_notes(const buzzer_note_t *notes, unsigned int count)
+{
+    unsigned int i;
+
+    if ((notes == NULL) && (count != 0)) {
+        return RH_FAILURE;
+    }
+
+    pthread_mutex_lock(&g_buzzer_mutex);
+    if (!g_running || (count > (BUZZER_QUEUE_LEN - g_queue_count))) {
+        pthread_mutex_unlock(&g_buzzer_mutex);
+        return RH_FAILURE;
+    }
+
+    for (i = 0; i < count; i++) {
+        g_queue[(g_queue_head + g_queue_count) % BUZZER_QUEUE_LEN] = notes[i];
+        g_queue_count++;
+    }
+
+    pthread_cond_signal(&g_buzzer_cond);
+    pthread_mutex_unlock(&g_buzzer_mutex);
+    return RH_SUCCESS;
+}
+
+void flush_buzzer_notes(void)
+{
+    pthread_mutex_lock(&g_buzzer_mutex);
+    g_queue_count = 0;
+    g_generation++;
+    if (g_running) {
+        pthread_cond_signal(&g_buzzer_cond);
+    }
+    pthread_mutex_unlock(&g_buzzer_mutex);
+}
+
+bool buzzer_busy(void)
+{
+    bool busy;
+
+    pthread_mutex_lock(&g_buzzer_mutex);
+    busy = g_playing || (g_queue_count != 0);
+    pthread_mutex_unlock(&g_buzzer_mutex);
+    return busy;
+}
+
+void cleanup_buzzer_sequencer(void)
+{
+    pthread_mutex_lock(&g_buzzer_mutex);
+    if (!g_running) {
+        pthread_mutex_unlock(&g_buzzer_mutex);
+        return;
+    }
+    g_stop = true;
+    g_queue_count = 0;
+    pthread_cond_signal(&g_buzzer_cond);
+    pthread_mutex_unlock(&g_buzzer_mutex);
+
+    pthread_join(g_buzzer_thread, NULL);
+
+    pthread_mutex_lock(&g_buzzer_mutex);
+    g_running = false;
+    g_playing = false;
+    pthread_cond_destroy(&g_buzzer_cond);
+    pthread_mutex_unlock(&g_buzzer_mutex);
+}
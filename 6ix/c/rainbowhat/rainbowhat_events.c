@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+* @file rainbowhat_events.c
+* @brief Edge-triggered button events for the Rainbow HAT.
+*
+* The GPIO resource manager delivers a pulse on every edge of a registered
+* pin. The first edge of a press or release is reported straight away and
+* later edges inside the debounce window are treated as contact bounce.
+* If a bounce was ignored, the pin is read again once the window closes so
+* a state change hidden by the bounce is still reported.
+*/
+
+#include <errno.h>
+#include <string.h>
+#include <sys/neutrino.h>
+
+#include "rainbowhat.h"
+#include "rpi_gpio.h"
+
+/* --- Per-pin debounce state, indexed by GPIO number. --- */
+typedef struct {
+    bool enabled;
+    bool pressed;               /* last reported state */
+    bool recheck;               /* an edge was ignored inside the debounce window */
+    uint64_t last_change_ns;
+} button_state_t;
+
+static int g_event_chid = -1;
+static int g_event_coid = -1;
+static uint64_t g_debounce_ns;
+static button_state_t g_button_state[GPIO_COUNT];
+
+static uint64_t monotonicNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+* @brief Records a state change and fills in the event for it.
+*/
+static bool reportChange(int pin, bool pressed, uint64_t now, button_event_t *event)
+{
+    button_state_t *state = &g_button_state[pin];
+
+    if (pressed == state->pressed) {
+        return false;
+    }
+
+    state->pressed = pressed;
+    state->last_change_ns = now;
+    event->button = (enum Buttons)pin;
+    event->pressed = pressed;
+    event->timestamp_ns = now;
+    return true;
+}
+
+int init_button_events(unsigned int debounce_ms)
+{
+    if (g_event_chid != -1) {
+        return RH_SUCCESS;
+    }
+
+    memset(g_button_state, 0, sizeof(g_button_state));
+    g_debounce_ns = (uint64_t)debounce_ms * 1000000ULL;
+
+    // Private channel: only GPIO pulses arrive here
+    g_event_chid = ChannelCreate(_NTO_CHF_PRIVATE);
+    if (g_event_chid == -1) {
+        perror("ChannelCreate");
+        return RH_FAILURE;
+    }
+
+    g_event_coid = ConnectAttach(0, 0, g_event_chid, _NTO_SIDE_CHANNEL, 0);
+    if (g_event_coid == -1) {
+        perror("ConnectAttach");
+        ChannelDestroy(g_event_chid);
+        g_event_chid = -1;
+        return RH_FAILURE;
+    }
+
+    return RH_SUCCESS;
+}
+
+int enable_button_event(enum Buttons button)
+{
+    int pin = (int)button;
+
+    if ((g_event_coid == -1) || (pin < 0) || (pin >= GPIO_COUNT)) {
+        return RH_FAILURE;
+    }
+
+    // Start from the current level so the first edge is compared correctly
+    g_button_state[pin].pressed = read_button(button);
+    g_button_state[pin].last_change_ns = 0;
+    g_button_state[pin].recheck = false;
+
+    // The pin number doubles as the pulse value
+    if (rpi_gpio_add_event_detect(pin, g_event_coid, GPIO_RISING | GPIO_FALLING, (unsigned)pin) != GPIO_SUCCESS) {
+        return RH_FAILURE;
+    }
+
+    g_button_state[pin].enabled = true;
+    return RH_SUCCESS;
+}
+
+int wait_button_event(button_event_t *event, uint32_t timeout_ms)
+{
+    struct _pulse pulse;
+    uint64_t now = monotonicNs();
+    uint64_t deadline = (timeout_ms != 0) ? now + ((uint64_t)timeout_ms * 1000000ULL) : 0;
+
+    if ((event == NULL) || (g_event_chid == -1)) {
+        return RH_FAILURE;
+    }
+
+    while (1) {
+        uint64_t wake = deadline;
+        int pin;
+
+        now = monotonicNs();
+
+        // Settle pins whose bounce was ignored once their window has closed
+        for (pin = 0; pin < GPIO_COUNT; pin++) {
+            button_state_t *state = &g_button_state[pin];
+            uint64_t window_end;
+
+            if (!state->enabled || !state->recheck) {
+                continue;
+            }
+
+            window_end = state->last_change_ns + g_debounce_ns;
+            if (now >= window_end) {
+                state->recheck = false;
+                if (reportChange(pin, read_button((enum Buttons)pin), now, event)) {
+                    return RH_SUCCESS;
+                }
+            } else if ((wake == 0) || (window_end < wake)) {
+                wake = window_end;
+            }
+        }
+
+        if ((deadline != 0) && (now >= deadline)) {
+            return RH_TIMEOUT;
+        }
+
+        if (wake != 0) {
+            uint64_t timeout_ns = (wake > now) ? wake - now : 0;
+            TimerTimeout(CLOCK_MONOTONIC, _NTO_TIMEOUT_RECEIVE, NULL, &timeout_ns, NULL);
+        }
+
+        if (MsgReceivePulse(g_event_chid, &pulse, sizeof(pulse), NULL) == -1) {
+            if ((errno == ETIMEDOUT) || (errno == EINTR)) {
+                continue;
+            }
+            perror("MsgReceivePulse");
+            return RH_FAILURE;
+        }
+
+        if (pulse.code != _PULSE_CODE_MINAVAIL) {
+            continue;
+        }
+
+        pin = pulse.value.sival_int;
+        if ((pin < 0) || (pin >= GPIO_COUNT) || !g_button_state[pin].enabled) {
+            continue;
+        }
+
+        now = monotonicNs();
+        if ((now - g_button_state[pin].last_change_ns) < g_debounce_ns) {
+            g_button_state[pin].recheck = true;
+            continue;
+        }
+
+        if (reportChange(pin, read_button((enum Buttons)pin), now, event)) {
+            return RH_SUCCESS;
+        }
+    }
+}
+
+void cleanup_button_events(void)
+{
+    if (g_event_coid != -1) {
+        ConnectDetach(g_event_coid);
+        g_event_coid = -1;
+    }
+
+    if (g_event_chid != -1) {
+        ChannelDestroy(g_event_chid);
+        g_event_chid = -1;
+    }
+
+    memset(g_button_state, 0, sizeof(g_button_state));
+}
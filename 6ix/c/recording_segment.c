@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+* @file recording_segment.c
+* @brief Segment file creation, mapping and append.
+*
+* The whole file is reserved when the segment is created so appends never
+* extend it: a full disk is reported before recording starts, not in the
+* middle of a session. segment_reset() reuses that space for the next
+* recording, so the file is only created once. Appends are plain copies into the shared mapping;
+* the kernel writes them back on its own schedule and a state change
+* forces the header out with msync().
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "recording_segment.h"
+
+/* Frame data starts on a page boundary after the index */
+#define SEGMENT_DATA_ALIGN 4096
+
+static void segmentReset(segment_t *segment)
+{
+    memset(segment, 0, sizeof(*segment));
+    segment->fd = -1;
+    segment->map = MAP_FAILED;
+}
+
+static int segmentMap(segment_t *segment, int prot)
+{
+    segment->map = mmap(NULL, segment->map_size, prot, MAP_SHARED, segment->fd, 0);
+    if (segment->map == MAP_FAILED) {
+        perror("mmap");
+        return SEGMENT_FAILURE;
+    }
+
+    segment->header = (segment_header_t *)segment->map;
+    segment->index = (segment_entry_t *)(segment->map + sizeof(segment_header_t));
+    return SEGMENT_SUCCESS;
+}
+
+int segment_create(segment_t *segment, const char *path, uint64_t data_capacity, uint32_t max_frames,
+                   uint32_t session_id)
+{
+    uint64_t data_offset;
+    int err;
+
+    segmentReset(segment);
+    if ((max_frames == 0) || (data_capacity == 0)) {
+        return SEGMENT_FAILURE;
+    }
+
+    data_offset = sizeof(segment_header_t) + ((uint64_t)max_frames * sizeof(segment_entry_t));
+    data_offset = (data_offset + SEGMENT_DATA_ALIGN - 1) & ~((uint64_t)SEGMENT_DATA_ALIGN - 1);
+    segment->map_size = (size_t)(data_offset + data_capacity);
+
+    segment->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (segment->fd == -1) {
+        perror("open");
+        return SEGMENT_FAILURE;
+    }
+
+    // Reserve the blocks now; fall back to a sparse file where the
+    // filesystem can't preallocate
+    err = posix_fallocate(segment->fd, 0, (off_t)segment->map_size);
+    if (err != 0) {
+        if ((err != EINVAL) && (err != EOPNOTSUPP) && (err != ENOSYS)) {
+            fprintf(stderr, "Failed to reserve %zu bytes for %s: %s\n", segment->map_size, path, strerror(err));
+            segment_close(segment);
+            return SEGMENT_FAILURE;
+        }
+        if (ftruncate(segment->fd, (off_t)segment->map_size) != 0) {
+            perror("ftruncate");
+            segment_close(segment);
+            return SEGMENT_FAILURE;
+        }
+    }
+
+    if (segmentMap(segment, PROT_READ | PROT_WRITE) != SEGMENT_SUCCESS) {
+        segment_close(segment);
+        return SEGMENT_FAILURE;
+    }
+
+    segment->data = segment->map + data_offset;
+    memset(segment->header, 0, sizeof(*segment->header));
+    segment->header->magic = SEGMENT_MAGIC;
+    segment->header->version = SEGMENT_VERSION;
+    segment->header->max_frames = max_frames;
+    segment->header->session_id = session_id;
+    segment->header->data_offset = data_offset;
+    segment->header->data_capacity = data_capacity;
+    segment->header->state = SEGMENT_STATE_RECORDING;
+    return SEGMENT_SUCCESS;
+}
+
+int segment_reset(segment_t *segment, uint32_t session_id)
+{
+    segment_header_t *header = segment->header;
+
+    if (header == NULL) {
+        return SEGMENT_FAILURE;
+    }
+
+    // Forget the old frames first, the index and data are simply overwritten
+    header->frame_count = 0;
+    header->data_used = 0;
+    header->session_id = session_id;
+    header->temperature_centi = 0;
+    header->pressure_centi = 0;
+    header->button_press_time_us = 0;
+    header->button_release_time_us = 0;
+    header->state = SEGMENT_STATE_RECORDING;
+
+    // Schedule the header for writeback without waiting on the disk
+    msync(segment->map, SEGMENT_DATA_ALIGN, MS_ASYNC);
+    return SEGMENT_SUCCESS;
+}
+
+int segment_open(segment_t *segment, const char *path)
+{
+    struct stat st;
+    segment_header_t header;
+    uint64_t index_end;
+
+    segmentReset(segment);
+
+    segment->fd = open(path, O_RDWR);
+    if (segment->fd == -1) {
+        return SEGMENT_FAILURE;
+    }
+
+    // Validate the header before trusting any of its sizes
+    if ((fstat(segment->fd, &st) != 0) ||
+        (pread(segment->fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) ||
+        (header.magic != SEGMENT_MAGIC) || (header.version != SEGMENT_VERSION)) {
+        segment_close(segment);
+        return SEGMENT_FAILURE;
+    }
+
+    index_end = sizeof(segment_header_t) + ((uint64_t)header.max_frames * sizeof(segment_entry_t));
+    if ((header.data_offset < index_end) ||
+        ((header.data_offset + header.data_capacity) > (uint64_t)st.st_size) ||
+        (header.frame_count > header.max_frames) || (header.data_used > header.data_capacity)) {
+        fprintf(stderr, "Segment %s is damaged\n", path);
+        segment_close(segment);
+        return SEGMENT_FAILURE;
+    }
+
+    segment->map_size = (size_t)(header.data_offset + header.data_capacity);
+    if (segmentMap(segment, PROT_READ | PROT_WRITE) != SEGMENT_SUCCESS) {
+        segment_close(segment);
+        return SEGMENT_FAILURE;
+    }
+    segment->data = segment->map + header.data_offset;
+
+    // Frames appended after the last commit are simply not part of it
+    return SEGMENT_SUCCESS;
+}
+
+int segment_append(segment_t *segment, const segment_entry_t *entry, const uint8_t *data)
+{
+    segment_header_t *header = segment->header;
+    segment_entry_t *slot;
+
+    if ((header == NULL) || (header->state != SEGMENT_STATE_RECORDING)) {
+        return SEGMENT_FAILURE;
+    }
+
+    if ((header->frame_count >= header->max_frames) ||
+        (entry->size > (header->data_capacity - header->data_used))) {
+        return SEGMENT_FULL;
+    }
+
+    memcpy(segment->data + header->data_used, data, entry->size);
+    slot = &segment->index[header->frame_count];
+    *slot = *entry;
+    slot->offset = header->data_used;
+
+    // The frame only counts once its data and entry are in place
+    atomic_thread_fence(memory_order_release);
+    header->data_used += entry->size;
+    header->frame_count++;
+    return SEGMENT_SUCCESS;
+}
+
+const segment_entry_t *segment_frame(const segment_t *segment, uint32_t frame, const uint8_t **data)
+{
+    const segment_entry_t *entry;
+
+    if ((segment->header == NULL) || (frame >= segment->header->frame_count)) {
+        return NULL;
+    }
+
+    entry = &segment->index[frame];
+    if ((entry->offset + entry->size) > segment->header->data_used) {
+        return NULL;
+    }
+
+    *data = segment->data + entry->offset;
+    return entry;
+}
+
+void segment_set_state(segment_t *segment, uint32_t state)
+{
+    if (segment->header == NULL) {
+        return;
+    }
+
+    // Frames and index first, so a complete state never refers to unwritten data
+    msync(segment->map, segment->map_size, MS_SYNC);
+    segment->header->state = state;
+    msync(segment->map, SEGMENT_DATA_ALIGN, MS_SYNC);
+}
+
+void segment_close(segment_t *segment)
+{
+    if (segment->map != MAP_FAILED) {
+        munmap(segment->map, segment->map_size);
+    }
+    if (segment->fd != -1) {
+        close(segment->fd);
+    }
+    segmentReset(segment);
+}
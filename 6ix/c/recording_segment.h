@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+* @file recording_segment.h
+* @brief Recordings spilled to a preallocated, memory-mapped segment file.
+*
+* The file holds a header, a fixed index of frame entries and one data
+* region that frames are appended to:
+*
+*   segment_header_t | segment_entry_t[max_frames] | frame data ...
+*
+* A frame becomes part of the recording when frame_count is advanced after
+* its data and index entry are written, so a segment left behind by a crash
+* still holds every committed frame. Uploads read straight from the mapping.
+* A segment has a single writer and is not shared between processes.
+*/
+
+#ifndef RECORDING_SEGMENT_H
+#define RECORDING_SEGMENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Return Codes */
+#define SEGMENT_SUCCESS 0
+#define SEGMENT_FAILURE -1
+#define SEGMENT_FULL -2
+
+#define SEGMENT_MAGIC           0x36495852  /* "6IXR" */
+#define SEGMENT_VERSION         1
+
+/* Segment states */
+#define SEGMENT_STATE_RECORDING 0   /* frames may still be appended */
+#define SEGMENT_STATE_COMPLETE  1   /* end of stream seen, upload pending */
+#define SEGMENT_STATE_UPLOADED  2   /* the server has the whole recording */
+
+/* --- Start of the file. Sensor fields mirror stream_session_header_t. --- */
+typedef struct {
+    uint32_t magic;                 /* SEGMENT_MAGIC */
+    uint32_t version;               /* SEGMENT_VERSION */
+    uint32_t max_frames;            /* entries in the index */
+    uint32_t session_id;
+    uint64_t data_offset;           /* file offset of the data region */
+    uint64_t data_capacity;         /* bytes in the data region */
+    uint64_t data_used;
+    uint32_t frame_count;           /* committed frames */
+    uint32_t state;                 /* SEGMENT_STATE_* */
+    int32_t temperature_centi;
+    uint32_t pressure_centi;
+    uint64_t button_press_time_us;
+    uint64_t button_release_time_us;
+} segment_header_t;
+
+/* --- One index entry, fields as in stream_frame_header_t. --- */
+typedef struct {
+    uint64_t offset;                /* from the start of the data region */
+    uint64_t timestamp_us;
+    uint32_t size;
+    uint32_t frametype;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    uint32_t reserved;
+} segment_entry_t;
+
+/* --- An open, mapped segment. --- */
+typedef struct {
+    int fd;
+    uint8_t *map;
+    size_t map_size;
+    segment_header_t *header;
+    segment_entry_t *index;
+    uint8_t *data;
+} segment_t;
+
+/**
+* @brief Creates (or replaces) a segment file, reserves its full size on
+*        disk and maps it.
+*
+* @param segment receives the open segment
+* @param path segment file on local storage
+* @param data_capacity bytes reserved for frame data
+* @param max_frames entries reserved in the index
+* @param session_id stored in the header for resumed uploads
+* @return int SEGMENT_SUCCESS on success, SEGMENT_FAILURE if the file can't be
+*         created, sized or mapped.
+*/
+int segment_create(segment_t *segment, const char *path, uint64_t data_capacity, uint32_t max_frames,
+                   uint32_t session_id);
+
+/**
+* @brief Starts a new recording in an open segment, reusing the space it
+*        already reserved. The previous recording is discarded.
+*
+* @param segment open segment
+* @param session_id stored in the header for resumed uploads
+* @return int SEGMENT_SUCCESS on success, SEGMENT_FAILURE if the segment isn't open.
+*/
+int segment_reset(segment_t *segment, uint32_t session_id);
+
+/**
+* @brief Maps an existing segment file, e.g. one left behind by a crash.
+*
+* @param segment receives the open segment
+* @param path segment file
+* @return int SEGMENT_SUCCESS on success, SEGMENT_FAILURE if the file is missing
+*         or isn't a valid segment.
+*/
+int segment_open(segment_t *segment, const char *path);
+
+/**
+* @brief Copies a frame to the end of the data region and commits it.
+*
+* @param segment open segment in SEGMENT_STATE_RECORDING
+* @param entry frame description; offset is filled in
+* @param data frame payload, entry->size bytes
+* @return int SEGMENT_SUCCESS on success, SEGMENT_FULL if the index or data
+*         region has no room, SEGMENT_FAILURE if the segment isn't recording.
+*/
+int segment_append(segment_t *segment, const segment_entry_t *entry, const uint8_t *data);
+
+/**
+* @brief Looks up a committed frame.
+*
+* @param segment open segment
+* @param frame frame number, below header->frame_count
+* @param data receives a pointer into the mapping
+* @return const segment_entry_t* the index entry, NULL if out of range.
+*/
+const segment_entry_t *segment_frame(const segment_t *segment, uint32_t frame, const uint8_t **data);
+
+/**
+* @brief Records a state change and flushes the header to disk.
+*
+* @param segment open segment
+* @param state SEGMENT_STATE_*
+*/
+void segment_set_state(segment_t *segment, uint32_t state);
+
+/**
+* @brief Unmaps and closes the segment. The file stays on disk.
+*
+* @param segment open segment
+*/
+void segment_close(segment_t *segment);
+
+#endif /* RECORDING_SEGMENT_H */
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+* @file stream_protocol.h
+* @brief Wire format between camera_client and processing_server.py.
+*
+* All fields are big-endian (network byte order) and all structures are
+* packed. One TCP connection carries one recording session:
+*
+*   client -> server   stream_session_header_t
+*   client -> server   stream_frame_header_t (STREAM_MSG_FRAME) + payload, repeated
+*   client -> server   stream_frame_header_t (STREAM_MSG_END_OF_STREAM), no payload
+*   server -> client   stream_result_header_t + result payload
+*
+* A session with a nonzero session_id can be resumed after the connection
+* drops. The client reconnects with STREAM_FLAG_RESUME set and the server
+* answers with a STREAM_MSG_RESUME result header (no payload) whose
+* frames_received says which frame to continue from:
+*
+*   client -> server   stream_session_header_t (STREAM_FLAG_RESUME)
+*   server -> client   stream_result_header_t (STREAM_MSG_RESUME)
+*   client -> server   frames from frames_received on, then end of stream
+*
+* processing_server.py mirrors these layouts as struct format strings; keep
+* both sides in sync and bump STREAM_PROTOCOL_VERSION on any change.
+*/
+
+#ifndef STREAM_PROTOCOL_H
+#define STREAM_PROTOCOL_H
+
+#include <stdint.h>
+
+/* --- Protocol constants. --- */
+#define STREAM_PROTOCOL_MAGIC           0x36495853  /* "6IXS" */
+#define STREAM_PROTOCOL_VERSION         4
+#define STREAM_PROTOCOL_DEFAULT_PORT    8080
+
+/* Message types carried in the frame and result headers */
+#define STREAM_MSG_FRAME                1
+#define STREAM_MSG_END_OF_STREAM        2
+#define STREAM_MSG_RESULT               3
+#define STREAM_MSG_RESUME               4   /* server -> client, reply to a resumed session */
+
+/* Session header flags */
+#define STREAM_FLAG_RESUME              0x1 /* continue the interrupted session_id */
+
+/* Frame types on the wire, independent of the camera API enum values */
+#define STREAM_FRAMETYPE_YCBYCR         0
+#define STREAM_FRAMETYPE_CBYCRY         1
+#define STREAM_FRAMETYPE_RGB8888        2
+#define STREAM_FRAMETYPE_BGR8888        3
+#define STREAM_FRAMETYPE_GRAY8          4   /* luma only, see frame_preprocess.h */
+#define STREAM_FRAMETYPE_JPEG           5   /* one JPEG image per frame, stride 0 */
+#define STREAM_FRAMETYPE_H264           6   /* Annex B bitstream chunk, stride 0 */
+
+/* Result status codes */
+#define STREAM_RESULT_OK                0
+#define STREAM_RESULT_ERROR             1
+
+/* Longest result payload a client has to accept */
+#define STREAM_RESULT_MAX_PAYLOAD       64
+
+/**
+* @brief Sent once when the connection opens. Sensor readings are fixed point
+* in hundredths so no floating point layout crosses the wire.
+*
+* struct format: "!IHHIiIIQ" (32 bytes)
+*/
+typedef struct __attribute__((packed)) {
+    uint32_t magic;                 /* STREAM_PROTOCOL_MAGIC */
+    uint16_t version;               /* STREAM_PROTOCOL_VERSION */
+    uint16_t header_size;           /* sizeof(stream_session_header_t) */
+    uint32_t flags;                 /* STREAM_FLAG_* */
+    int32_t temperature_centi;      /* degrees C * 100 */
+    uint32_t pressure_centi;        /* BMP280 pressure * 100 */
+    uint32_t session_id;            /* nonzero if the session can be resumed */
+    uint64_t button_press_time_us;  /* wall clock, microseconds */
+} stream_session_header_t;
+
+/**
+* @brief Precedes every frame payload. The end-of-stream marker uses the same
+* header with a zero payload size and the button release time as timestamp.
+*
+* struct format: "!IIIIIIQ" (32 bytes)
+*/
+typedef struct __attribute__((packed)) {
+    uint32_t msg_type;              /* STREAM_MSG_FRAME or STREAM_MSG_END_OF_STREAM */
+    uint32_t frametype;             /* STREAM_FRAMETYPE_* */
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;                /* bytes per row */
+    uint32_t payload_size;          /* bytes following the header */
+    uint64_t timestamp_us;          /* wall clock, microseconds */
+} stream_frame_header_t;
+
+/**
+* @brief Server reply once the end-of-stream marker has been processed,
+* followed by payload_size bytes of display text.
+*
+* struct format: "!IIII" (16 bytes)
+*/
+typedef struct __attribute__((packed)) {
+    uint32_t msg_type;              /* STREAM_MSG_RESULT or STREAM_MSG_RESUME */
+    uint32_t status;                /* STREAM_RESULT_*, ERROR for an unknown session_id */
+    uint32_t frames_received;
+    uint32_t payload_size;          /* at most STREAM_RESULT_MAX_PAYLOAD */
+} stream_result_header_t;
+
+#endif /* STREAM_PROTOCOL_H */
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+* @file trace.c
+* @brief Per-thread span rings and the Chrome trace writer.
+*
+* A thread claims a ring on its first span. Only that thread writes the
+* ring; it fills the entry and then publishes it by advancing head with
+* release ordering. The dump reads head, copies the entries and reads head
+* again: anything the writer may have reached in between is skipped.
+*/
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+/* --- One completed span. --- */
+typedef struct {
+    const char *name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    uint32_t arg;
+} trace_event_t;
+
+/* --- Ring owned by a single recording thread. --- */
+typedef struct {
+    trace_event_t events[TRACE_RING_SIZE];
+    atomic_uint_fast64_t head;  /* spans ever recorded */
+    _Atomic(const char *) thread_name;
+    unsigned long tid;
+} trace_ring_t;
+
+static atomic_bool g_trace_enabled = false;
+static atomic_uint g_ring_count = 0;
+static trace_ring_t g_rings[TRACE_MAX_THREADS];
+static __thread trace_ring_t *t_ring = NULL;
+static __thread bool t_ring_full = false;
+static pthread_mutex_t g_dump_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static trace_ring_t *threadRing(void)
+{
+    unsigned int index;
+
+    if ((t_ring != NULL) || t_ring_full) {
+        return t_ring;
+    }
+
+    index = atomic_fetch_add_explicit(&g_ring_count, 1, memory_order_relaxed);
+    if (index >= TRACE_MAX_THREADS) {
+        t_ring_full = true;
+        return NULL;
+    }
+
+    t_ring = &g_rings[index];
+    t_ring->tid = (unsigned long)pthread_self();
+    return t_ring;
+}
+
+/**
+* @brief Rings claimed so far; ring_count keeps counting threads that found no ring.
+*/
+static unsigned int ringCount(void)
+{
+    unsigned int count = atomic_load_explicit(&g_ring_count, memory_order_acquire);
+
+    return (count > TRACE_MAX_THREADS) ? TRACE_MAX_THREADS : count;
+}
+
+void trace_enable(void)
+{
+    atomic_store(&g_trace_enabled, true);
+}
+
+bool trace_enabled(void)
+{
+    return atomic_load_explicit(&g_trace_enabled, memory_order_relaxed);
+}
+
+uint64_t trace_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+void trace_thread_name(const char *name)
+{
+    trace_ring_t *ring;
+
+    if (!trace_enabled()) {
+        return;
+    }
+
+    ring = threadRing();
+    if (ring != NULL) {
+        atomic_store_explicit(&ring->thread_name, name, memory_order_release);
+    }
+}
+
+void trace_span(const char *name, uint64_t start_ns, uint64_t end_ns, uint32_t arg)
+{
+    trace_ring_t *ring;
+    trace_event_t *event;
+    uint_fast64_t head;
+
+    if (!trace_enabled()) {
+        return;
+    }
+
+    ring = threadRing();
+    if (ring == NULL) {
+        return;
+    }
+
+    // Only this thread advances head, so a relaxed load is enough here
+    head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    event = &ring->events[head & (TRACE_RING_SIZE - 1)];
+    event->name = name;
+    event->start_ns = start_ns;
+    event->end_ns = (end_ns > start_ns) ? end_ns : start_ns;
+    event->arg = arg;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+/**
+* @brief Writes one ring's spans, returns the number written.
+*/
+static unsigned int dumpRing(FILE *file, trace_ring_t *ring, int pid, bool first)
+{
+    static trace_event_t events[TRACE_RING_SIZE];  /* dumps are serialized */
+    uint_fast64_t head;
+    uint_fast64_t oldest;
+    uint_fast64_t valid;
+    uint_fast64_t i;
+    unsigned int written = 0;
+    const char *thread_name;
+
+    head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    oldest = (head > TRACE_RING_SIZE) ? head - TRACE_RING_SIZE : 0;
+    for (i = oldest; i < head; i++) {
+        events[i & (TRACE_RING_SIZE - 1)] = ring->events[i & (TRACE_RING_SIZE - 1)];
+    }
+
+    // Spans the writer overwrote while copying may be torn, including the
+    // slot it may be filling right now
+    valid = atomic_load_explicit(&ring->head, memory_order_acquire);
+    valid = (valid >= TRACE_RING_SIZE) ? valid - TRACE_RING_SIZE + 1 : 0;
+    if (oldest < valid) {
+        oldest = valid;
+    }
+
+    thread_name = atomic_load_explicit(&ring->thread_name, memory_order_acquire);
+    if (thread_name != NULL) {
+        fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",", pid, ring->tid, thread_name);
+        first = false;
+        written++;
+    }
+
+    for (i = oldest; i < head; i++) {
+        const trace_event_t *event = &events[i & (TRACE_RING_SIZE - 1)];
+
+        fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"arg\":%u}}",
+                first ? "" : ",", event->name, pid, ring->tid,
+                event->start_ns / 1000.0, (event->end_ns - event->start_ns) / 1000.0, event->arg);
+        first = false;
+        written++;
+    }
+
+    return written;
+}
+
+int trace_dump_chrome(const char *path)
+{
+    FILE *file;
+    unsigned int count;
+    unsigned int written = 0;
+    unsigned int i;
+    int pid = (int)getpid();
+    int err = TRACE_SUCCESS;
+
+    pthread_mutex_lock(&g_dump_mutex);
+
+    file = fopen(path, "w");
+    if (file == NULL) {
+        pthread_mutex_unlock(&g_dump_mutex);
+        perror("fopen");
+        return TRACE_FAILURE;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    count = ringCount();
+    for (i = 0; i < count; i++) {
+        written += dumpRing(file, &g_rings[i], pid, written == 0);
+    }
+    fprintf(file, "\n]}\n");
+
+    if (ferror(file)) {
+        err = TRACE_FAILURE;
+    }
+    if (fclose(file) != 0) {
+        err = TRACE_FAILURE;
+    }
+
+    pthread_mutex_unlock(&g_dump_mutex);
+    return err;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+* @file trace.h
+* @brief Lightweight latency spans with a Chrome trace export.
+*
+* Each thread records completed spans into its own fixed-size ring, so
+* recording costs two clock reads and a store with no locks or allocation.
+* trace_dump_chrome() writes the most recent spans of every thread as a
+* Chrome trace (chrome://tracing, Perfetto). Span names must be string
+* literals; only the pointer is stored.
+*
+* Timestamps come from CLOCK_MONOTONIC, so spans from different threads of
+* one process line up. processing_server.py writes the same format.
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Return Codes */
+#define TRACE_SUCCESS 0
+#define TRACE_FAILURE -1
+
+/* Spans kept per thread, must be a power of two */
+#define TRACE_RING_SIZE 4096
+/* Threads that can record; spans from further threads are dropped */
+#define TRACE_MAX_THREADS 16
+
+/**
+* @brief Turns recording on. Until this is called trace_span() returns
+*        straight away.
+*/
+void trace_enable(void);
+
+/**
+* @brief Checks whether spans are being recorded.
+*
+* @return true once trace_enable() has been called.
+*/
+bool trace_enabled(void);
+
+/**
+* @brief Reads the clock used for span timestamps.
+*
+* @return uint64_t CLOCK_MONOTONIC time in nanoseconds.
+*/
+uint64_t trace_now_ns(void);
+
+/**
+* @brief Names the calling thread in the exported trace.
+*
+* @param name string literal shown for the thread
+*/
+void trace_thread_name(const char *name);
+
+/**
+* @brief Records a completed span on the calling thread's ring. The oldest
+*        span is overwritten once the ring is full.
+*
+* @param name string literal naming the stage
+* @param start_ns span start from trace_now_ns()
+* @param end_ns span end from trace_now_ns()
+* @param arg value shown with the span, e.g. the frame number
+*/
+void trace_span(const char *name, uint64_t start_ns, uint64_t end_ns, uint32_t arg);
+
+/**
+* @brief Writes the spans currently held by every ring as a Chrome trace.
+*        Can run while other threads keep recording; spans they overwrite
+*        during the dump are left out.
+*
+* @param path output file, replaced if it exists
+* @return int TRACE_SUCCESS on success, TRACE_FAILURE if the file can't be written.
+*/
+int trace_dump_chrome(const char *path);
+
+#endif /* TRACE_H */
@@ -1,5 +1,5 @@
 """
-Runs the Pi camera viewfinder by default, captures a screenshot on
+Keeps the Pi camera open in-process, grabs a JPEG frame into memory on
 button-A presses, logs button-B touches with pressure & timestamps, and
 sends all collected context (environment + image + interaction log) to
 a Gemini-api to predict MBTI when button C is pressed.
@@ -12,14 +12,15 @@ chord is played on the Rainbow HAT buzzer.
 """
 
 import base64
+import ctypes
+import hashlib
 import os
 import signal
-import subprocess
 import threading
 import time
-import convertapi
+from collections import OrderedDict
 from datetime import datetime
-from typing import List, Tuple
+from typing import List, NamedTuple, Tuple
 
 import requests  # Needs to be available in your QNX Python build
 from dotenv import load_dotenv
@@ -36,15 +37,17 @@ except Exception as e:
 load_dotenv()  # Loads from .env by default
 
 gemini_key = os.environ["GEMINI_API_KEY"]
-convert_key = os.environ["CONVERT_API_KEY"]
 
 # ──────────────────────────────────────────────────────────────────────────────
 #  CONFIGURATION CONSTANTS
 # ──────────────────────────────────────────────────────────────────────────────
-VIEWFINDER_CMD = "camera_example3_viewfinder"
-SCREENSHOT_CMD = "screenshot"  # Should output screenshot.bmp in CWD
-SCREENSHOT_FILE = "screenshot.bmp"
-GEMINI_API_URL = "https://generativelanguage.googleapis.com/v1beta/models/gemini-2.5-flash:generateContent"  # adjust if needed
+CAMERA_CAPTURE_LIB = os.environ.get("CAMERA_CAPTURE_LIB", "libcamera_capture.so")  # built from c/camera_capture.c
+CAMERA_UNIT = int(os.environ.get("CAMERA_UNIT", "1"))
+CAPTURE_TIMEOUT_MS = 500  # a few viewfinder frames
+CAPTURE_WIDTH = 640  # the camera encodes at this size, so nothing is resized here
+CAPTURE_HEIGHT = 480
+GEMINI_BASE_URL = "https://generativelanguage.googleapis.com/"
+GEMINI_API_URL = GEMINI_BASE_URL + "v1beta/models/gemini-2.5-flash:generateContent"  # adjust if needed
 GEMINI_API_KEY_ENV = gemini_key
 
 # Mapping from note names (C4, D#4, etc.) to frequencies (Hz)
@@ -87,16 +90,80 @@ NOTE_FREQ = {
     "B5": 988,
 }
 BUZZER_NOTE_MS = 666  # duration for each note in ms
+ENV_SAMPLE_PERIOD_S = 0.5  # BMP280 standby time; a new reading every 500 ms
+GEMINI_TIMEOUT_S = 30
+GEMINI_CACHE_SIZE = 8
+GEMINI_CACHE_TEMP_STEP_C = 1.0
+GEMINI_CACHE_ALTITUDE_STEP_M = 10.0
+GEMINI_CACHE_PRESSURE_STEP_HPA = 1.0
+
+# The prompt is assembled once here; only the sensor block is formatted per request
+PROMPT_HEAD = (
+    "Given temperature, altitude, pressure, list of touches (chosen number of touches, timing & pressure), and an embedded image of the user, answer the following in the exact format 'MBTI, note1 note2 note3 note4' where MBTI is exactly 4 characters of the predicted personality and note1 note2 note3 note4 makes up a chord that user will likely enjoy from the information we learn about how user interacted with the environment. This means, the output will be of a format \"one string of 4 characters, 4 notes\". Do NOT include any other extra information that might break the format. Extra information is of below and user's pose, style, expression can be learnt from the embedded image.\n"
+)
+PROMPT_SENSORS = (
+    "        Temperature: {temperature}°C\n"
+    "        Altitude: {altitude} m\n"
+    "        Pressure: {pressure} hPa\n"
+    "        Number of touches: {touch_count}\n"
+    "        Touches: {touches}\n"
+)
+PROMPT_QUESTIONS = """Some suggested questions to determine personality: 1. When in a stimulating or chaotic environment (e.g., high altitude and cold), do you appear energized and expressive in your pose or gestures?
+E – outward focus and energy
+2. Does your button press pattern show immediate engagement with minimal hesitation?
+E – impulsivity and outward initiative
+3. In high-pressure settings, do you exhibit stillness, inward posture, or lack of engagement?
+I – reserved nature under external demand
+4. Is your response to the button task delayed but consistent, suggesting internal reflection before action?
+I – inward processing
+5. Is your clothing well-suited to environmental conditions (e.g., warm gear in cold settings), suggesting attention to concrete realities?
+S – practicality and awareness
+6. Do your touch timings show a consistent pattern, adapted to small sensory cues (e.g., temperature shifts)?
+S – real-time sensory feedback
+7. Does your outfit prioritize visual impact or style over practicality (e.g., light clothing in cold), suggesting abstract or conceptual focus?
+N – symbolic thinking or future orientation
+8. Do your button presses form a symbolic or patterned rhythm, not directly linked to environmental demands?
+N – internal pattern generation or imaginative play
+9. In high-pressure conditions, does your posture remain efficient or controlled, minimizing expressive movement?
+T – focus on function and outcome
+10. Is your button interaction steady and deliberate regardless of pressure, prioritizing task success?
+T – logic-based consistency
+11. Do you maintain expressive or open body language despite environmental discomfort?
+F – value alignment or emotional expression
+12. Does your button touch pattern change under discomfort (e.g., delayed or erratic presses when cold), suggesting emotional influence?
+F – emotionally driven reactions
+13. Is your outfit neat and coordinated, possibly indicating pre-planned self-presentation?
+J – structure, preparedness
+14. Do you exhibit an evenly spaced button press pattern with clear start and stop?
+J – planned and organized execution
+15. Does your clothing or hairstyle seem improvised or weather-inappropriate but expressive?
+P – spontaneity or prioritizing comfort/flexibility
+16. Is your touch behavior erratic or exploratory, with no clear pattern in timing or count?
+P – openness to momentary choice"""
 
 # ──────────────────────────────────────────────────────────────────────────────
 #  GLOBAL STATE
 # ──────────────────────────────────────────────────────────────────────────────
-viewfinder_proc: subprocess.Popen | None = None
+camera_lib: ctypes.CDLL | None = None
+camera_buffer: ctypes.Array | None = None  # reused for every grab
+captured_jpeg: bytes | None = None  # image from the last button-A press
 
 current_temp: float | None = None
 current_pressure_hpa: float | None = None
 current_altitude_m: float | None = None
 
+
+class EnvSnapshot(NamedTuple):
+    temperature: float  # °C, already corrected
+    pressure_hpa: float  # hPa, already corrected
+    timestamp_ns: int  # time.monotonic_ns() of the read
+
+
+# Latest sensor reading, replaced as a whole by the sampler thread so readers
+# always see a consistent tuple without locking or touching the I2C bus
+env_snapshot: EnvSnapshot | None = None
+env_sampler_stop = threading.Event()
+
 touch_log: List[Tuple[str, float]] = []  # list of (ISO8601 timestamp, pressure_hpa)
 
 action_lock = threading.Lock()  # prevents overlapping C-button actions
@@ -108,64 +175,140 @@ loading_stop = threading.Event()  # signals the LED loading animation to stop
 # ──────────────────────────────────────────────────────────────────────────────
 
 
-def start_viewfinder():
-    global viewfinder_proc
-    if viewfinder_proc is None or viewfinder_proc.poll() is not None:
+# Return codes from camera_capture.h
+CAPTURE_SUCCESS = 0
+CAPTURE_TIMEOUT = -2
+CAPTURE_BUFFER_TOO_SMALL = -3
+
+
+def open_camera() -> bool:
+    """Load the capture library and start the camera's JPEG viewfinder."""
+    global camera_lib, camera_buffer
+    try:
+        lib = ctypes.CDLL(CAMERA_CAPTURE_LIB)
+    except OSError as exc:
+        print(f"[ERROR] Couldn't load {CAMERA_CAPTURE_LIB}: {exc}")
+        return False
+
+    lib.camera_capture_open.argtypes = [ctypes.c_int, ctypes.c_uint32, ctypes.c_uint32]
+    lib.camera_capture_open.restype = ctypes.c_int
+    lib.camera_capture_max_jpeg_size.argtypes = []
+    lib.camera_capture_max_jpeg_size.restype = ctypes.c_size_t
+    lib.camera_capture_grab_jpeg.argtypes = [
+        ctypes.c_void_p,
+        ctypes.c_size_t,
+        ctypes.POINTER(ctypes.c_size_t),
+        ctypes.c_uint32,
+    ]
+    lib.camera_capture_grab_jpeg.restype = ctypes.c_int
+    lib.camera_capture_close.argtypes = []
+    lib.camera_capture_close.restype = None
+
+    if lib.camera_capture_open(CAMERA_UNIT, CAPTURE_WIDTH, CAPTURE_HEIGHT) != CAPTURE_SUCCESS:
+        print(f"[ERROR] Couldn't open camera unit {CAMERA_UNIT}")
+        return False
+
+    camera_buffer = ctypes.create_string_buffer(lib.camera_capture_max_jpeg_size())
+    camera_lib = lib
+    print("[INFO] Camera ready.")
+    return True
+
+
+def grab_jpeg() -> bytes | None:
+    """Return the next camera frame as JPEG bytes; no files, no conversion."""
+    global camera_buffer
+    if camera_lib is None:
+        return None
+    size = ctypes.c_size_t(0)
+    err = camera_lib.camera_capture_grab_jpeg(
+        camera_buffer, len(camera_buffer), ctypes.byref(size), CAPTURE_TIMEOUT_MS
+    )
+    if err == CAPTURE_BUFFER_TOO_SMALL and size.value > len(camera_buffer):
+        # The size hint is not a hard bound: grow to fit and take the next frame
+        print(f"[WARN] JPEG of {size.value} bytes outgrew the {len(camera_buffer)} byte buffer")
+        camera_buffer = ctypes.create_string_buffer(size.value)
+        err = camera_lib.camera_capture_grab_jpeg(
+            camera_buffer, len(camera_buffer), ctypes.byref(size), CAPTURE_TIMEOUT_MS
+        )
+    if err != CAPTURE_SUCCESS:
+        reason = "timed out" if err == CAPTURE_TIMEOUT else f"failed ({err})"
+        print(f"[ERROR] Camera grab {reason}")
+        return None
+    return ctypes.string_at(camera_buffer, size.value)
+
+
+def close_camera() -> None:
+    global camera_lib
+    if camera_lib is not None:
+        camera_lib.camera_capture_close()
+        camera_lib = None
+
+
+def read_environment_sensors() -> EnvSnapshot:
+    """Blocking I2C read of temperature & pressure from the Rainbow HAT."""
+    # Rainbow HAT sensor reads too high; divide by 2.5 as user discovered
+    return EnvSnapshot(
+        temperature=rainbowhat.weather.temperature() / 2.5,
+        pressure_hpa=rainbowhat.weather.pressure() / 2.5,
+        timestamp_ns=time.monotonic_ns(),
+    )
+
+
+def _env_sampler_worker() -> None:
+    global env_snapshot
+    next_sample = time.monotonic()
+    while not env_sampler_stop.is_set():
         try:
-            viewfinder_proc = subprocess.Popen([VIEWFINDER_CMD])
-            print("[INFO] Viewfinder started.")
-        except FileNotFoundError:
-            print(f"[ERROR] Viewfinder command not found: {VIEWFINDER_CMD}")
+            env_snapshot = read_environment_sensors()
         except Exception as exc:
-            print(f"[ERROR] Failed to start viewfinder: {exc}")
+            # keep the previous snapshot; its timestamp shows its age
+            print(f"[ERROR] Failed to read environment sensors: {exc}")
+        next_sample += ENV_SAMPLE_PERIOD_S
+        env_sampler_stop.wait(max(0.0, next_sample - time.monotonic()))
 
 
-def start_screenshot():
-    global screenshot_proc
-    try:
-        screenshot_proc = subprocess.Popen([SCREENSHOT_CMD])
-        print(f"[INFO] Screenshot started: {SCREENSHOT_FILE}")
-    except FileNotFoundError:
-        print(f"[ERROR] Screenshot command not found: {SCREENSHOT_CMD}")
-    except Exception as exc:
-        print(f"[ERROR] Failed to start screenshot: {exc}")
+def start_environment_sampler() -> None:
+    """Sample the sensors in the background so button handlers never block on I2C."""
+    env_sampler_stop.clear()
+    threading.Thread(target=_env_sampler_worker, daemon=True).start()
+
+
+def stop_environment_sampler() -> None:
+    env_sampler_stop.set()
 
 
-def stop_process(proc, name, timeout=3):
-    if proc and proc.poll() is None:
+def latest_environment() -> EnvSnapshot | None:
+    """Latest background reading, falling back to a direct read before the first one."""
+    snapshot = env_snapshot
+    if snapshot is None:
         try:
-            proc.send_signal(signal.SIGTERM)
-            threading.Timer(
-                timeout, lambda: proc.kill() if proc.poll() is None else None
-            ).start()
-            print(
-                f"[INFO] Sent SIGTERM to {name}. Will force-kill in {timeout}s if needed."
-            )
-        except Exception as e:
-            print(f"[ERROR] Could not stop {name}: {e}")
+            snapshot = read_environment_sensors()
+        except Exception as exc:
+            print(f"[ERROR] Failed to read environment sensors: {exc}")
+    return snapshot
 
 
 def update_environment_readings() -> None:
-    """Read temperature & pressure from Rainbow HAT and derive altitude."""
+    """Take the latest temperature & pressure and derive altitude."""
     global current_temp, current_pressure_hpa, current_altitude_m
 
-    try:
-        # Rainbow HAT sensor reads too high; divide by 2.5 as user discovered
-        current_temp = rainbowhat.weather.temperature() / 2.5
-        current_pressure_hpa = rainbowhat.weather.pressure() / 2.5
-
-        # Altitude estimation via barometric formula (simplified ISA)
-        # altitude = 44330 * (1 - (P / P0)^(1/5.255))
-        P0 = 1013.25  # mean sea-level pressure in hPa
-        current_altitude_m = 44330.0 * (
-            1.0 - (current_pressure_hpa / P0) ** (1 / 5.255)
-        )
+    snapshot = latest_environment()
+    if snapshot is None:
+        return
 
-        print(
-            f"[ENV] T={current_temp:.1f}°C  P={current_pressure_hpa:.1f}hPa  Alt={current_altitude_m:.1f}m"
-        )
-    except Exception as exc:
-        print(f"[ERROR] Failed to read environment sensors: {exc}")
+    current_temp = snapshot.temperature
+    current_pressure_hpa = snapshot.pressure_hpa
+
+    # Altitude estimation via barometric formula (simplified ISA)
+    # altitude = 44330 * (1 - (P / P0)^(1/5.255))
+    P0 = 1013.25  # mean sea-level pressure in hPa
+    current_altitude_m = 44330.0 * (
+        1.0 - (current_pressure_hpa / P0) ** (1 / 5.255)
+    )
+
+    print(
+        f"[ENV] T={current_temp:.1f}°C  P={current_pressure_hpa:.1f}hPa  Alt={current_altitude_m:.1f}m"
+    )
 
 
 def start_led_loading() -> None:
@@ -194,124 +337,129 @@ def stop_led_loading() -> None:
 
 
 def play_chord(chord_str: str) -> None:
-    """Play a 4-note chord on the buzzer sequentially."""
-    notes = chord_str.replace(",", " ").split()
-    for note in notes:
+    """Queue a 4-note chord on the buzzer; playback runs in the background."""
+    notes = []
+    for note in chord_str.replace(",", " ").split():
         freq = NOTE_FREQ.get(note.strip().upper())
         if freq:
-            rainbowhat.buzzer.note(freq, BUZZER_NOTE_MS / 1000.0)
-            time.sleep(0.6)  # tiny gap
-    # rainbowhat.buzzer.note(0, 0)
-
-
-def convert_bmp_to_jpg_online(bmp_path: str, jpg_path: str, secret: str) -> str:
-    # convert_url = f"https://v2.convertapi.com/convert/bmp/to/jpg?Secret={secret}"
-    convertapi.api_credentials = os.environ["CONVERT_API_KEY"]
-    convertapi.convert("jpg", {"File": "screenshot.bmp"}, from_format="bmp").save_files(
-        "screenshot.jpg"
-    )
-
-    print("[INFO] JPG saved to", jpg_path)
-    return jpg_path
-
+            notes.append((freq, BUZZER_NOTE_MS / 1000.0))
+    if notes:
+        rainbowhat.buzzer.flush()
+        rainbowhat.buzzer.play(notes)
+
+
+class GeminiClient:
+    """Long-lived Gemini client.
+
+    One requests.Session keeps the TLS connection alive between presses,
+    warm() opens it ahead of time, and results are cached per image and
+    sensor bucket so a repeated request never leaves the device.
+    """
+
+    def __init__(self, url: str, api_key: str):
+        self.url = url
+        self.session = requests.Session()
+        self.session.headers.update({"Content-Type": "application/json"})
+        self.session.params = {"key": api_key}
+        self.cache: OrderedDict[tuple, str] = OrderedDict()
+        self.cache_lock = threading.Lock()
+        self._warming = threading.Lock()
+
+    def warm(self) -> None:
+        """Open the pooled TLS connection in the background."""
+        if not self._warming.acquire(blocking=False):
+            return
 
-def send_jpg_to_gemini_with_prompt(jpg_path, temperature, altitude, pressure, touches):
-    """Sends a JPEG + structured prompt to Gemini and returns MBTI + chord."""
+        def _worker():
+            try:
+                # Any response leaves the connection in the session's pool
+                self.session.head(GEMINI_BASE_URL, timeout=GEMINI_TIMEOUT_S).close()
+            except requests.RequestException as exc:
+                print(f"[WARN] Gemini prewarm failed: {exc}")
+            finally:
+                self._warming.release()
+
+        threading.Thread(target=_worker, daemon=True).start()
+
+    @staticmethod
+    def cache_key(jpeg: bytes, temperature, altitude, pressure, touches) -> tuple:
+        """Image hash plus coarse sensor buckets, so sensor noise still hits."""
+
+        def bucket(value, step):
+            return None if value is None else round(value / step)
+
+        return (
+            hashlib.sha256(jpeg).digest(),
+            bucket(temperature, GEMINI_CACHE_TEMP_STEP_C),
+            bucket(altitude, GEMINI_CACHE_ALTITUDE_STEP_M),
+            bucket(pressure, GEMINI_CACHE_PRESSURE_STEP_HPA),
+            len(touches),
+        )
 
-    gemini_api_key = os.environ["GEMINI_API_KEY"]
-    gemini_url = f"https://generativelanguage.googleapis.com/v1beta/models/gemini-2.5-flash:generateContent?key={gemini_api_key}"
-
-    # Base64 encode the JPEG
-    with open(jpg_path, "rb") as f:
-        image_b64 = base64.b64encode(f.read()).decode("utf-8")
-
-    # Build the structured prompt
-    touch_str = "\n".join([f"- Time: {t[0]} ms, Pressure: {t[1]} Pa" for t in touches])
-    prompt_text = f"""
-        Given temperature, altitude, pressure, list of touches (chosen number of touches, timing & pressure), and an embedded image of the user, answer the following in the exact format 'MBTI, note1 note2 note3 note4' where MBTI is exactly 4 characters of the predicted personality and note1 note2 note3 note4 makes up a chord that user will likely enjoy from the information we learn about how user interacted with the environment. This means, the output will be of a format "one string of 4 characters, 4 notes". Do NOT include any other extra information that might break the format. Extra information is of below and user's pose, style, expression can be learnt from the embedded image.
-        Temperature: {temperature}°C
-        Altitude: {altitude} m
-        Pressure: {pressure} hPa
-        Number of touches: {len(touches)}
-        Touches: {touch_str}
-Some suggested questions to determine personality: 1. When in a stimulating or chaotic environment (e.g., high altitude and cold), do you appear energized and expressive in your pose or gestures?
-E – outward focus and energy
-2. Does your button press pattern show immediate engagement with minimal hesitation?
-E – impulsivity and outward initiative
-3. In high-pressure settings, do you exhibit stillness, inward posture, or lack of engagement?
-I – reserved nature under external demand
-4. Is your response to the button task delayed but consistent, suggesting internal reflection before action?
-I – inward processing
-5. Is your clothing well-suited to environmental conditions (e.g., warm gear in cold settings), suggesting attention to concrete realities?
-S – practicality and awareness
-6. Do your touch timings show a consistent pattern, adapted to small sensory cues (e.g., temperature shifts)?
-S – real-time sensory feedback
-7. Does your outfit prioritize visual impact or style over practicality (e.g., light clothing in cold), suggesting abstract or conceptual focus?
-N – symbolic thinking or future orientation
-8. Do your button presses form a symbolic or patterned rhythm, not directly linked to environmental demands?
-N – internal pattern generation or imaginative play
-9. In high-pressure conditions, does your posture remain efficient or controlled, minimizing expressive movement?
-T – focus on function and outcome
-10. Is your button interaction steady and deliberate regardless of pressure, prioritizing task success?
-T – logic-based consistency
-11. Do you maintain expressive or open body language despite environmental discomfort?
-F – value alignment or emotional expression
-12. Does your button touch pattern change under discomfort (e.g., delayed or erratic presses when cold), suggesting emotional influence?
-F – emotionally driven reactions
-13. Is your outfit neat and coordinated, possibly indicating pre-planned self-presentation?
-J – structure, preparedness
-14. Do you exhibit an evenly spaced button press pattern with clear start and stop?
-J – planned and organized execution
-15. Does your clothing or hairstyle seem improvised or weather-inappropriate but expressive?
-P – spontaneity or prioritizing comfort/flexibility
-16. Is your touch behavior erratic or exploratory, with no clear pattern in timing or count?
-P – openness to momentary choice
-        """
-
-    payload = {
-        "contents": [
-            {
-                "parts": [
-                    {"text": prompt_text.strip()},
-                    {"inline_data": {"mime_type": "image/jpeg", "data": image_b64}},
-                ]
-            }
-        ]
-    }
-
-    headers = {
-        "Content-Type": "application/json",
-    }
-    response = requests.post(gemini_url, headers=headers, json=payload)
-    response.raise_for_status()
-
-    return response.json()["candidates"][0]["content"]["parts"][0]["text"]
-
-
-def screenshot_bmp_to_gemini_response(
-    bmp_path, temperature, altitude, pressure, touches
-):
-    jpg_path = "screenshot.jpg"
-    convert_bmp_to_jpg_online(bmp_path, jpg_path, convert_key)
-    return send_jpg_to_gemini_with_prompt(
-        jpg_path, temperature, altitude, pressure, touches
-    )
+    def predict(self, jpeg: bytes, temperature, altitude, pressure, touches) -> str:
+        """Send a JPEG + structured prompt to Gemini and return MBTI + chord."""
+        key = self.cache_key(jpeg, temperature, altitude, pressure, touches)
+        with self.cache_lock:
+            if key in self.cache:
+                self.cache.move_to_end(key)
+                print("[INFO] Gemini result served from cache.")
+                return self.cache[key]
+
+        touch_str = "\n".join(f"- Time: {t[0]} ms, Pressure: {t[1]} Pa" for t in touches)
+        prompt_text = PROMPT_HEAD + PROMPT_SENSORS.format(
+            temperature=temperature,
+            altitude=altitude,
+            pressure=pressure,
+            touch_count=len(touches),
+            touches=touch_str,
+        ) + PROMPT_QUESTIONS
+
+        payload = {
+            "contents": [
+                {
+                    "parts": [
+                        {"text": prompt_text},
+                        {
+                            "inline_data": {
+                                "mime_type": "image/jpeg",
+                                "data": base64.b64encode(jpeg).decode("ascii"),
+                            }
+                        },
+                    ]
+                }
+            ]
+        }
+
+        response = self.session.post(self.url, json=payload, timeout=GEMINI_TIMEOUT_S)
+        response.raise_for_status()
+        result = response.json()["candidates"][0]["content"]["parts"][0]["text"]
+
+        with self.cache_lock:
+            self.cache[key] = result
+            while len(self.cache) > GEMINI_CACHE_SIZE:
+                self.cache.popitem(last=False)
+        return result
+
+
+gemini = GeminiClient(GEMINI_API_URL, GEMINI_API_KEY_ENV)
 
 
 def send_to_gemini() -> None:
     global current_temp, current_pressure_hpa, current_altitude_m, touch_log
     """Send collected data + image to Gemini asynchronously."""
     with action_lock:
+        if captured_jpeg is None:
+            print("[ERROR] No image captured yet; press A first.")
+            return
         start_led_loading()
-        result = screenshot_bmp_to_gemini_response(
-            bmp_path="screenshot.bmp",
+        result = gemini.predict(
+            captured_jpeg,
             temperature=current_temp,
             altitude=current_altitude_m,
             pressure=current_pressure_hpa,
             touches=touch_log,
         )
         stop_led_loading()
-        time.sleep(0.6)  # tiny gap
 
         print(f"result = {result}")
         try:
@@ -342,26 +490,29 @@ def send_to_gemini() -> None:
 
 @rainbowhat.touch.A.press()
 def on_a_press(_):
+    global captured_jpeg
     rainbowhat.display.clear()
     stop_led_loading()
     rainbowhat.lights.rgb(1, 0, 0)
-    start_viewfinder()
-    start_screenshot()
+    gemini.warm()  # TLS handshake overlaps the rest of the interaction
+    jpeg = grab_jpeg()
+    if jpeg is not None:
+        captured_jpeg = jpeg
+        print(f"[INFO] Captured {len(jpeg)} byte JPEG.")
 
 
 @rainbowhat.touch.A.release()
 def on_a_release(_):
     rainbowhat.lights.rgb(0, 0, 0)
-    stop_process(screenshot_proc, SCREENSHOT_CMD)
-    stop_process(viewfinder_proc, VIEWFINDER_CMD)
     update_environment_readings()
 
 
 @rainbowhat.touch.B.press()
 def on_b_press(_):
     ts = datetime.utcnow().isoformat() + "Z"
-    pressure = rainbowhat.weather.pressure() / 2.5  # immediate read
-    touch_log.append((ts, pressure))
+    snapshot = latest_environment()  # latest background sample, no I2C read here
+    if snapshot is not None:
+        touch_log.append((ts, snapshot.pressure_hpa))
     rainbowhat.lights.rgb(0, 1, 0)
 
 
@@ -387,23 +538,23 @@ def on_c_release(_):
 
 
 def cleanup():
-    try:
-        if viewfinder_proc and viewfinder_proc.poll() is None:
-            viewfinder_proc.terminate()
-    except Exception:
-        pass
+    stop_environment_sampler()
+    close_camera()
     rainbowhat.touch.cleanup()
     rainbowhat.rainbow.set_all(0, 0, 0)
     rainbowhat.rainbow.show()
     rainbowhat.display.clear()
     rainbowhat.display.show()
-    rainbowhat.buzzer.note(0, 0)
+    rainbowhat.buzzer.flush()
+    rainbowhat.buzzer.stop()
     print("[INFO] Clean exit.")
 
 
 def main():
     signal.signal(signal.SIGINT, lambda *_: cleanup() or exit(0))
     signal.signal(signal.SIGTERM, lambda *_: cleanup() or exit(0))
+    start_environment_sampler()
+    open_camera()
     print("[INFO] System ready – press buttons on Rainbow HAT.")
     rainbowhat.display.clear()
     rainbowhat.display.print_str("6666")
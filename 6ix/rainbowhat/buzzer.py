@@ -1,5 +1,7 @@
 """Rainbow HAT Piezo Buzzer."""
-from threading import Timer
+from collections import deque
+from threading import Condition, Thread, Timer
+import time
 
 try:
     import rpi_gpio as GPIO
@@ -14,6 +16,16 @@ _is_setup = False
 
 pwm = None
 
+_sequence = deque()
+
+_sequence_cond = Condition()
+
+_sequence_generation = 0
+
+_sequence_playing = False
+
+_sequencer = None
+
 
 def setup():
     """Set up the piezo buzzer."""
@@ -94,5 +106,96 @@ def stop():
     """
     clear_timeout()
 
+    _silence()
+
+
+
+def _silence():
     GPIO.setup(BUZZER, GPIO.IN)
 
+
+def _sequencer_worker():
+    """Play queued notes back to back, each timed from the previous end."""
+    global _sequence_playing
+
+    note_end = None
+    with _sequence_cond:
+        while True:
+            while not _sequence:
+                if _sequence_playing:
+                    _sequence_playing = False
+                    note_end = None
+                    _silence()
+                _sequence_cond.wait()
+
+            frequency, duration = _sequence.popleft()
+            generation = _sequence_generation
+
+            if note_end is None:
+                note_end = time.monotonic()
+            note_end += duration
+            _sequence_playing = True
+
+            clear_timeout()
+            if frequency:
+                pwm.ChangeFrequency(frequency)
+            else:
+                _silence()
+
+            # A flush bumps the generation and wakes us before the note ends
+            while generation == _sequence_generation:
+                remaining = note_end - time.monotonic()
+                if remaining <= 0:
+                    break
+                _sequence_cond.wait(remaining)
+
+            if generation != _sequence_generation:
+                _sequence_playing = False
+                note_end = None
+                _silence()
+
+
+def play(notes):
+    """Queue notes and return immediately.
+
+    Notes play one after another on a background thread, so a chord or a
+    short tune doesn't block the caller. Don't mix this with note().
+
+    :param notes: Iterable of (frequency, duration) pairs, frequency in hertz
+        (0 or None for a rest) and duration in seconds
+
+    """
+    global _sequencer
+
+    queued = []
+    for frequency, duration in notes:
+        if duration <= 0:
+            raise ValueError("Duration must be > 0")
+        if frequency is not None and frequency < 0:
+            raise ValueError("Frequency must be >= 0")
+        queued.append((frequency or 0, duration))
+
+    setup()
+
+    with _sequence_cond:
+        if _sequencer is None:
+            _sequencer = Thread(target=_sequencer_worker, daemon=True)
+            _sequencer.start()
+        _sequence.extend(queued)
+        _sequence_cond.notify()
+
+
+def flush():
+    """Drop any queued notes and cut the playing one short."""
+    global _sequence_generation
+
+    with _sequence_cond:
+        _sequence.clear()
+        _sequence_generation += 1
+        _sequence_cond.notify()
+
+
+def busy():
+    """Return True while queued notes are still playing."""
+    with _sequence_cond:
+        return _sequence_playing or bool(_sequence)
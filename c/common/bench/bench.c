@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+
+// Longest a calibration run may grow by in one step
+#define CALIBRATION_MAX_GROWTH 100
+
+static uint64_t min_time_ns = BENCH_DEFAULT_MIN_TIME_MS * 1000000ULL;
+static unsigned repeats = BENCH_DEFAULT_REPEATS;
+static const char *filter = NULL;
+
+static volatile const void *clobber_sink;
+
+static uint64_t clock_ns(clockid_t clock)
+{
+    struct timespec t;
+
+    if (clock_gettime(clock, &t) != 0)
+    {
+        return 0;
+    }
+
+    return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static double median(double *values, unsigned count)
+{
+    qsort(values, count, sizeof(values[0]), compare_double);
+
+    if (count % 2)
+    {
+        return values[count / 2];
+    }
+
+    return (values[count / 2 - 1] + values[count / 2]) / 2.0;
+}
+
+// The fields every result line starts with
+static void print_case(const bench_case_t *bench)
+{
+    printf("{\"library\":\"%s\",\"benchmark\":\"%s\"", bench->library, bench->name);
+    if (bench->param)
+    {
+        printf(",\"param\":\"%s\",\"value\":%llu", bench->param, (unsigned long long)bench->value);
+    }
+}
+
+int bench_parse_option(int opt, const char *arg)
+{
+    char *end;
+    unsigned long value;
+
+    switch (opt)
+    {
+    case 't':
+        value = strtoul(arg, &end, 0);
+        if ((*end != '\0') || (value == 0))
+        {
+            return BENCH_FAILURE;
+        }
+        min_time_ns = value * 1000000ULL;
+        return BENCH_SUCCESS;
+
+    case 'r':
+        value = strtoul(arg, &end, 0);
+        if ((*end != '\0') || (value == 0) || (value > BENCH_MAX_REPEATS))
+        {
+            return BENCH_FAILURE;
+        }
+        repeats = value;
+        return BENCH_SUCCESS;
+
+    case 'f':
+        filter = arg;
+        return BENCH_SUCCESS;
+
+    default:
+        return BENCH_FAILURE;
+    }
+}
+
+void bench_usage(const char *program, const char *extra)
+{
+    fprintf(stderr, "usage: %s [-t min_ms] [-r repeats] [-f filter]%s%s\n", program,
+            extra ? " " : "", extra ? extra : "");
+}
+
+bool bench_selected(const char *name)
+{
+    return (filter == NULL) || (strstr(name, filter) != NULL);
+}
+
+void bench_run(const bench_case_t *bench, bench_fn_t fn, void *arg)
+{
+    double wall[BENCH_MAX_REPEATS];
+    double cpu[BENCH_MAX_REPEATS];
+    double wall_min;
+    double wall_median;
+    double cpu_median;
+    uint64_t iterations = 1;
+    unsigned i;
+
+    if (!bench_selected(bench->name))
+    {
+        return;
+    }
+
+    // Grow the run until it is long enough to time; this also warms up caches and drivers
+    while (1)
+    {
+        const uint64_t start = clock_ns(CLOCK_MONOTONIC);
+        uint64_t elapsed;
+        uint64_t growth;
+
+        fn(arg, iterations);
+        elapsed = clock_ns(CLOCK_MONOTONIC) - start;
+
+        if (elapsed >= min_time_ns)
+        {
+            break;
+        }
+
+        growth = (elapsed > 0) ? (min_time_ns + min_time_ns / 5) / elapsed + 1 : CALIBRATION_MAX_GROWTH;
+        if (growth < 2)
+        {
+            growth = 2;
+        }
+        else if (growth > CALIBRATION_MAX_GROWTH)
+        {
+            growth = CALIBRATION_MAX_GROWTH;
+        }
+        iterations *= growth;
+    }
+
+    for (i = 0; i < repeats; i++)
+    {
+        const uint64_t wall_start = clock_ns(CLOCK_MONOTONIC);
+        const uint64_t cpu_start = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+
+        fn(arg, iterations);
+
+        cpu[i] = (double)(clock_ns(CLOCK_THREAD_CPUTIME_ID) - cpu_start) / iterations;
+        wall[i] = (double)(clock_ns(CLOCK_MONOTONIC) - wall_start) / iterations;
+    }
+
+    wall_median = median(wall, repeats);
+    wall_min = wall[0]; // sorted by median()
+    cpu_median = median(cpu, repeats);
+
+    print_case(bench);
+    printf(",\"iterations\":%llu,\"repeats\":%u", (unsigned long long)iterations, repeats);
+    printf(",\"wall_ns_per_op\":%.1f,\"wall_ns_per_op_min\":%.1f,\"cpu_ns_per_op\":%.1f",
+           wall_median, wall_min, cpu_median);
+    printf(",\"unit\":\"%s\",\"items_per_s\":%.1f,\"items_per_cpu_s\":%.1f}\n", bench->unit,
+           (wall_median > 0) ? bench->items_per_op * 1e9 / wall_median : 0.0,
+           (cpu_median > 0) ? bench->items_per_op * 1e9 / cpu_median : 0.0);
+    fflush(stdout);
+}
+
+void bench_skip(const bench_case_t *bench, const char *reason)
+{
+    if (!bench_selected(bench->name))
+    {
+        return;
+    }
+
+    print_case(bench);
+    printf(",\"skipped\":\"%s\"}\n", reason);
+    fflush(stdout);
+}
+
+int bench_check(const char *library, const char *name, unsigned cases, unsigned mismatches)
+{
+    printf("{\"library\":\"%s\",\"check\":\"%s\",\"cases\":%u,\"mismatches\":%u}\n", library, name, cases,
+           mismatches);
+    fflush(stdout);
+
+    return (mismatches == 0) ? BENCH_SUCCESS : BENCH_FAILURE;
+}
+
+void bench_clobber(const void *ptr)
+{
+    clobber_sink = ptr;
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Return codes */
+#define BENCH_SUCCESS 0
+#define BENCH_FAILURE -1
+
+/* getopt() options every benchmark accepts, see bench_parse_option() */
+#define BENCH_OPTIONS "t:r:f:"
+
+/* Defaults for the -t and -r options */
+#define BENCH_DEFAULT_MIN_TIME_MS 100
+#define BENCH_DEFAULT_REPEATS 5
+#define BENCH_MAX_REPEATS 64
+
+/**
+ * Code under test: run it iterations times
+ *
+ * @param    arg         benchmark state passed to bench_run()
+ * @param    iterations  number of operations to run
+ */
+typedef void (*bench_fn_t)(void *arg, uint64_t iterations);
+
+/* One measurement, reported as one JSON object per line on stdout */
+typedef struct
+{
+    const char *library;   // library under test, e.g. "rpi_spi"
+    const char *name;      // benchmark name, matched by the -f filter
+    const char *param;     // name of the swept parameter, NULL if there is none
+    uint64_t value;        // value of the swept parameter
+    double items_per_op;   // work done by one operation, in unit
+    const char *unit;      // "bytes", "leds", "pixels", "transactions", "toggles"
+} bench_case_t;
+
+/**
+ * Handle one of the BENCH_OPTIONS
+ *
+ *   -t ms    minimum run time of each repeat (default BENCH_DEFAULT_MIN_TIME_MS)
+ *   -r n     repeats per measurement, up to BENCH_MAX_REPEATS; the median is reported
+ *            (default BENCH_DEFAULT_REPEATS)
+ *   -f text  only run benchmarks whose name contains text
+ *
+ * @param    opt  option character returned by getopt()
+ * @param    arg  its argument
+ *
+ * @returns  BENCH_SUCCESS  if the option was handled
+ *           BENCH_FAILURE  for an unknown option or a bad argument
+ */
+int bench_parse_option(int opt, const char *arg);
+
+/**
+ * Print the usage line for BENCH_OPTIONS
+ *
+ * @param    program  argv[0]
+ * @param    extra    usage text for the benchmark's own options, may be NULL
+ */
+void bench_usage(const char *program, const char *extra);
+
+/**
+ * Check a benchmark name against the -f filter
+ *
+ * @param    name  benchmark name
+ *
+ * @returns  true if the benchmark should run
+ */
+bool bench_selected(const char *name);
+
+/**
+ * Measure fn and print the result
+ *
+ * The iteration count is doubled until one run takes the minimum time, then
+ * that many iterations are run for every repeat. Wall and thread CPU time
+ * are both reported: for code that hands work to another thread or waits on
+ * a driver, the CPU time is what the caller itself spent.
+ *
+ * @param    bench  what is measured
+ * @param    fn     code under test
+ * @param    arg    passed to fn
+ */
+void bench_run(const bench_case_t *bench, bench_fn_t fn, void *arg);
+
+/**
+ * Print a result line for a benchmark that could not run
+ *
+ * @param    bench   the benchmark
+ * @param    reason  why it did not run
+ */
+void bench_skip(const bench_case_t *bench, const char *reason);
+
+/**
+ * Print the result of a correctness check run before the measurements
+ *
+ * @param    library     library under test
+ * @param    name        what was checked
+ * @param    cases       number of inputs compared
+ * @param    mismatches  number of inputs that gave a different result
+ *
+ * @returns  BENCH_SUCCESS  if there were no mismatches
+ *           BENCH_FAILURE  otherwise
+ */
+int bench_check(const char *library, const char *name, unsigned cases, unsigned mismatches);
+
+/**
+ * Keep the compiler from discarding results that are never read
+ *
+ * @param    ptr  result to keep
+ */
+void bench_clobber(const void *ptr);
+
+#endif /* BENCH_H */
@@ -0,0 +1,61 @@
+#Benchmark rules shared by the library Makefiles, see ../bench/README.md
+#Include at the end of a library Makefile. Before the include, set
+#  BENCH_LIBS      - archives the library links against, in link order
+#  BENCH_HOST_SRCS - sources of those archives, for the off-target build
+
+BENCH_DIR = ../bench
+BENCH_NAME = $(PROJECT_NAME)_bench
+BENCH_SRCS = $(BENCH_DIR)/bench.c $(BENCH_DIR)/$(BENCH_NAME).c
+BENCH_INCLUDES = -I$(BENCH_DIR) -I./public $(INCLUDES)
+
+#Arguments passed to the benchmark by bench-host, i.e. BENCH_ARGS="-t 500 -r 9"
+BENCH_ARGS ?=
+
+#Target build, copy $(BENCH_TARGET) to the board and run it there
+BENCH_OUTPUT_DIR = $(OUTPUT_DIR)/bench
+BENCH_OBJS = $(addprefix $(BENCH_OUTPUT_DIR)/,$(notdir $(BENCH_SRCS:.c=.o)))
+BENCH_TARGET = $(BENCH_OUTPUT_DIR)/$(BENCH_NAME)
+
+$(BENCH_OUTPUT_DIR)/%.o: $(BENCH_DIR)/%.c
+	-@mkdir -p $(BENCH_OUTPUT_DIR)
+	$(CC) -c $(DEPS) -o $@ $(BENCH_INCLUDES) $(CCFLAGS_all) $(CCFLAGS) $<
+
+$(BENCH_TARGET): $(BENCH_OBJS) $(TARGET)
+	$(LD) -o $@ $(LDFLAGS_all) $(LDFLAGS) $(BENCH_OBJS) $(TARGET) $(BENCH_LIBS) $(LIBS_all) $(LIBS) -lm
+
+bench: $(BENCH_TARGET)
+
+#Host build, the QNX driver calls are stubbed by $(BENCH_DIR)/host
+HOST_CC ?= cc
+BENCH_HOST_DIR = build/host
+BENCH_HOST_CCFLAGS = -O2 -Wall -fmessage-length=0 -D_GNU_SOURCE -I$(BENCH_DIR)/host
+BENCH_HOST_LIB_SRCS = $(SRCS) $(BENCH_HOST_SRCS) $(BENCH_DIR)/host/qnx_host.c
+BENCH_HOST_LIB_OBJS = $(addprefix $(BENCH_HOST_DIR)/,$(notdir $(BENCH_HOST_LIB_SRCS:.c=.o)))
+BENCH_HOST_OBJS = $(addprefix $(BENCH_HOST_DIR)/,$(notdir $(BENCH_SRCS:.c=.o)))
+BENCH_HOST_LIB = $(BENCH_HOST_DIR)/libbench_host.a
+BENCH_HOST_TARGET = $(BENCH_HOST_DIR)/$(BENCH_NAME)
+
+#Sources live in several directories, object names stay unique
+vpath %.c $(sort $(dir $(BENCH_HOST_LIB_SRCS) $(BENCH_SRCS)))
+
+$(BENCH_HOST_DIR)/%.o: %.c
+	-@mkdir -p $(BENCH_HOST_DIR)
+	$(HOST_CC) -c -o $@ $(BENCH_HOST_CCFLAGS) $(BENCH_INCLUDES) $<
+
+#Archive the library so unused objects, i.e. the mini_fastled main(), stay out like on target
+$(BENCH_HOST_LIB): $(BENCH_HOST_LIB_OBJS)
+	rm -f $@
+	ar rcs $@ $^
+
+$(BENCH_HOST_TARGET): $(BENCH_HOST_OBJS) $(BENCH_HOST_LIB)
+	$(HOST_CC) -o $@ $(BENCH_HOST_OBJS) $(BENCH_HOST_LIB) -Wl,--wrap=open -lpthread -lm
+
+bench-host: $(BENCH_HOST_TARGET)
+	$(BENCH_HOST_TARGET) $(BENCH_ARGS)
+
+bench-clean:
+	rm -f $(BENCH_TARGET) $(BENCH_HOST_TARGET) $(BENCH_HOST_LIB)
+
+clean: bench-clean
+
+.PHONY: bench bench-host bench-clean
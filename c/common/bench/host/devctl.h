@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Off-target stand-in for the QNX <devctl.h>, see qnx_host.c */
+
+#ifndef BENCH_HOST_DEVCTL_H
+#define BENCH_HOST_DEVCTL_H
+
+#include <errno.h>
+#include <stddef.h>
+#include <sys/uio.h>
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+typedef struct iovec iov_t;
+
+#define SETIOV(_iov, _addr, _len) ((_iov)->iov_base = (void *)(_addr), (_iov)->iov_len = (_len))
+
+int devctl(int fd, int dcmd, void *dev_data_ptr, size_t n_bytes, int *dev_info_ptr);
+int devctlv(int fd, int dcmd, int sparts, int rparts, const iov_t *sv, const iov_t *rv, int *dev_info_ptr);
+
+#endif /* BENCH_HOST_DEVCTL_H */
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Off-target stand-in for the QNX <hw/i2c.h>: only what rpi_i2c uses */
+
+#ifndef BENCH_HOST_I2C_H
+#define BENCH_HOST_I2C_H
+
+#include <stdint.h>
+#include <string.h>
+#include <devctl.h>
+
+#define DCMD_I2C_SEND           5
+#define DCMD_I2C_SENDRECV       6
+
+#define I2C_ADDRFMT_7BIT        0x0001
+
+typedef struct
+{
+    uint32_t addr;
+    uint32_t fmt;
+} i2c_addr_t;
+
+typedef struct
+{
+    i2c_addr_t slave;
+    uint32_t len;
+    uint32_t stop;
+} i2c_send_t;
+
+typedef struct
+{
+    i2c_addr_t slave;
+    uint32_t send_len;
+    uint32_t recv_len;
+    uint32_t stop;
+} i2c_sendrecv_t;
+
+#endif /* BENCH_HOST_I2C_H */
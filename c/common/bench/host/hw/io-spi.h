@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Off-target stand-in for the QNX <hw/io-spi.h>: only what rpi_spi uses */
+
+#ifndef BENCH_HOST_IO_SPI_H
+#define BENCH_HOST_IO_SPI_H
+
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <devctl.h>
+
+#define DCMD_SPI_SET_CONFIG     1
+#define DCMD_SPI_GET_DRVINFO    2
+#define DCMD_SPI_GET_DEVINFO    3
+#define DCMD_SPI_DATA_XCHNG     4
+
+typedef struct
+{
+    uint32_t mode;
+    uint32_t clock_rate;
+} spi_cfg_t;
+
+typedef struct
+{
+    uint32_t version;
+    char name[16];
+    uint32_t feature;
+} spi_drvinfo_t;
+
+typedef struct
+{
+    uint32_t device;
+    char name[16];
+    spi_cfg_t cfg;
+} spi_devinfo_t;
+
+typedef struct
+{
+    uint32_t nbytes;
+    uint32_t reserved;
+    uint8_t data[];
+} spi_xchng_t;
+
+#endif /* BENCH_HOST_IO_SPI_H */
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Off-target stand-ins for the QNX kernel calls and device drivers the
+ * c/common libraries use, so their encode and message paths can be
+ * benchmarked on a development host.
+ *
+ * Link with -Wl,--wrap=open: the device nodes the libraries open are
+ * redirected to /dev/null, every other path goes to the real open().
+ * SPI exchanges loop the written bytes back, I2C reads return zeros and
+ * GPIO messages are accepted as if the resource manager had replied.
+ */
+
+#include <fcntl.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <time.h>
+
+#include <devctl.h>
+#include <hw/i2c.h>
+#include <hw/io-spi.h>
+#include <sys/neutrino.h>
+
+int __real_open(const char *path, int flags, ...);
+
+// Device nodes opened by rpi_spi, rpi_i2c and rpi_gpio
+static const char *const device_prefixes[] = {"/dev/io-spi/", "/dev/i2c", "/dev/gpio/"};
+
+int __wrap_open(const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+    va_list args;
+
+    for (unsigned i = 0; i < sizeof(device_prefixes) / sizeof(device_prefixes[0]); i++)
+    {
+        if (strncmp(path, device_prefixes[i], strlen(device_prefixes[i])) == 0)
+        {
+            return __real_open("/dev/null", O_RDWR);
+        }
+    }
+
+    if (flags & O_CREAT)
+    {
+        va_start(args, flags);
+        mode = va_arg(args, mode_t);
+        va_end(args);
+    }
+
+    return __real_open(path, flags, mode);
+}
+
+// Copy the gathered send parts after skip bytes into the reply parts after skip bytes
+static void loopback_iov(int sparts, const iov_t *sv, int rparts, const iov_t *rv, size_t skip)
+{
+    size_t send_skip = skip;
+    size_t reply_skip = skip;
+    int s = 0;
+    int r = 0;
+    size_t send_offset = 0;
+    size_t reply_offset = 0;
+
+    while ((s < sparts) && (r < rparts))
+    {
+        size_t send_left = sv[s].iov_len - send_offset;
+        size_t reply_left = rv[r].iov_len - reply_offset;
+        size_t count;
+
+        if (send_skip > 0)
+        {
+            count = (send_skip < send_left) ? send_skip : send_left;
+            send_skip -= count;
+            send_offset += count;
+        }
+        else if (reply_skip > 0)
+        {
+            count = (reply_skip < reply_left) ? reply_skip : reply_left;
+            reply_skip -= count;
+            reply_offset += count;
+        }
+        else
+        {
+            count = (send_left < reply_left) ? send_left : reply_left;
+            memcpy((uint8_t *)rv[r].iov_base + reply_offset, (const uint8_t *)sv[s].iov_base + send_offset, count);
+            send_offset += count;
+            reply_offset += count;
+        }
+
+        if (send_offset == sv[s].iov_len)
+        {
+            s++;
+            send_offset = 0;
+        }
+        if (reply_offset == rv[r].iov_len)
+        {
+            r++;
+            reply_offset = 0;
+        }
+    }
+}
+
+int devctl(int fd, int dcmd, void *dev_data_ptr, size_t n_bytes, int *dev_info_ptr)
+{
+    (void)fd;
+    (void)n_bytes;
+
+    if (dev_info_ptr)
+    {
+        *dev_info_ptr = 0;
+    }
+
+    switch (dcmd)
+    {
+    case DCMD_SPI_GET_DRVINFO:
+    {
+        spi_drvinfo_t *info = dev_data_ptr;
+
+        memset(info, 0, sizeof(*info));
+        strcpy(info->name, "host");
+        break;
+    }
+
+    case DCMD_SPI_GET_DEVINFO:
+    {
+        spi_devinfo_t *info = dev_data_ptr;
+
+        memset(info, 0, sizeof(*info));
+        strcpy(info->name, "host");
+        break;
+    }
+
+    case DCMD_I2C_SENDRECV:
+    {
+        i2c_sendrecv_t *hdr = dev_data_ptr;
+
+        // The read data replaces the sent bytes after the header
+        memset(hdr + 1, 0, hdr->recv_len);
+        break;
+    }
+
+    default:
+        // DCMD_SPI_DATA_XCHNG is a loopback in place, SET_CONFIG and I2C_SEND are accepted
+        break;
+    }
+
+    return EOK;
+}
+
+int devctlv(int fd, int dcmd, int sparts, int rparts, const iov_t *sv, const iov_t *rv, int *dev_info_ptr)
+{
+    (void)fd;
+
+    if (dev_info_ptr)
+    {
+        *dev_info_ptr = 0;
+    }
+
+    if (dcmd == DCMD_SPI_DATA_XCHNG)
+    {
+        loopback_iov(sparts, sv, rparts, rv, sizeof(spi_xchng_t));
+    }
+
+    return EOK;
+}
+
+int MsgSend(int coid, const void *smsg, size_t sbytes, void *rmsg, size_t rbytes)
+{
+    (void)coid;
+
+    // Requests that reply in the same buffer keep what was sent
+    if ((rmsg != NULL) && (rmsg != smsg))
+    {
+        memcpy(rmsg, smsg, (sbytes < rbytes) ? sbytes : rbytes);
+    }
+
+    return EOK;
+}
+
+int MsgRegisterEvent(struct sigevent *event, int coid)
+{
+    (void)event;
+    (void)coid;
+
+    return EOK;
+}
+
+int nanospin_ns(unsigned long nsec)
+{
+    struct timespec start;
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while ((unsigned long)((now.tv_sec - start.tv_sec) * 1000000000L + (now.tv_nsec - start.tv_nsec)) < nsec);
+
+    return EOK;
+}
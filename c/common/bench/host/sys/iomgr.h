@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Off-target stand-in for the QNX <sys/iomgr.h> */
+
+#ifndef BENCH_HOST_IOMGR_H
+#define BENCH_HOST_IOMGR_H
+
+#define _IOMGR_PRIVATE_BASE     0xf000
+
+#endif /* BENCH_HOST_IOMGR_H */
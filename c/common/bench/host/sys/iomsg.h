@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Off-target stand-in for the QNX <sys/iomsg.h>: only what the GPIO messages use */
+
+#ifndef BENCH_HOST_IOMSG_H
+#define BENCH_HOST_IOMSG_H
+
+#include <signal.h>
+#include <stdint.h>
+
+#define _IO_MSG                 0x0113
+
+struct _io_msg
+{
+    uint16_t type;
+    uint16_t combine_len;
+    uint16_t mgrid;
+    uint16_t subtype;
+};
+
+#endif /* BENCH_HOST_IOMSG_H */
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Off-target additions to <sys/mman.h> for the QNX physical mapping flags */
+
+#ifndef BENCH_HOST_MMAN_H
+#define BENCH_HOST_MMAN_H
+
+#include_next <sys/mman.h>
+
+// Physical mappings are not possible off-target; mmap fails on NOFD
+#define __PAGESIZE              4096
+#define PROT_NOCACHE            0
+#define MAP_PHYS                0
+#define NOFD                    (-1)
+
+#endif /* BENCH_HOST_MMAN_H */
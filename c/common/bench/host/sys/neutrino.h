@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Off-target stand-in for the QNX <sys/neutrino.h>, see qnx_host.c */
+
+#ifndef BENCH_HOST_NEUTRINO_H
+#define BENCH_HOST_NEUTRINO_H
+
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <devctl.h>
+
+#define _PULSE_CODE_MINAVAIL    0
+
+#define SIGEV_PULSE_INIT(__e, __coid, __prio, __code, __value) \
+    ((__e)->sigev_notify = SIGEV_NONE, (__e)->sigev_value.sival_int = (__value))
+
+int MsgSend(int coid, const void *smsg, size_t sbytes, void *rmsg, size_t rbytes);
+int MsgRegisterEvent(struct sigevent *event, int coid);
+int nanospin_ns(unsigned long nsec);
+
+#endif /* BENCH_HOST_NEUTRINO_H */
@@ -0,0 +1,464 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * mini_fastled bulk color kernels in pixels/s. None of them touch the
+ * hardware, so host and target numbers differ only by the CPU and by the
+ * NEON paths, which are built for aarch64 only.
+ *
+ * Before measuring, the bulk kernels are compared against a plain per-byte
+ * implementation on random frames. Built for aarch64 this checks the NEON
+ * paths bit for bit, elsewhere the scalar ones; any mismatch fails the run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "mini_fastled.h"
+
+#define BENCH_FASTLED_MAX_PIXELS 16384
+#define BENCH_FASTLED_GAMMA 2.2f
+
+static const uint16_t pixel_counts[] = {16, 144, 1024, 4096, BENCH_FASTLED_MAX_PIXELS};
+
+// Check lengths around the 16 LED NEON block, and a long odd one
+#define CHECK_MAX_PIXELS 1024
+#define CHECK_GUARD_PIXELS 16
+#define CHECK_SEED 0x6c3du
+
+static const uint16_t check_counts[] = {0, 1, 3, 15, 16, 17, 31, 32, 33, 100, 1023};
+static const uint16_t check_widths[] = {1, 5, 15, 16, 17, 33, 64};
+static const uint16_t check_heights[] = {1, 2, 3, 16};
+static const uint8_t check_amounts[] = {0, 1, 2, 64, 127, 128, 200, 254, 255};
+
+typedef struct
+{
+    CRGB *leds;
+    CRGB *overlay;
+    rgb_pixel_set set;
+} fastled_bench_t;
+
+static void bench_nscale8(void *arg, uint64_t iterations)
+{
+    fastled_bench_t *fastled = arg;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        nscale8_leds(fastled->leds, fastled->set.length, 250);
+    }
+    bench_clobber(fastled->leds);
+}
+
+static void bench_fade_to_black(void *arg, uint64_t iterations)
+{
+    fastled_bench_t *fastled = arg;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        fadeToBlackBy_leds(fastled->leds, fastled->set.length, 20);
+    }
+    bench_clobber(fastled->leds);
+}
+
+static void bench_nblend(void *arg, uint64_t iterations)
+{
+    fastled_bench_t *fastled = arg;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        nblend_leds(fastled->leds, fastled->overlay, fastled->set.length, 128);
+    }
+    bench_clobber(fastled->leds);
+}
+
+static void bench_blur1d(void *arg, uint64_t iterations)
+{
+    fastled_bench_t *fastled = arg;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        blur1d_leds(fastled->leds, fastled->set.length, 64);
+    }
+    bench_clobber(fastled->leds);
+}
+
+static void bench_gamma(void *arg, uint64_t iterations)
+{
+    fastled_bench_t *fastled = arg;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        napplyGamma_video(fastled->leds, fastled->set.length, BENCH_FASTLED_GAMMA);
+    }
+    bench_clobber(fastled->leds);
+}
+
+// Pixel set helpers also keep the power tracking sums current
+static void bench_fill_rainbow(void *arg, uint64_t iterations)
+{
+    fastled_bench_t *fastled = arg;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        fastled->set.fill_rainbow(&fastled->set, (uint8_t)i, 3);
+    }
+    bench_clobber(fastled->leds);
+}
+
+static void bench_set_nscale8(void *arg, uint64_t iterations)
+{
+    fastled_bench_t *fastled = arg;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        fastled->set.nscale8(&fastled->set, 250);
+    }
+    bench_clobber(fastled->leds);
+}
+
+static void bench_blend(void *arg, uint64_t iterations)
+{
+    fastled_bench_t *fastled = arg;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        blend_leds(fastled->leds, fastled->overlay, fastled->leds, fastled->set.length, 128);
+    }
+    bench_clobber(fastled->leds);
+}
+
+// blur2d_leds() on rows of up to 64 LEDs, using overlay as the scratch row
+static void bench_blur2d(void *arg, uint64_t iterations)
+{
+    fastled_bench_t *fastled = arg;
+    uint16_t width = (fastled->set.length < 64) ? fastled->set.length : 64;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        blur2d_leds(fastled->leds, width, fastled->set.length / width, 64, fastled->overlay);
+    }
+    bench_clobber(fastled->leds);
+}
+
+// Reference kernels: one byte at a time, never in place
+
+static CRGB ref_scale(CRGB led, uint8_t scale)
+{
+    CRGB result = 0;
+
+    for (int n = 0; n < 4; n++)
+    {
+        result |= (CRGB)scale8((led >> (n * 8)) & 0xff, scale) << (n * 8);
+    }
+    return result;
+}
+
+static CRGB ref_blend(CRGB a, CRGB b, uint8_t amountOfB)
+{
+    CRGB result = 0;
+
+    // 0 and 255 are copies rather than blend8(), see blend_leds()
+    if (amountOfB == 0 || amountOfB == 255)
+    {
+        return (amountOfB == 0) ? a : b;
+    }
+
+    for (int n = 0; n < 4; n++)
+    {
+        result |= (CRGB)blend8((a >> (n * 8)) & 0xff, (b >> (n * 8)) & 0xff, amountOfB) << (n * 8);
+    }
+    return result;
+}
+
+// Blur count LEDs stride apart from in to out
+static void ref_blur(const CRGB *in, CRGB *out, uint16_t count, uint32_t stride, uint8_t blur_amount)
+{
+    uint8_t keep = 255 - blur_amount;
+    uint8_t seep = blur_amount >> 1;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        CRGB cur = in[i * stride];
+        CRGB prev = (i > 0) ? in[(i - 1) * stride] : 0;
+        CRGB next = (i + 1 < count) ? in[(i + 1) * stride] : 0;
+        CRGB result = 0;
+
+        for (int n = 0; n < 4; n++)
+        {
+            uint8_t c = scale8((cur >> (n * 8)) & 0xff, keep);
+
+            c = qadd8(c, scale8((prev >> (n * 8)) & 0xff, seep));
+            c = qadd8(c, scale8((next >> (n * 8)) & 0xff, seep));
+            result |= (CRGB)c << (n * 8);
+        }
+        out[i * stride] = result;
+    }
+}
+
+typedef struct
+{
+    CRGB *input;     // random frame
+    CRGB *overlay;   // second random frame
+    CRGB *actual;    // run through the library
+    CRGB *expected;  // run through the reference
+    CRGB *temp;      // reference intermediate, blur2d scratch row
+    unsigned seed;
+    unsigned cases;
+    unsigned mismatches;
+} fastled_check_t;
+
+#define CHECK_BUFFER_PIXELS (CHECK_MAX_PIXELS + CHECK_GUARD_PIXELS)
+
+// New random frames; actual and expected start equal so the guard LEDs
+// past the end catch kernels that write too far
+static void check_fill(fastled_check_t *check)
+{
+    for (unsigned i = 0; i < CHECK_BUFFER_PIXELS; i++)
+    {
+        check->input[i] = ((CRGB)rand_r(&check->seed) << 16) ^ (CRGB)rand_r(&check->seed);
+        check->overlay[i] = ((CRGB)rand_r(&check->seed) << 16) ^ (CRGB)rand_r(&check->seed);
+    }
+    memcpy(check->actual, check->input, CHECK_BUFFER_PIXELS * sizeof(CRGB));
+    memcpy(check->expected, check->input, CHECK_BUFFER_PIXELS * sizeof(CRGB));
+}
+
+static void check_compare(fastled_check_t *check)
+{
+    check->cases++;
+    if (memcmp(check->actual, check->expected, CHECK_BUFFER_PIXELS * sizeof(CRGB)) != 0)
+    {
+        check->mismatches++;
+    }
+}
+
+static int check_done(fastled_check_t *check, const char *name)
+{
+    int result = bench_check("mini_fastled", name, check->cases, check->mismatches);
+
+    check->cases = 0;
+    check->mismatches = 0;
+    return result;
+}
+
+static int check_kernels(fastled_check_t *check)
+{
+    const unsigned n_counts = sizeof(check_counts) / sizeof(check_counts[0]);
+    const unsigned n_amounts = sizeof(check_amounts) / sizeof(check_amounts[0]);
+    int result = BENCH_SUCCESS;
+
+    for (unsigned c = 0; c < n_counts; c++)
+    {
+        for (unsigned a = 0; a < n_amounts; a++)
+        {
+            uint16_t count = check_counts[c];
+            uint8_t amount = check_amounts[a];
+
+            check_fill(check);
+            nscale8_leds(check->actual, count, amount);
+            for (unsigned i = 0; i < count; i++)
+            {
+                check->expected[i] = ref_scale(check->input[i], amount);
+            }
+            check_compare(check);
+        }
+    }
+    result |= check_done(check, "nscale8_leds");
+
+    for (unsigned c = 0; c < n_counts; c++)
+    {
+        for (unsigned a = 0; a < n_amounts; a++)
+        {
+            uint16_t count = check_counts[c];
+            uint8_t amount = check_amounts[a];
+
+            check_fill(check);
+            fadeToBlackBy_leds(check->actual, count, amount);
+            for (unsigned i = 0; i < count; i++)
+            {
+                check->expected[i] = ref_scale(check->input[i], 255 - amount);
+            }
+            check_compare(check);
+        }
+    }
+    result |= check_done(check, "fadeToBlackBy_leds");
+
+    // In place, then into a separate destination
+    for (unsigned c = 0; c < n_counts; c++)
+    {
+        for (unsigned a = 0; a < n_amounts; a++)
+        {
+            uint16_t count = check_counts[c];
+            uint8_t amount = check_amounts[a];
+
+            check_fill(check);
+            nblend_leds(check->actual, check->overlay, count, amount);
+            for (unsigned i = 0; i < count; i++)
+            {
+                check->expected[i] = ref_blend(check->input[i], check->overlay[i], amount);
+            }
+            check_compare(check);
+
+            check_fill(check);
+            blend_leds(check->overlay, check->input, check->actual, count, amount);
+            for (unsigned i = 0; i < count; i++)
+            {
+                check->expected[i] = ref_blend(check->overlay[i], check->input[i], amount);
+            }
+            check_compare(check);
+        }
+    }
+    result |= check_done(check, "blend_leds");
+
+    for (unsigned c = 0; c < n_counts; c++)
+    {
+        for (unsigned a = 0; a < n_amounts; a++)
+        {
+            uint16_t count = check_counts[c];
+            uint8_t amount = check_amounts[a];
+
+            check_fill(check);
+            blur1d_leds(check->actual, count, amount);
+            ref_blur(check->input, check->expected, count, 1, amount);
+            check_compare(check);
+        }
+    }
+    result |= check_done(check, "blur1d_leds");
+
+    // Rows, then columns of the blurred rows
+    for (unsigned w = 0; w < sizeof(check_widths) / sizeof(check_widths[0]); w++)
+    {
+        for (unsigned h = 0; h < sizeof(check_heights) / sizeof(check_heights[0]); h++)
+        {
+            for (unsigned a = 0; a < n_amounts; a++)
+            {
+                uint16_t width = check_widths[w];
+                uint16_t height = check_heights[h];
+                uint8_t amount = check_amounts[a];
+
+                check_fill(check);
+                for (uint16_t y = 0; y < height; y++)
+                {
+                    ref_blur(&check->input[y * width], &check->temp[y * width], width, 1, amount);
+                }
+                for (uint16_t x = 0; x < width; x++)
+                {
+                    ref_blur(&check->temp[x], &check->expected[x], height, width, amount);
+                }
+                blur2d_leds(check->actual, width, height, amount, check->temp);
+                check_compare(check);
+            }
+        }
+    }
+    result |= check_done(check, "blur2d_leds");
+
+    return result;
+}
+
+static void run_counts(fastled_bench_t *fastled, const char *name, bench_fn_t fn)
+{
+    if (!bench_selected(name))
+    {
+        return;
+    }
+
+    for (unsigned i = 0; i < sizeof(pixel_counts) / sizeof(pixel_counts[0]); i++)
+    {
+        bench_case_t bench = {
+            .library = "mini_fastled",
+            .name = name,
+            .param = "pixels",
+            .value = pixel_counts[i],
+            .items_per_op = pixel_counts[i],
+            .unit = "pixels"};
+
+        // Start every benchmark from the same frame
+        for (unsigned j = 0; j < pixel_counts[i]; j++)
+        {
+            fastled->leds[j] = (CRGB)(j * 0x01030507u);
+            fastled->overlay[j] = (CRGB)(j * 0x07050301u);
+        }
+
+        fastled->set.length = pixel_counts[i];
+        bench_run(&bench, fn, fastled);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    CRGBArray(BENCH_FASTLED_MAX_PIXELS, set);
+    fastled_bench_t fastled;
+    fastled_check_t check = {.seed = CHECK_SEED};
+    int result;
+    int opt;
+
+    while ((opt = getopt(argc, argv, BENCH_OPTIONS)) != -1)
+    {
+        if (bench_parse_option(opt, optarg) != BENCH_SUCCESS)
+        {
+            bench_usage(argv[0], NULL);
+            return EXIT_FAILURE;
+        }
+    }
+
+    fastled.leds = malloc(BENCH_FASTLED_MAX_PIXELS * sizeof(CRGB));
+    fastled.overlay = malloc(BENCH_FASTLED_MAX_PIXELS * sizeof(CRGB));
+    check.input = malloc(CHECK_BUFFER_PIXELS * sizeof(CRGB));
+    check.overlay = malloc(CHECK_BUFFER_PIXELS * sizeof(CRGB));
+    check.actual = malloc(CHECK_BUFFER_PIXELS * sizeof(CRGB));
+    check.expected = malloc(CHECK_BUFFER_PIXELS * sizeof(CRGB));
+    check.temp = malloc(CHECK_BUFFER_PIXELS * sizeof(CRGB));
+    if (!fastled.leds || !fastled.overlay || !check.input || !check.overlay || !check.actual || !check.expected ||
+        !check.temp)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    result = check_kernels(&check);
+    free(check.input);
+    free(check.overlay);
+    free(check.actual);
+    free(check.expected);
+    free(check.temp);
+    if (result != BENCH_SUCCESS)
+    {
+        fprintf(stderr, "Bulk kernels do not match the reference\n");
+        free(fastled.leds);
+        free(fastled.overlay);
+        return EXIT_FAILURE;
+    }
+
+    fastled.set = set;
+    fastled.set.leds = fastled.leds;
+
+    run_counts(&fastled, "nscale8_leds", bench_nscale8);
+    run_counts(&fastled, "fadeToBlackBy_leds", bench_fade_to_black);
+    run_counts(&fastled, "nblend_leds", bench_nblend);
+    run_counts(&fastled, "blend_leds", bench_blend);
+    run_counts(&fastled, "blur1d_leds", bench_blur1d);
+    run_counts(&fastled, "blur2d_leds", bench_blur2d);
+    run_counts(&fastled, "napplyGamma_video", bench_gamma);
+    run_counts(&fastled, "fill_rainbow", bench_fill_rainbow);
+    run_counts(&fastled, "pixelset_nscale8", bench_set_nscale8);
+
+    free(fastled.leds);
+    free(fastled.overlay);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * rpi_gpio toggles/s through the resource manager, the bulk mask message
+ * and direct register access. The default pin is the red LED on the
+ * Rainbow HAT. On a host build MsgSend() returns straight away and direct
+ * access is reported as skipped.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/neutrino.h>
+
+#include "bench.h"
+#include "rpi_gpio.h"
+
+#define BENCH_GPIO_DEFAULT_PIN 6
+
+typedef struct
+{
+    int pin;
+    int failed;
+} gpio_bench_t;
+
+static void bench_output(void *arg, uint64_t iterations)
+{
+    gpio_bench_t *gpio = arg;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        gpio->failed |= rpi_gpio_output(gpio->pin, (i & 1) ? GPIO_LOW : GPIO_HIGH);
+    }
+}
+
+static void bench_output_mask(void *arg, uint64_t iterations)
+{
+    gpio_bench_t *gpio = arg;
+    const uint32_t mask = GPIO_MASK(gpio->pin);
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        gpio->failed |= rpi_gpio_output_mask(mask, (i & 1) ? 0 : mask);
+    }
+}
+
+static void run_toggle(gpio_bench_t *gpio, const char *name, bench_fn_t fn)
+{
+    bench_case_t bench = {
+        .library = "rpi_gpio",
+        .name = name,
+        .items_per_op = 1,
+        .unit = "toggles"};
+
+    if (!bench_selected(name))
+    {
+        return;
+    }
+
+    // One toggle first, so a missing resource manager is reported instead of timed
+    gpio->failed = GPIO_SUCCESS;
+    fn(gpio, 1);
+    if (gpio->failed != GPIO_SUCCESS)
+    {
+        bench_skip(&bench, "output failed");
+        return;
+    }
+
+    bench_run(&bench, fn, gpio);
+}
+
+int main(int argc, char *argv[])
+{
+    gpio_bench_t gpio = {
+        .pin = BENCH_GPIO_DEFAULT_PIN};
+    bench_case_t direct = {
+        .library = "rpi_gpio",
+        .name = "output_direct",
+        .items_per_op = 1,
+        .unit = "toggles"};
+    int opt;
+
+    while ((opt = getopt(argc, argv, BENCH_OPTIONS "p:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'p':
+            gpio.pin = strtol(optarg, NULL, 0);
+            break;
+        default:
+            if (bench_parse_option(opt, optarg) != BENCH_SUCCESS)
+            {
+                bench_usage(argv[0], "[-p pin]");
+                return EXIT_FAILURE;
+            }
+            break;
+        }
+    }
+
+    if (rpi_gpio_setup(gpio.pin, GPIO_OUT) != GPIO_SUCCESS)
+    {
+        fprintf(stderr, "Failed to set up GPIO %d as an output\n", gpio.pin);
+        return EXIT_FAILURE;
+    }
+
+    run_toggle(&gpio, "output", bench_output);
+    run_toggle(&gpio, "output_mask", bench_output_mask);
+
+    // Same calls again, now a register store instead of a message
+    if (bench_selected(direct.name))
+    {
+        if (rpi_gpio_set_direct_access(GPIO_MASK(gpio.pin)) == GPIO_SUCCESS)
+        {
+            run_toggle(&gpio, direct.name, bench_output);
+            rpi_gpio_set_direct_access(0);
+        }
+        else
+        {
+            bench_skip(&direct, "registers not mapped");
+        }
+    }
+
+    rpi_gpio_output(gpio.pin, GPIO_LOW);
+    rpi_gpio_cleanup();
+
+    return EXIT_SUCCESS;
+}
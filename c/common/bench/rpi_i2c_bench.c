@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * rpi_i2c transactions/s for register block reads of each size. The
+ * default target is the BMP280 on the Rainbow HAT, whose chip id register
+ * is always readable. On a host build every read returns zeros.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "rpi_i2c.h"
+
+#define BENCH_I2C_DEFAULT_BUS 1
+#define BENCH_I2C_DEFAULT_ADDRESS 0x77
+#define BENCH_I2C_DEFAULT_REGISTER 0xD0
+#define BENCH_I2C_TRANSACTION_READS 4
+
+static const uint8_t block_sizes[] = {1, 2, 8, 16, 32};
+
+typedef struct
+{
+    unsigned bus;
+    uint8_t address;
+    uint8_t register_val;
+    uint8_t size;
+    uint8_t buffer[UINT8_MAX];
+    smbus_transaction_t reads[BENCH_I2C_TRANSACTION_READS];
+    int failed;
+} i2c_bench_t;
+
+static void bench_read_block_data(void *arg, uint64_t iterations)
+{
+    i2c_bench_t *i2c = arg;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        i2c->failed |= smbus_read_block_data(i2c->bus, i2c->address, i2c->register_val, i2c->buffer, i2c->size);
+    }
+    bench_clobber(i2c->buffer);
+}
+
+static void bench_transaction(void *arg, uint64_t iterations)
+{
+    i2c_bench_t *i2c = arg;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        i2c->failed |= smbus_transaction(i2c->bus, i2c->reads, BENCH_I2C_TRANSACTION_READS);
+    }
+    bench_clobber(i2c->buffer);
+}
+
+static void run_sizes(i2c_bench_t *i2c, const char *name, bench_fn_t fn, double transactions)
+{
+    if (!bench_selected(name))
+    {
+        return;
+    }
+
+    for (unsigned i = 0; i < sizeof(block_sizes) / sizeof(block_sizes[0]); i++)
+    {
+        bench_case_t bench = {
+            .library = "rpi_i2c",
+            .name = name,
+            .param = "bytes",
+            .value = block_sizes[i],
+            .items_per_op = transactions,
+            .unit = "transactions"};
+
+        // Separate reads of the same registers, so none of them can be merged
+        for (unsigned j = 0; j < BENCH_I2C_TRANSACTION_READS; j++)
+        {
+            i2c->reads[j] = (smbus_transaction_t){
+                .i2c_address = i2c->address,
+                .op = SMBUS_TRANSACTION_READ,
+                .register_val = i2c->register_val,
+                .buffer = i2c->buffer + j * block_sizes[i],
+                .size = block_sizes[i]};
+        }
+
+        // One transaction first, so a missing device is reported instead of timed
+        i2c->size = block_sizes[i];
+        i2c->failed = I2C_SUCCESS;
+        fn(i2c, 1);
+        if (i2c->failed != I2C_SUCCESS)
+        {
+            bench_skip(&bench, "transaction failed");
+            continue;
+        }
+
+        bench_run(&bench, fn, i2c);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    i2c_bench_t i2c = {
+        .bus = BENCH_I2C_DEFAULT_BUS,
+        .address = BENCH_I2C_DEFAULT_ADDRESS,
+        .register_val = BENCH_I2C_DEFAULT_REGISTER};
+    int opt;
+
+    while ((opt = getopt(argc, argv, BENCH_OPTIONS "b:a:g:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            i2c.bus = strtoul(optarg, NULL, 0);
+            break;
+        case 'a':
+            i2c.address = strtoul(optarg, NULL, 0);
+            break;
+        case 'g':
+            i2c.register_val = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            if (bench_parse_option(opt, optarg) != BENCH_SUCCESS)
+            {
+                bench_usage(argv[0], "[-b bus] [-a address] [-g register]");
+                return EXIT_FAILURE;
+            }
+            break;
+        }
+    }
+
+    run_sizes(&i2c, "read_block_data", bench_read_block_data, 1);
+    run_sizes(&i2c, "transaction", bench_transaction, BENCH_I2C_TRANSACTION_READS);
+
+    smbus_cleanup(i2c.bus);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * rpi_spi throughput: bytes/s for each transfer size and the per-call
+ * overhead, which is the 1 byte case. On a host build the driver is the
+ * loopback in host/qnx_host.c, so only the library's own cost is measured.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "rpi_spi.h"
+
+#define BENCH_SPI_DEFAULT_BUS 0
+#define BENCH_SPI_DEFAULT_DEVICE 0
+#define BENCH_SPI_DEFAULT_SPEED_HZ 4000000
+#define BENCH_SPI_DEVICE_MODE 0b00010000010000001000 // mode 0, 8-bit words
+
+#define BENCH_SPI_MAX_BYTES 16384
+#define BENCH_SPI_BATCH 16
+
+static const uint32_t transfer_sizes[] = {1, 16, 64, 256, 1024, 4096, BENCH_SPI_MAX_BYTES};
+
+typedef struct
+{
+    unsigned bus;
+    unsigned device;
+    uint32_t size;
+    uint8_t *write_buffer;
+    uint8_t *read_buffer;
+    rpi_spi_transfer_t batch[BENCH_SPI_BATCH];
+    int failed;
+} spi_bench_t;
+
+static void bench_write_read(void *arg, uint64_t iterations)
+{
+    spi_bench_t *spi = arg;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        spi->failed |= rpi_spi_write_read_data(spi->bus, spi->device, spi->write_buffer, spi->read_buffer, spi->size);
+    }
+    bench_clobber(spi->read_buffer);
+}
+
+static void bench_write(void *arg, uint64_t iterations)
+{
+    spi_bench_t *spi = arg;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        spi->failed |= rpi_spi_write_read_data(spi->bus, spi->device, spi->write_buffer, NULL, spi->size);
+    }
+}
+
+static void bench_batch(void *arg, uint64_t iterations)
+{
+    spi_bench_t *spi = arg;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        spi->failed |= rpi_spi_write_read_batch(spi->bus, spi->device, spi->batch, BENCH_SPI_BATCH);
+    }
+    bench_clobber(spi->read_buffer);
+}
+
+static void bench_exchange(void *arg, uint64_t iterations)
+{
+    spi_bench_t *spi = arg;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        spi->failed |= rpi_spi_exchange(spi->bus, spi->device, spi->size);
+    }
+}
+
+// Run one benchmark per transfer size; batches split the size over BENCH_SPI_BATCH transfers
+static void run_sizes(spi_bench_t *spi, const char *name, bench_fn_t fn)
+{
+    if (!bench_selected(name))
+    {
+        return;
+    }
+
+    for (unsigned i = 0; i < sizeof(transfer_sizes) / sizeof(transfer_sizes[0]); i++)
+    {
+        bench_case_t bench = {
+            .library = "rpi_spi",
+            .name = name,
+            .param = "bytes",
+            .value = transfer_sizes[i],
+            .items_per_op = transfer_sizes[i],
+            .unit = "bytes"};
+
+        if (fn == bench_batch)
+        {
+            const uint32_t part = transfer_sizes[i] / BENCH_SPI_BATCH;
+
+            if (part == 0)
+            {
+                continue;
+            }
+
+            for (unsigned j = 0; j < BENCH_SPI_BATCH; j++)
+            {
+                spi->batch[j].write_data_buffer = spi->write_buffer + j * part;
+                spi->batch[j].read_data_buffer = spi->read_buffer + j * part;
+                spi->batch[j].data_size = part;
+            }
+        }
+
+        if ((fn == bench_exchange) && !rpi_spi_get_exchange_buffer(spi->bus, spi->device, transfer_sizes[i]))
+        {
+            bench_skip(&bench, "no exchange buffer");
+            continue;
+        }
+
+        // One transfer first, so a missing device is reported instead of timed
+        spi->size = transfer_sizes[i];
+        spi->failed = SPI_SUCCESS;
+        fn(spi, 1);
+        if (spi->failed != SPI_SUCCESS)
+        {
+            bench_skip(&bench, "transfer failed");
+            continue;
+        }
+
+        bench_run(&bench, fn, spi);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    spi_bench_t spi = {
+        .bus = BENCH_SPI_DEFAULT_BUS,
+        .device = BENCH_SPI_DEFAULT_DEVICE};
+    uint32_t speed_hz = BENCH_SPI_DEFAULT_SPEED_HZ;
+    int opt;
+
+    while ((opt = getopt(argc, argv, BENCH_OPTIONS "b:d:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            spi.bus = strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            spi.device = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            speed_hz = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            if (bench_parse_option(opt, optarg) != BENCH_SUCCESS)
+            {
+                bench_usage(argv[0], "[-b bus] [-d device] [-s speed_hz]");
+                return EXIT_FAILURE;
+            }
+            break;
+        }
+    }
+
+    if (rpi_spi_configure_device(spi.bus, spi.device, BENCH_SPI_DEVICE_MODE, speed_hz) != SPI_SUCCESS)
+    {
+        fprintf(stderr, "Failed to configure SPI%u device %u\n", spi.bus, spi.device);
+        return EXIT_FAILURE;
+    }
+
+    spi.write_buffer = malloc(BENCH_SPI_MAX_BYTES);
+    spi.read_buffer = malloc(BENCH_SPI_MAX_BYTES);
+    if (!spi.write_buffer || !spi.read_buffer)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    for (unsigned i = 0; i < BENCH_SPI_MAX_BYTES; i++)
+    {
+        spi.write_buffer[i] = (uint8_t)i;
+    }
+
+    run_sizes(&spi, "write_read_data", bench_write_read);
+    run_sizes(&spi, "write_data", bench_write);
+    run_sizes(&spi, "write_read_batch", bench_batch);
+    run_sizes(&spi, "exchange", bench_exchange);
+
+    rpi_spi_cleanup_device(spi.bus, spi.device);
+    free(spi.write_buffer);
+    free(spi.read_buffer);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * ws2811_render cost against strip length. The encode runs on the calling
+ * thread and the SPI transfer on the channel's transmit thread, so
+ * cpu_ns_per_op is the encode time and wall_ns_per_op the frame period,
+ * which includes the bus time and the reset latch. On a host build the bus
+ * is the loopback in host/qnx_host.c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "rpi_ws281x.h"
+
+#define BENCH_WS281X_BRIGHTNESS 32
+#define BENCH_WS281X_CHANNEL_LEDS 300
+
+static const int strip_lengths[] = {8, 60, 144, 300, 600, 1200};
+static const int channel_pins[LED_STRIP_CHANNELS] = {LED_CHANNEL_0_DATA_PIN, LED_CHANNEL_1_DATA_PIN,
+                                                     LED_CHANNEL_2_DATA_PIN};
+
+typedef struct
+{
+    ws2811_t ws2811;
+    int channels;
+    int failed;
+} ws281x_bench_t;
+
+static void bench_render(void *arg, uint64_t iterations)
+{
+    ws281x_bench_t *strip = arg;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        // Change the frame so every render encodes new data
+        for (int chan = 0; chan < strip->channels; chan++)
+        {
+            strip->ws2811.channel[chan].leds[0] = (ws2811_led_t)i;
+        }
+
+        strip->failed |= ws2811_render(&strip->ws2811);
+    }
+}
+
+static void run_strip(const char *name, const char *param, uint64_t value, int channels, int count, int strip_type)
+{
+    ws281x_bench_t strip;
+    ws2811_return_t ret;
+    bench_case_t bench = {
+        .library = "rpi_ws281x",
+        .name = name,
+        .param = param,
+        .value = value,
+        .items_per_op = (double)count * channels,
+        .unit = "leds"};
+
+    if (!bench_selected(name))
+    {
+        return;
+    }
+
+    memset(&strip, 0, sizeof(strip));
+    strip.channels = channels;
+    strip.ws2811.freq = WS2811_TARGET_FREQ;
+    for (int chan = 0; chan < LED_STRIP_CHANNELS; chan++)
+    {
+        strip.ws2811.channel[chan].gpionum = (chan < channels) ? channel_pins[chan] : -1;
+        strip.ws2811.channel[chan].count = (chan < channels) ? count : 0;
+        strip.ws2811.channel[chan].strip_type = strip_type;
+        strip.ws2811.channel[chan].brightness = BENCH_WS281X_BRIGHTNESS;
+    }
+
+    if ((ret = ws2811_init(&strip.ws2811)) != WS2811_SUCCESS)
+    {
+        bench_skip(&bench, ws2811_get_return_t_str(ret));
+        return;
+    }
+
+    for (int chan = 0; chan < channels; chan++)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            strip.ws2811.channel[chan].leds[i] = (ws2811_led_t)(i * 0x01030507u);
+        }
+    }
+
+    // One frame first, so a missing bus is reported instead of timed
+    bench_render(&strip, 1);
+    if (strip.failed != WS2811_SUCCESS)
+    {
+        bench_skip(&bench, ws2811_get_return_t_str(strip.failed));
+    }
+    else
+    {
+        bench_run(&bench, bench_render, &strip);
+    }
+
+    ws2811_fini(&strip.ws2811);
+}
+
+int main(int argc, char *argv[])
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, BENCH_OPTIONS)) != -1)
+    {
+        if (bench_parse_option(opt, optarg) != BENCH_SUCCESS)
+        {
+            bench_usage(argv[0], NULL);
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (unsigned i = 0; i < sizeof(strip_lengths) / sizeof(strip_lengths[0]); i++)
+    {
+        run_strip("render", "leds", strip_lengths[i], 1, strip_lengths[i], WS2812_STRIP);
+    }
+
+    for (unsigned i = 0; i < sizeof(strip_lengths) / sizeof(strip_lengths[0]); i++)
+    {
+        run_strip("render_rgbw", "leds", strip_lengths[i], 1, strip_lengths[i], SK6812W_STRIP);
+    }
+
+    // The channels encode back to back and send in parallel
+    for (int channels = 1; channels <= LED_STRIP_CHANNELS; channels++)
+    {
+        run_strip("render_channels", "channels", channels, channels, BENCH_WS281X_CHANNEL_LEDS, WS2812_STRIP);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -18,8 +18,14 @@
 
 #include <stdint.h>
 #include <math.h>
+#include <string.h>
+#include <pthread.h>
 #include "mini_fastled.h"
 
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 /// Utility functions for color fill, palettes, blending, and more
 /*
 #include "fl/xymap.h"
@@ -348,7 +354,7 @@ CRGB& nblend( CRGB& existing, const CRGB& overlay, fract8 amountOfOverlay )
 
 
 
-void nblend( CRGB* existing, CRGB* overlay, uint16_t count, fract8 amountOfOverlay)
+void nblend( CRGB* existing, CRGB* overlay, uint16_t count, uint8_t amountOfOverlay)
 {
     for( uint16_t i = count; i; --i) {
         nblend( *existing, *overlay, amountOfOverlay);
@@ -464,7 +470,7 @@ CHSV* blend( const CHSV* src1, const CHSV* src2, CHSV* dest, uint16_t count, fra
 //         calls to 'blur' will also result in the light fading,
 //         eventually all the way to black; this is by design so that
 //         it can be used to (slowly) clear the LEDs to black.
-void blur1d( CRGB* leds, uint16_t numLeds, fract8 blur_amount)
+void blur1d( CRGB* leds, uint16_t numLeds, uint8_t blur_amount)
 {
     uint8_t keep = 255 - blur_amount;
     uint8_t seep = blur_amount >> 1;
@@ -487,7 +493,7 @@ void blur2d( CRGB* leds, uint8_t width, uint8_t height, fract8 blur_amount, cons
     blurColumns(leds, width, height, blur_amount, xymap);
 }
 
-void blur2d( CRGB* leds, uint8_t width, uint8_t height, fract8 blur_amount)
+void blur2d( CRGB* leds, uint8_t width, uint8_t height, uint8_t blur_amount)
 {
     XYMap xy = XYMap::constructWithUserFunction(width, height, xy_legacy_wrapper);
     blur2d(leds, width, height, blur_amount, xy);
@@ -1465,3 +1471,354 @@ void napplyGamma_video( CRGB* rgbarray, uint16_t count, float gammaR, float gamm
 }
 
 */
+
+/// Bulk colour functions.
+/// These treat an LED as four independent bytes, so the white channel is
+/// scaled/blended along with red, green and blue. On aarch64 they use NEON
+/// and work on 16 LEDs (four q registers) per iteration; the scalar code
+/// handles the tail and other targets and gives bit-identical results.
+
+/// Apply an 8-bit operation to each of the four bytes of an LED
+#define LED_BYTE(led, n) (((led) >> ((n) * 8)) & 0xff)
+
+static inline CRGB scale_led(CRGB led, uint8_t scale)
+{
+    CRGB result = 0;
+
+    for (int n = 0; n < 4; n++)
+    {
+        result |= (CRGB)scale8(LED_BYTE(led, n), scale) << (n * 8);
+    }
+    return result;
+}
+
+static inline CRGB qadd_led(CRGB a, CRGB b)
+{
+    CRGB result = 0;
+
+    for (int n = 0; n < 4; n++)
+    {
+        result |= (CRGB)qadd8(LED_BYTE(a, n), LED_BYTE(b, n)) << (n * 8);
+    }
+    return result;
+}
+
+static inline CRGB blend_led(CRGB a, CRGB b, uint8_t amountOfB)
+{
+    CRGB result = 0;
+
+    for (int n = 0; n < 4; n++)
+    {
+        result |= (CRGB)blend8(LED_BYTE(a, n), LED_BYTE(b, n), amountOfB) << (n * 8);
+    }
+    return result;
+}
+
+// Blur tap: keep of the LED itself plus seep of each of its two neighbours
+static inline CRGB blur_led(CRGB cur, CRGB a, CRGB b, uint8_t keep, uint8_t seep)
+{
+    return qadd_led(qadd_led(scale_led(cur, keep), scale_led(a, seep)), scale_led(b, seep));
+}
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define BULK_LEDS 16
+#define BULK_REGS 4
+
+// scale8() on 16 bytes
+static inline uint8x16_t vscale8q(uint8x16_t v, uint8x8_t scale)
+{
+    return vcombine_u8(vshrn_n_u16(vmull_u8(vget_low_u8(v), scale), 8),
+                       vshrn_n_u16(vmull_u8(vget_high_u8(v), scale), 8));
+}
+
+// blend8() on 16 bytes
+static inline uint8x16_t vblend8q(uint8x16_t a, uint8x16_t b, uint8x8_t amountOfA, uint8x8_t amountOfB)
+{
+    return vcombine_u8(vshrn_n_u16(vmlal_u8(vmull_u8(vget_low_u8(a), amountOfA), vget_low_u8(b), amountOfB), 8),
+                       vshrn_n_u16(vmlal_u8(vmull_u8(vget_high_u8(a), amountOfA), vget_high_u8(b), amountOfB), 8));
+}
+
+// blur_led() on 16 bytes
+static inline uint8x16_t vblurq(uint8x16_t cur, uint8x16_t a, uint8x16_t b, uint8x8_t keep, uint8x8_t seep)
+{
+    return vqaddq_u8(vqaddq_u8(vscale8q(cur, keep), vscale8q(a, seep)), vscale8q(b, seep));
+}
+#endif
+
+void nscale8_leds(CRGB *leds, uint16_t num_leds, uint8_t scale)
+{
+    uint16_t i = 0;
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    uint8x8_t vscale = vdup_n_u8(scale);
+
+    for (; i + BULK_LEDS <= num_leds; i += BULK_LEDS)
+    {
+        uint8_t *bytes = (uint8_t *)&leds[i];
+
+        for (int r = 0; r < BULK_REGS; r++)
+        {
+            vst1q_u8(bytes + (r * 16), vscale8q(vld1q_u8(bytes + (r * 16)), vscale));
+        }
+    }
+#endif
+
+    for (; i < num_leds; i++)
+    {
+        leds[i] = scale_led(leds[i], scale);
+    }
+}
+
+void fadeToBlackBy_leds(CRGB *leds, uint16_t num_leds, uint8_t fadeBy)
+{
+    nscale8_leds(leds, num_leds, 255 - fadeBy);
+}
+
+void blend_leds(const CRGB *src1, const CRGB *src2, CRGB *dest, uint16_t count, uint8_t amountOfsrc2)
+{
+    uint16_t i = 0;
+
+    // The end points are exact copies, as with nblend() on a single LED
+    if (amountOfsrc2 == 0)
+    {
+        memmove(dest, src1, count * sizeof(CRGB));
+        return;
+    }
+
+    if (amountOfsrc2 == 255)
+    {
+        memmove(dest, src2, count * sizeof(CRGB));
+        return;
+    }
+
+    // dest may be either source: every block is loaded before it is stored
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    uint8x8_t amountOfA = vdup_n_u8(255 - amountOfsrc2);
+    uint8x8_t amountOfB = vdup_n_u8(amountOfsrc2);
+
+    for (; i + BULK_LEDS <= count; i += BULK_LEDS)
+    {
+        const uint8_t *a = (const uint8_t *)&src1[i];
+        const uint8_t *b = (const uint8_t *)&src2[i];
+        uint8_t *d = (uint8_t *)&dest[i];
+
+        for (int r = 0; r < BULK_REGS; r++)
+        {
+            vst1q_u8(d + (r * 16), vblend8q(vld1q_u8(a + (r * 16)), vld1q_u8(b + (r * 16)), amountOfA, amountOfB));
+        }
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        dest[i] = blend_led(src1[i], src2[i], amountOfsrc2);
+    }
+}
+
+void nblend_leds(CRGB *existing, const CRGB *overlay, uint16_t count, uint8_t amountOfOverlay)
+{
+    blend_leds(existing, overlay, existing, count, amountOfOverlay);
+}
+
+void blur1d_leds(CRGB *leds, uint16_t numLeds, uint8_t blur_amount)
+{
+    uint8_t keep = 255 - blur_amount;
+    uint8_t seep = blur_amount >> 1;
+    // original (unblurred) value of the LED before the current one
+    CRGB prev = 0;
+    uint16_t i = 0;
+
+    // Each LED keeps 'keep' of itself and gets 'seep' of both neighbours.
+    // Only original values are used, so blocks can be done independently
+    // as long as the previous LED is remembered before it is overwritten.
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    uint8x8_t vkeep = vdup_n_u8(keep);
+    uint8x8_t vseep = vdup_n_u8(seep);
+
+    for (; i + BULK_LEDS <= numLeds; i += BULK_LEDS)
+    {
+        uint8_t *bytes = (uint8_t *)&leds[i];
+        uint8x16_t cur[BULK_REGS + 2];
+
+        // cur[0] lane 3 is the previous LED, cur[BULK_REGS + 1] lane 0 the next one
+        cur[0] = vreinterpretq_u8_u32(vdupq_n_u32(prev));
+        for (int r = 0; r < BULK_REGS; r++)
+        {
+            cur[r + 1] = vld1q_u8(bytes + (r * 16));
+        }
+        cur[BULK_REGS + 1] = vreinterpretq_u8_u32(vdupq_n_u32((i + BULK_LEDS < numLeds) ? leds[i + BULK_LEDS] : 0));
+        prev = leds[i + BULK_LEDS - 1];
+
+        for (int r = 1; r <= BULK_REGS; r++)
+        {
+            uint8x16_t left = vextq_u8(cur[r - 1], cur[r], 12);
+            uint8x16_t right = vextq_u8(cur[r], cur[r + 1], 4);
+
+            vst1q_u8(bytes + ((r - 1) * 16), vblurq(cur[r], left, right, vkeep, vseep));
+        }
+    }
+#endif
+
+    for (; i < numLeds; i++)
+    {
+        CRGB cur = leds[i];
+        CRGB next = (i + 1 < numLeds) ? leds[i + 1] : 0;
+
+        leds[i] = blur_led(cur, prev, next, keep, seep);
+        prev = cur;
+    }
+}
+
+void blur2d_leds(CRGB *leds, uint16_t width, uint16_t height, uint8_t blur_amount, CRGB *scratch)
+{
+    uint8_t keep = 255 - blur_amount;
+    uint8_t seep = blur_amount >> 1;
+
+    // rows are contiguous
+    for (uint16_t y = 0; y < height; y++)
+    {
+        blur1d_leds(&leds[(uint32_t)y * width], width, blur_amount);
+    }
+
+    // Columns a whole row at a time: the neighbours of an LED are the LEDs at
+    // the same x in the rows above and below, so rows are blurred as vectors.
+    // scratch holds the original of the row above once it has been overwritten.
+    memset(scratch, 0, width * sizeof(CRGB));
+
+    for (uint16_t y = 0; y < height; y++)
+    {
+        CRGB *row = &leds[(uint32_t)y * width];
+        const CRGB *below = (y + 1 < height) ? row + width : NULL;
+        uint16_t x = 0;
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+        uint8x8_t vkeep = vdup_n_u8(keep);
+        uint8x8_t vseep = vdup_n_u8(seep);
+
+        for (; x + BULK_LEDS <= width; x += BULK_LEDS)
+        {
+            uint8_t *r = (uint8_t *)&row[x];
+            uint8_t *s = (uint8_t *)&scratch[x];
+
+            for (int k = 0; k < BULK_REGS; k++)
+            {
+                uint8x16_t cur = vld1q_u8(r + (k * 16));
+                uint8x16_t above = vld1q_u8(s + (k * 16));
+                uint8x16_t next = below ? vld1q_u8((const uint8_t *)&below[x] + (k * 16)) : vdupq_n_u8(0);
+
+                vst1q_u8(s + (k * 16), cur);
+                vst1q_u8(r + (k * 16), vblurq(cur, above, next, vkeep, vseep));
+            }
+        }
+#endif
+
+        for (; x < width; x++)
+        {
+            CRGB cur = row[x];
+
+            row[x] = blur_led(cur, scratch[x], below ? below[x] : 0, keep, seep);
+            scratch[x] = cur;
+        }
+    }
+}
+
+/// Gamma adjustment.
+/// pow() is only called while building a lookup table; tables are cached by
+/// gamma value and shared by every later call with the same gamma.
+
+#define GAMMA_LUT_CACHE_SIZE 8
+
+typedef struct
+{
+    float gamma;
+    uint8_t table[256];
+} gamma_lut_t;
+
+static pthread_mutex_t gamma_lut_mutex = PTHREAD_MUTEX_INITIALIZER;
+static gamma_lut_t gamma_lut_cache[GAMMA_LUT_CACHE_SIZE];
+static int gamma_lut_count = 0;
+
+static uint8_t calculate_gamma_video(uint8_t brightness, float gamma)
+{
+    float orig;
+    float adj;
+    orig = (float)(brightness) / (255.0);
+    adj = pow(orig, gamma) * (255.0);
+    uint8_t result = (uint8_t)(adj);
+    if ((brightness > 0) && (result == 0))
+    {
+        result = 1; // never gamma-adjust a positive number down to zero
+    }
+    return result;
+}
+
+const uint8_t *gamma_lut(float gamma)
+{
+    const uint8_t *table = NULL;
+
+    pthread_mutex_lock(&gamma_lut_mutex);
+    for (int entry = 0; entry < gamma_lut_count; entry++)
+    {
+        if (gamma_lut_cache[entry].gamma == gamma)
+        {
+            table = gamma_lut_cache[entry].table;
+            break;
+        }
+    }
+
+    // Tables are never evicted so returned pointers stay valid
+    if ((table == NULL) && (gamma_lut_count < GAMMA_LUT_CACHE_SIZE))
+    {
+        gamma_lut_t *lut = &gamma_lut_cache[gamma_lut_count++];
+
+        lut->gamma = gamma;
+        for (int brightness = 0; brightness < 256; brightness++)
+        {
+            lut->table[brightness] = calculate_gamma_video(brightness, gamma);
+        }
+        table = lut->table;
+    }
+    pthread_mutex_unlock(&gamma_lut_mutex);
+
+    return table;
+}
+
+uint8_t applyGamma_video(uint8_t brightness, float gamma)
+{
+    const uint8_t *table = gamma_lut(gamma);
+
+    return table ? table[brightness] : calculate_gamma_video(brightness, gamma);
+}
+
+void napplyGamma_video_rgb(CRGB *rgbarray, uint16_t count, float gammaR, float gammaG, float gammaB)
+{
+    const uint8_t *tableR = gamma_lut(gammaR);
+    const uint8_t *tableG = gamma_lut(gammaG);
+    const uint8_t *tableB = gamma_lut(gammaB);
+
+    if (!tableR || !tableG || !tableB)
+    {
+        // cache full, do it the slow way
+        for (uint16_t i = 0; i < count; i++)
+        {
+            rgbarray[i] = (rgbarray[i] & ((CRGB)0xff << LED_SHIFT_W)) |
+                          (calculate_gamma_video(CRGBW_red(rgbarray[i]), gammaR) << LED_SHIFT_R) |
+                          (calculate_gamma_video(CRGBW_green(rgbarray[i]), gammaG) << LED_SHIFT_G) |
+                          (calculate_gamma_video(CRGBW_blue(rgbarray[i]), gammaB) << LED_SHIFT_B);
+        }
+        return;
+    }
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        rgbarray[i] = (rgbarray[i] & ((CRGB)0xff << LED_SHIFT_W)) |
+                      (tableR[CRGBW_red(rgbarray[i])] << LED_SHIFT_R) |
+                      (tableG[CRGBW_green(rgbarray[i])] << LED_SHIFT_G) |
+                      (tableB[CRGBW_blue(rgbarray[i])] << LED_SHIFT_B);
+    }
+}
+
+void napplyGamma_video(CRGB *rgbarray, uint16_t count, float gamma)
+{
+    napplyGamma_video_rgb(rgbarray, count, gamma, gamma, gamma);
+}
@@ -18,6 +18,7 @@
 
 #include <stdint.h>
 #include <math.h>
+#include <pthread.h>
 #include "mini_fastled.h"
 
 // HSV functions
@@ -31,7 +32,7 @@
 
 #define FIXFRAC8(N, D) (((N) * 256) / (D))
 
-ws2811_led_t hsv_to_led(uint8_t hue, uint8_t saturation, uint8_t value)
+static ws2811_led_t calculate_hsv_to_led(uint8_t hue, uint8_t saturation, uint8_t value)
 {
     // Convert hue, saturation and brightness ( HSV/HSB ) to RGB
     // "Dimming" is used on saturation and brightness to make
@@ -119,3 +120,32 @@ ws2811_led_t hsv_to_led(uint8_t hue, uint8_t saturation, uint8_t value)
 
     return led_color;
 }
+
+// Full saturation and value is what the rainbow fills use, so those 256
+// colours are computed once and looked up from then on
+static pthread_once_t rainbow_table_once = PTHREAD_ONCE_INIT;
+static ws2811_led_t rainbow_table[256];
+
+static void build_rainbow_table(void)
+{
+    for (int hue = 0; hue < 256; hue++)
+    {
+        rainbow_table[hue] = calculate_hsv_to_led(hue, 255, 255);
+    }
+}
+
+const ws2811_led_t *hsv_rainbow_table(void)
+{
+    pthread_once(&rainbow_table_once, build_rainbow_table);
+    return rainbow_table;
+}
+
+ws2811_led_t hsv_to_led(uint8_t hue, uint8_t saturation, uint8_t value)
+{
+    if ((saturation == 255) && (value == 255))
+    {
+        return hsv_rainbow_table()[hue];
+    }
+
+    return calculate_hsv_to_led(hue, saturation, value);
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "led_matrix.h"
+
+bool matrix_init(led_matrix *matrix, uint16_t width, uint16_t height)
+{
+    memset(matrix, 0, sizeof(*matrix));
+
+    if ((width == 0) || (height == 0))
+    {
+        return false;
+    }
+
+    matrix->canvas = calloc((size_t)width * height, sizeof(CRGB));
+    matrix->scratch = calloc(width, sizeof(CRGB));
+    if (!matrix->canvas || !matrix->scratch)
+    {
+        matrix_cleanup(matrix);
+        return false;
+    }
+
+    matrix->width = width;
+    matrix->height = height;
+    return true;
+}
+
+// Canvas position of the LED at 'index' along a strip laid out over a tile
+static uint32_t tile_to_canvas(const led_matrix *matrix, const led_matrix_tile *tile, uint32_t index)
+{
+    bool columns = (tile->flags & MATRIX_COLUMN_MAJOR) != 0;
+    uint32_t run = columns ? tile->height : tile->width;
+    uint32_t major = index / run;
+    uint32_t minor = index % run;
+    uint32_t x, y;
+
+    if ((tile->flags & MATRIX_SERPENTINE) && (major & 1))
+    {
+        minor = run - 1 - minor;
+    }
+
+    x = columns ? major : minor;
+    y = columns ? minor : major;
+
+    if (tile->flags & MATRIX_FLIP_X)
+    {
+        x = tile->width - 1 - x;
+    }
+    if (tile->flags & MATRIX_FLIP_Y)
+    {
+        y = tile->height - 1 - y;
+    }
+
+    return ((tile->y + y) * matrix->width) + tile->x + x;
+}
+
+bool matrix_add_strip(led_matrix *matrix, unsigned strip_type, unsigned strip_pin, const led_matrix_tile *tile)
+{
+    uint32_t count = (uint32_t)tile->width * tile->height;
+    int strip = matrix->strip_count;
+    uint32_t *lut;
+
+    if ((strip >= LED_STRIP_CHANNELS) || (count == 0) || (count > UINT16_MAX) ||
+        ((uint32_t)tile->x + tile->width > matrix->width) ||
+        ((uint32_t)tile->y + tile->height > matrix->height))
+    {
+        return false;
+    }
+
+    lut = malloc(count * sizeof(uint32_t));
+    if (!lut)
+    {
+        return false;
+    }
+
+    for (uint32_t index = 0; index < count; index++)
+    {
+        lut[index] = tile_to_canvas(matrix, tile, index);
+    }
+
+    CRGBArray(count, strip_set);
+    matrix->strips[strip] = strip_set;
+    if (!FastLED_addLeds(strip_type, strip_pin, &matrix->strips[strip], count))
+    {
+        free(lut);
+        return false;
+    }
+
+    matrix->strip_lut[strip] = lut;
+    matrix->strip_count++;
+    return true;
+}
+
+void matrix_render(led_matrix *matrix)
+{
+    for (int strip = 0; strip < matrix->strip_count; strip++)
+    {
+        rgb_pixel_set *rps = &matrix->strips[strip];
+        const uint32_t *lut = matrix->strip_lut[strip];
+
+        for (int index = 0; index < rps->length; index++)
+        {
+            rps->leds[index] = matrix->canvas[lut[index]];
+        }
+        rps->power_valid = false;
+    }
+}
+
+void matrix_blur2d(led_matrix *matrix, uint8_t blur_amount)
+{
+    blur2d_leds(matrix->canvas, matrix->width, matrix->height, blur_amount, matrix->scratch);
+}
+
+void matrix_cleanup(led_matrix *matrix)
+{
+    for (int strip = 0; strip < LED_STRIP_CHANNELS; strip++)
+    {
+        free(matrix->strip_lut[strip]);
+        matrix->strip_lut[strip] = NULL;
+    }
+
+    free(matrix->canvas);
+    free(matrix->scratch);
+    matrix->canvas = NULL;
+    matrix->scratch = NULL;
+    matrix->strip_count = 0;
+}
@@ -21,13 +21,6 @@
 #include "lib8tion.h"
 
 // math operations
-uint8_t qadd8( uint8_t i, uint8_t j)
-{
-    unsigned int t = i + j;
-    if( t > 255) t = 255;
-    return t;
-}
-
  int8_t qadd7( int8_t i, int8_t j)
 {
     int16_t t = i + j;
@@ -35,13 +28,6 @@ uint8_t qadd8( uint8_t i, uint8_t j)
     return t;
 }
 
- uint8_t qsub8( uint8_t i, uint8_t j)
-{
-    int t = i - j;
-    if( t < 0) t = 0;
-    return t;
-}
-
  uint8_t add8( uint8_t i, uint8_t j)
 {
     int t = i + j;
@@ -148,48 +134,6 @@ uint8_t sqrt16(uint16_t x)
     return low - 1;
 }
 
-uint8_t blend8( uint8_t a, uint8_t b, uint8_t amountOfB)
-{
-    uint16_t partial;
-    uint8_t result;
-
-    uint8_t amountOfA = 255 - amountOfB;
-
-    partial = (a * amountOfA);
-    partial += (b * amountOfB);
-    result = partial >> 8;
-
-    return result;
-
-}
-
-/// scaling functions
-void nscale8x3(uint8_t *red, uint8_t *green, uint8_t *blue, fract8 scale)
-{
-    *red = ((int)*red * (int)scale) >> 8;
-    *green = ((int)*green * (int)scale) >> 8;
-    *blue = ((int)*blue * (int)scale) >> 8;
-}
-
-void nscale8x3_video(uint8_t *red, uint8_t *green, uint8_t *blue, fract8 scale)
-{
-    *red = (((int)*red * (int)scale) >> 8) + (((int)*red && scale) ? 1 : 0);
-    *green = (((int)*green * (int)scale) >> 8) + (((int)*green && scale) ? 1 : 0);
-    *blue = (((int)*blue * (int)scale) >> 8) + (((int)*blue && scale) ? 1 : 0);
-}
-
-void nscale8x2(uint8_t *i, uint8_t *j, fract8 scale)
-{
-    *i = ((int)*i * (int)scale) >> 8;
-    *j = ((int)*j * (int)scale) >> 8;
-}
-
-void nscale8x2_video(uint8_t *i, uint8_t *j, fract8 scale)
-{
-    *i = (((int)*i * (int)scale) >> 8) + (((int)*i && scale) ? 1 : 0);
-    *j = (((int)*j * (int)scale) >> 8) + (((int)*j && scale) ? 1 : 0);
-}
-
 // dimming functions
 uint8_t dim8_lin(uint8_t x)
 {
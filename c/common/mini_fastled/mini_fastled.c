@@ -16,11 +16,13 @@
 
 // adapted from the FastLED library (https://fastled.io/)
 
+#include <errno.h>
 #include <fcntl.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <sys/neutrino.h>
 #include "mini_fastled.h"
 #include "power_mgt.h"
@@ -29,6 +31,7 @@
 ws2811_t ledset =
     {
         .freq = WS2811_TARGET_FREQ,
+        .double_buffer = 1,
         .channel =
             {
                 [0] =
@@ -55,11 +58,32 @@ ws2811_t ledset =
                         .gamma_factor = 0.0,
                         .gamma = NULL,
                     },
+                [2] =
+                    {
+                        .gpionum = -1,
+                        .invert = 0,
+                        .count = 0,
+                        .leds = NULL,
+                        .brightness = 255,
+                        .color_correction = 0,
+                        .color_temperature = 0,
+                        .gamma_factor = 0.0,
+                        .gamma = NULL,
+                    },
             },
 };
 
 // settings backing main FASTLED functions
-static uint32_t lastshow = 0; // time of last show call
+static uint64_t lastshow = 0; // time of last show call
+
+// frame scheduler state
+static struct timespec m_nextFrame;  ///< absolute CLOCK_MONOTONIC deadline of the next frame
+static bool m_bFrameScheduled;       ///< m_nextFrame holds a deadline
+static uint32_t m_nFramePeriod;      ///< period of the last scheduled frame in µs, the cap or the strip time
+static uint64_t m_nFpsWindowStart;   ///< start of the current FPS measurement window, in µs
+static uint32_t m_nFpsWindowFrames;  ///< frames shown in the current window
+static uint32_t m_nWindowJitter;     ///< worst deviation from the frame period in the current window
+static uint32_t m_nFrameJitter;      ///< worst deviation from the frame period over the last window, in µs
 
 /// Typedef for a power consumption calculation function. Used within
 /// CFastLED for rescaling brightness before sending the LED data to
@@ -79,12 +103,22 @@ static uint16_t m_nFPS;         ///< tracking for current frames per second (FPS
 static uint32_t m_nMinMicros;   ///< minimum µs between frames, used for capping frame rates
 static uint32_t m_nPowerData;   ///< max power use parameter
 static power_func m_pPowerFunc; ///< function for overriding brightness when using FastLED.show();
+static bool m_bPowerTracking;   ///< use the pixel sets' running sums for the power limit
+static rgb_pixel_set *m_pChannelSets[LED_STRIP_CHANNELS]; ///< pixel set attached to each channel
+
+/// Power limit from the pixel sets' running sums, see FastLED_setPowerTracking()
+static uint8_t calculate_max_brightness_for_power_mW_tracked(ws2811_t *ledset, uint8_t scale, uint32_t data)
+{
+    (void)(ledset);
+    return calculate_max_brightness_for_power_mW_pixel_sets(m_pChannelSets, LED_STRIP_CHANNELS, scale, data);
+}
 
 // functions backing main FASTLED functions
 /* The `FastLED_addLeds` function is a custom function that is used to add LED strips to the FastLED
 library. It takes in parameters such as the type of LED strip, the pin number to which the strip is
-connected, a pointer to the LED data, and the number of LEDs in the strip. */
-void FastLED_addLeds(unsigned strip_type, unsigned strip_pin, rgb_pixel_set *rps, unsigned number_leds)
+connected, a pointer to the LED data, and the number of LEDs in the strip. Each strip takes the next
+free channel (one per SPI bus); it returns false if all LED_STRIP_CHANNELS are already in use. */
+bool FastLED_addLeds(unsigned strip_type, unsigned strip_pin, rgb_pixel_set *rps, unsigned number_leds)
 {
     // initialize common settings for all LED channels
     m_nFPS = 0;
@@ -92,40 +126,34 @@ void FastLED_addLeds(unsigned strip_type, unsigned strip_pin, rgb_pixel_set *rps
 	m_nPowerData = 0xFFFFFFFF;
 	m_nMinMicros = 0;
 
-    if (ledset.channel[0].gpionum == -1)
+    for (int chan = 0; chan < LED_STRIP_CHANNELS; chan++)
     {
-        ledset.channel[0].gpionum = strip_pin;
-        ledset.channel[0].strip_type = strip_type;
-        ledset.channel[0].count = number_leds;
-        if (rps->leds == NULL)
+        ws2811_channel_t *channel = &ledset.channel[chan];
+
+        if (channel->gpionum != -1)
         {
-            rps->length = number_leds;
-            rps->leds = malloc(rps->length * sizeof(ws2811_led_t));
-            memset(rps->leds, 0, rps->length * sizeof(ws2811_led_t));
+            continue;
         }
-        ledset.channel[0].leds = rps->leds;
-        ledset.channel[0].brightness = 255;
-    }
-    else if (ledset.channel[1].gpionum == -1)
-    {
-        ledset.channel[1].gpionum = strip_pin;
-        ledset.channel[1].strip_type = strip_type;
-        ledset.channel[1].count = number_leds;
+
+        channel->gpionum = strip_pin;
+        channel->strip_type = strip_type;
+        channel->count = number_leds;
         if (rps->leds == NULL)
         {
             rps->length = number_leds;
             rps->leds = malloc(rps->length * sizeof(ws2811_led_t));
             memset(rps->leds, 0, rps->length * sizeof(ws2811_led_t));
         }
-        ledset.channel[1].leds = rps->leds;
-        ledset.channel[1].brightness = 255;
-    }
-    else
-    {
-        // skip as there are only two channels supported
+        channel->leds = rps->leds;
+        channel->brightness = 255;
+        rps->power_valid = false;
+        m_pChannelSets[chan] = rps;
+        return true;
     }
 
-    return;
+    // all channels are taken
+    fprintf(stderr, "FastLED_addLeds: no free LED channel for pin %u\n", strip_pin);
+    return false;
 }
 
 uint8_t FastLED_getBrightness()
@@ -135,8 +163,10 @@ uint8_t FastLED_getBrightness()
 
 void FastLED_setBrightness(uint8_t brightness)
 {
-    ledset.channel[0].brightness = brightness;
-    ledset.channel[1].brightness = brightness;
+    for (int chan = 0; chan < LED_STRIP_CHANNELS; chan++)
+    {
+        ledset.channel[chan].brightness = brightness;
+    }
 }
 
 void FastLED_setMaxPowerInVoltsAndMilliamps(uint8_t volts, uint32_t milliamps)
@@ -146,10 +176,29 @@ void FastLED_setMaxPowerInVoltsAndMilliamps(uint8_t volts, uint32_t milliamps)
 
 void FastLED_setMaxPowerInMilliWatts(uint32_t milliwatts)
 {
-    m_pPowerFunc = &calculate_max_brightness_for_power_mW_ledset;
+    m_pPowerFunc = m_bPowerTracking ? &calculate_max_brightness_for_power_mW_tracked : &calculate_max_brightness_for_power_mW_ledset;
     m_nPowerData = milliwatts;
 }
 
+void FastLED_setPowerTracking(bool enable)
+{
+    m_bPowerTracking = enable;
+
+    // Start from a full scan, the sums may be stale from before tracking was on
+    for (int index = 0; index < LED_STRIP_CHANNELS; index++)
+    {
+        if (m_pChannelSets[index])
+        {
+            m_pChannelSets[index]->power_valid = false;
+        }
+    }
+
+    if (m_pPowerFunc)
+    {
+        m_pPowerFunc = m_bPowerTracking ? &calculate_max_brightness_for_power_mW_tracked : &calculate_max_brightness_for_power_mW_ledset;
+    }
+}
+
 void FastLED_setCorrection(LEDColorCorrection color_correction)
 {
     ws2811_set_color_correction(&ledset, color_correction);
@@ -160,10 +209,94 @@ void FastLED_setTemperature(ws2811_led_t color_temperature)
     ws2811_set_color_temperature(&ledset, color_temperature);
 }
 
+void FastLED_setMaxRefreshRate(uint16_t refresh)
+{
+    m_nMinMicros = refresh ? 1000000 / refresh : 0;
+    m_bFrameScheduled = false;
+}
+
+uint16_t FastLED_getFPS()
+{
+    return m_nFPS;
+}
+
+uint32_t FastLED_getFrameJitter()
+{
+    return m_nFrameJitter;
+}
+
+/// Sleep until the next frame deadline. The period is the refresh cap or, if longer,
+/// the time the strips need to send the previous frame and latch. The ws2811 transmit
+/// thread still guards the reset latch after each transfer, but by the deadline it
+/// has normally passed, so that guard does not sleep as well.
+static void wait_for_frame(void)
+{
+    struct timespec now;
+    uint64_t period_ns;
+
+    if (!m_nMinMicros)
+    {
+        return;
+    }
+
+    m_nFramePeriod = (ledset.render_wait_time > m_nMinMicros) ? (uint32_t)ledset.render_wait_time : m_nMinMicros;
+    period_ns = (uint64_t)m_nFramePeriod * 1000;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    // First frame, or more than a frame late: restart from now rather than bursting to catch up
+    if (!m_bFrameScheduled ||
+        (now.tv_sec - m_nextFrame.tv_sec) * 1000000000LL + (now.tv_nsec - m_nextFrame.tv_nsec) > (int64_t)period_ns)
+    {
+        m_nextFrame = now;
+        m_bFrameScheduled = true;
+    }
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &m_nextFrame, NULL) == EINTR)
+    {
+    }
+
+    m_nextFrame.tv_nsec += period_ns % 1000000000;
+    m_nextFrame.tv_sec += period_ns / 1000000000 + m_nextFrame.tv_nsec / 1000000000;
+    m_nextFrame.tv_nsec %= 1000000000;
+}
+
+/// Measure the real frame rate and jitter over one second windows
+static void count_frame(uint64_t now)
+{
+    // Measured against the period actually slept for, which the strip time can stretch past the cap
+    if (lastshow && m_nMinMicros)
+    {
+        uint64_t interval = now - lastshow;
+        uint32_t deviation = (interval > m_nFramePeriod) ? interval - m_nFramePeriod : m_nFramePeriod - interval;
+
+        if (deviation > m_nWindowJitter)
+        {
+            m_nWindowJitter = deviation;
+        }
+    }
+    lastshow = now;
+
+    if (m_nFpsWindowStart == 0)
+    {
+        m_nFpsWindowStart = now;
+    }
+    m_nFpsWindowFrames++;
+
+    if (now - m_nFpsWindowStart >= 1000000)
+    {
+        m_nFPS = (uint16_t)(((uint64_t)m_nFpsWindowFrames * 1000000) / (now - m_nFpsWindowStart));
+        m_nFrameJitter = m_nWindowJitter;
+        m_nFpsWindowStart = now;
+        m_nFpsWindowFrames = 0;
+        m_nWindowJitter = 0;
+    }
+}
+
 void FastLED_showAt(uint8_t brightness)
 {
-    while(m_nMinMicros && ((micros()-lastshow) < m_nMinMicros));
-	lastshow = micros();
+    wait_for_frame();
+    count_frame(micros());
 
 	// If we have a function for computing power, use it!
 	if(m_pPowerFunc) {
@@ -177,24 +310,23 @@ void FastLED_showAt(uint8_t brightness)
 // Clear the matrix from start s to end e
 void FastLED_clear(bool write_data)
 {
-    if (ledset.channel[0].gpionum != -1)
+    for (int chan = 0; chan < LED_STRIP_CHANNELS; chan++)
     {
-        if (ledset.channel[0].leds)
+        ws2811_channel_t *channel = &ledset.channel[chan];
+
+        if ((channel->gpionum == -1) || !channel->leds)
         {
-            for (int index = 0; index < ledset.channel[0].count; index++)
-            {
-                ledset.channel[0].leds[index] = 0;
-            }
+            continue;
         }
-    }
-    if (ledset.channel[1].gpionum != -1)
-    {
-        if (ledset.channel[1].leds)
+
+        memset(channel->leds, 0, channel->count * sizeof(ws2811_led_t));
+
+        if (m_pChannelSets[chan] && m_pChannelSets[chan]->length <= channel->count)
         {
-            for (int index = 0; index < ledset.channel[1].count; index++)
-            {
-                ledset.channel[1].leds[index] = 0;
-            }
+            m_pChannelSets[chan]->power_red = 0;
+            m_pChannelSets[chan]->power_green = 0;
+            m_pChannelSets[chan]->power_blue = 0;
+            m_pChannelSets[chan]->power_valid = true;
         }
     }
 
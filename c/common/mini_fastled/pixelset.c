@@ -19,14 +19,43 @@
 #include <stdint.h>
 #include <math.h>
 #include "mini_fastled.h"
+#include "power_mgt.h"
 
 
 // pixel set functions
 ws2811_led_t *get(struct rgb_pixel_set *rps, unsigned index)
 {
+    // the caller may write through the pointer, so the sums have to be rebuilt
+    rps->power_valid = false;
     return &(rps->leds[index]);
 }
 
+// Replace one LED, keeping the running colour sums current
+static inline void set_tracked(struct rgb_pixel_set *rps, int index, ws2811_led_t value)
+{
+    ws2811_led_t old = rps->leds[index];
+
+    rps->power_red += CRGBW_red(value) - CRGBW_red(old);
+    rps->power_green += CRGBW_green(value) - CRGBW_green(old);
+    rps->power_blue += CRGBW_blue(value) - CRGBW_blue(old);
+    rps->leds[index] = value;
+}
+
+// Add one freshly written LED to sums being rebuilt from zero
+static inline void add_to_sums(struct rgb_pixel_set *rps, ws2811_led_t value)
+{
+    rps->power_red += CRGBW_red(value);
+    rps->power_green += CRGBW_green(value);
+    rps->power_blue += CRGBW_blue(value);
+}
+
+static inline void reset_sums(struct rgb_pixel_set *rps)
+{
+    rps->power_red = 0;
+    rps->power_green = 0;
+    rps->power_blue = 0;
+}
+
 void copyFrom(struct rgb_pixel_set *rps_to, int to_start, int to_end,
               struct rgb_pixel_set *rps_from, int from_start, int from_end)
 {
@@ -49,22 +78,15 @@ void copyFrom(struct rgb_pixel_set *rps_to, int to_start, int to_end,
 
     for (int index = 0; index < fabs(to_start - to_end); index++)
     {
-        rps_to->leds[index * to_inc + to_start] = rps_from->leds[index * from_inc + from_start];
+        set_tracked(rps_to, index * to_inc + to_start, rps_from->leds[index * from_inc + from_start]);
     }
 }
 
 void nscale8(struct rgb_pixel_set *rps, fract8 scale)
 {
-    for (uint16_t index = 0; index < rps->length; index++)
-    {
-        uint8_t red = (rps->leds[index] >> LED_SHIFT_R) % 0xff;
-        uint8_t green = (rps->leds[index] >> LED_SHIFT_G) % 0xff;
-        uint8_t blue = (rps->leds[index] >> LED_SHIFT_B) % 0xff;
-
-        nscale8x3(&red, &green, &blue, scale);
-
-        rps->leds[index] = (red << LED_SHIFT_R) + (green << LED_SHIFT_G) + (blue << LED_SHIFT_B);
-    }
+    nscale8_leds(rps->leds, rps->length, scale);
+    calculate_color_sums(rps->leds, rps->length, &rps->power_red, &rps->power_green, &rps->power_blue);
+    rps->power_valid = true;
 }
 
 void fadeToBlackBy(struct rgb_pixel_set *rps, uint8_t fadefactor)
@@ -93,12 +115,16 @@ void fill_rainbow(struct rgb_pixel_set *rps, uint8_t initialhue, uint8_t deltahu
 {
     if (rps->direction >= 0)
     {
+        const ws2811_led_t *rainbow = hsv_rainbow_table();
         uint8_t hue = initialhue;
+        reset_sums(rps);
         for (uint16_t index = 0; index < rps->length; index++)
         {
-            rps->leds[index] = CHSV(hue, 255, 255);
+            rps->leds[index] = rainbow[hue];
+            add_to_sums(rps, rps->leds[index]);
             hue += deltahue;
         }
+        rps->power_valid = true;
         /*
                 FUNCTION_FILL_RAINBOW(leds,len,initialhue,deltahue);
                 FUNCTION_FILL_RAINBOW(leds + len + 1, -len, initialhue - deltahue * (len+1), -deltahue);
@@ -110,6 +136,31 @@ void fill_rainbow(struct rgb_pixel_set *rps, uint8_t initialhue, uint8_t deltahu
     }
 }
 
+void fill_rainbow_circular(struct rgb_pixel_set *rps, uint8_t initialhue, bool reversed)
+{
+    if ((rps->direction >= 0) && (rps->length > 0))
+    {
+        const ws2811_led_t *rainbow = hsv_rainbow_table();
+        const uint16_t hueChange = 65535 / (uint16_t)rps->length; // hue change for each LED, * 256 for precision (256 * 256 - 1)
+        uint16_t hueOffset = 0; // offset for hue value, with precision (*256)
+        reset_sums(rps);
+        for (uint16_t index = 0; index < rps->length; index++)
+        {
+            rps->leds[index] = rainbow[(uint8_t)(initialhue + (uint8_t)(hueOffset >> 8))];
+            add_to_sums(rps, rps->leds[index]);
+            if (reversed)
+            {
+                hueOffset -= hueChange;
+            }
+            else
+            {
+                hueOffset += hueChange;
+            }
+        }
+        rps->power_valid = true;
+    }
+}
+
 /*
     /// Get the size of this set
     /// @return the size of the set, in number of LEDs
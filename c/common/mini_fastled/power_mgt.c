@@ -21,6 +21,10 @@
 #include "mini_fastled.h"
 #include "power_mgt.h"
 
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 /// Functions to limit the power used by FastLED
 
 // POWER MANAGEMENT
@@ -68,17 +72,43 @@ static const uint8_t gMCU_mW = 25 * 5; // 25mA @ 5v = 125 mW
 
 static uint8_t gMaxPowerIndicatorLEDPinNumber = LED_CHANNEL_0_DATA_PIN; // default
 
-uint32_t calculate_unscaled_power_mW(const CRGB *ledbuffer, uint16_t numLeds) // 25354
+void calculate_color_sums(const CRGB *ledbuffer, uint16_t numLeds, uint32_t *red, uint32_t *green, uint32_t *blue)
 {
     uint32_t red32 = 0, green32 = 0, blue32 = 0;
-    
-    for (int index = 0; index < numLeds; index++)
+    int index = 0;
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    // 16 LEDs per pass; on little endian byte 0/1/2 of each 0xWWRRGGBB word is blue/green/red
+    uint32x4_t red_acc = vdupq_n_u32(0), green_acc = vdupq_n_u32(0), blue_acc = vdupq_n_u32(0);
+
+    for (; index + 16 <= numLeds; index += 16)
+    {
+        uint8x16x4_t pixels = vld4q_u8((const uint8_t *)&ledbuffer[index]);
+
+        blue_acc = vpadalq_u16(blue_acc, vpaddlq_u8(pixels.val[0]));
+        green_acc = vpadalq_u16(green_acc, vpaddlq_u8(pixels.val[1]));
+        red_acc = vpadalq_u16(red_acc, vpaddlq_u8(pixels.val[2]));
+    }
+
+    red32 = vaddvq_u32(red_acc);
+    green32 = vaddvq_u32(green_acc);
+    blue32 = vaddvq_u32(blue_acc);
+#endif
+
+    for (; index < numLeds; index++)
     {
         red32 += CRGBW_red(ledbuffer[index]);
         green32 += CRGBW_green(ledbuffer[index]);
         blue32 += CRGBW_blue(ledbuffer[index]);
     }
 
+    *red = red32;
+    *green = green32;
+    *blue = blue32;
+}
+
+uint32_t calculate_unscaled_power_mW_for_sums(uint32_t red32, uint32_t green32, uint32_t blue32, uint16_t numLeds)
+{
     red32 *= gRed_mW;
     green32 *= gGreen_mW;
     blue32 *= gBlue_mW;
@@ -92,6 +122,40 @@ uint32_t calculate_unscaled_power_mW(const CRGB *ledbuffer, uint16_t numLeds) //
     return total;
 }
 
+uint32_t calculate_unscaled_power_mW(const CRGB *ledbuffer, uint16_t numLeds) // 25354
+{
+    uint32_t red32, green32, blue32;
+
+    calculate_color_sums(ledbuffer, numLeds, &red32, &green32, &blue32);
+
+    return calculate_unscaled_power_mW_for_sums(red32, green32, blue32, numLeds);
+}
+
+uint32_t calculate_unscaled_power_mW_pixel_set(rgb_pixel_set *rps)
+{
+    // Only rescan when something wrote the set behind the helpers' back
+    if (!rps->power_valid)
+    {
+        calculate_color_sums(rps->leds, rps->length, &rps->power_red, &rps->power_green, &rps->power_blue);
+        rps->power_valid = true;
+    }
+
+    return calculate_unscaled_power_mW_for_sums(rps->power_red, rps->power_green, rps->power_blue, rps->length);
+}
+
+static uint8_t limit_brightness_for_power(uint32_t total_mW, uint8_t target_brightness, uint32_t max_power_mW)
+{
+    uint32_t requested_power_mW = ((uint32_t)total_mW * target_brightness) / 256;
+
+    uint8_t recommended_brightness = target_brightness;
+    if (requested_power_mW > max_power_mW)
+    {
+        recommended_brightness = (uint32_t)((uint8_t)(target_brightness) * (uint32_t)(max_power_mW)) / ((uint32_t)(requested_power_mW));
+    }
+
+    return recommended_brightness;
+}
+
 uint8_t calculate_max_brightness_for_power_vmA(const CRGB* ledbuffer, uint16_t numLeds, uint8_t target_brightness, uint32_t max_power_V, uint32_t max_power_mA) {
     return calculate_max_brightness_for_power_mW(ledbuffer, numLeds, target_brightness, max_power_V * max_power_mA);
 }
@@ -99,45 +163,37 @@ uint8_t calculate_max_brightness_for_power_vmA(const CRGB* ledbuffer, uint16_t n
 uint8_t calculate_max_brightness_for_power_mW(const CRGB* ledbuffer, uint16_t numLeds, uint8_t target_brightness, uint32_t max_power_mW) {
     uint32_t total_mW = calculate_unscaled_power_mW( ledbuffer, numLeds);
 
-   uint32_t requested_power_mW = ((uint32_t)total_mW * target_brightness) / 256;
-
-   uint8_t recommended_brightness = target_brightness;
-   if(requested_power_mW > max_power_mW) { 
-       recommended_brightness = (uint32_t)((uint8_t)(target_brightness) * (uint32_t)(max_power_mW)) / ((uint32_t)(requested_power_mW));
-   }
-
-   return recommended_brightness;
+    return limit_brightness_for_power(total_mW, target_brightness, max_power_mW);
 }
 
 uint8_t calculate_max_brightness_for_power_mW_ledset(ws2811_t *ledset, uint8_t target_brightness, uint32_t max_power_mW)
 {
     uint32_t total_mW = 0;
 
-    if (ledset->channel[0].gpionum != -1)
+    for (int chan = 0; chan < LED_STRIP_CHANNELS; chan++)
     {
-        if (ledset->channel[0].leds)
+        if ((ledset->channel[chan].gpionum != -1) && ledset->channel[chan].leds)
         {
-            total_mW += calculate_unscaled_power_mW(ledset->channel[0].leds, ledset->channel[0].count);
+            total_mW += calculate_unscaled_power_mW(ledset->channel[chan].leds, ledset->channel[chan].count);
         }
     }
 
-    if (ledset->channel[1].gpionum != -1)
-    {
-        if (ledset->channel[1].leds)
-        {
-            total_mW += calculate_unscaled_power_mW(ledset->channel[1].leds, ledset->channel[1].count);
-        }
-    }
+    return limit_brightness_for_power(total_mW, target_brightness, max_power_mW);
+}
 
-    uint32_t requested_power_mW = ((uint32_t)total_mW * target_brightness) / 256;
+uint8_t calculate_max_brightness_for_power_mW_pixel_sets(rgb_pixel_set **sets, unsigned count, uint8_t target_brightness, uint32_t max_power_mW)
+{
+    uint32_t total_mW = 0;
 
-    uint8_t recommended_brightness = target_brightness;
-    if (requested_power_mW > max_power_mW)
+    for (unsigned index = 0; index < count; index++)
     {
-        recommended_brightness = (uint32_t)((uint8_t)(target_brightness) * (uint32_t)(max_power_mW)) / ((uint32_t)(requested_power_mW));
+        if (sets[index] && sets[index]->leds)
+        {
+            total_mW += calculate_unscaled_power_mW_pixel_set(sets[index]);
+        }
     }
 
-    return recommended_brightness;
+    return limit_brightness_for_power(total_mW, target_brightness, max_power_mW);
 }
 
 /*
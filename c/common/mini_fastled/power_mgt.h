@@ -79,6 +79,24 @@ extern void delay_at_max_brightness_for_power( uint16_t ms);
 /// @returns the number of milliwatts the LED data would consume at max brightness
 extern uint32_t calculate_unscaled_power_mW( const CRGB* ledbuffer, uint16_t numLeds);
 
+/// Sums the red, green and blue components of the LED data. Vectorized on aarch64.
+/// @param ledbuffer the LED data to check
+/// @param numLeds the number of LEDs in the data array
+/// @param red, green, blue the component sums (output)
+extern void calculate_color_sums(const CRGB *ledbuffer, uint16_t numLeds, uint32_t *red, uint32_t *green, uint32_t *blue);
+
+/// Converts component sums from calculate_color_sums() into milliwatts at max brightness
+/// @param red32, green32, blue32 the component sums
+/// @param numLeds the number of LEDs summed
+/// @returns the number of milliwatts the LED data would consume at max brightness
+extern uint32_t calculate_unscaled_power_mW_for_sums(uint32_t red32, uint32_t green32, uint32_t blue32, uint16_t numLeds);
+
+/// Like calculate_unscaled_power_mW(), but uses the pixel set's running sums,
+/// rescanning only when they have been invalidated
+/// @param rps the pixel set to check
+/// @returns the number of milliwatts the LED data would consume at max brightness
+extern uint32_t calculate_unscaled_power_mW_pixel_set(rgb_pixel_set *rps);
+
 /// Determines the highest brightness level you can use and still stay under
 /// the specified power budget for a given set of LEDs.
 /// @param ledbuffer the LED data to check
@@ -110,6 +128,16 @@ extern uint8_t calculate_max_brightness_for_power_vmA(const CRGB* ledbuffer, uin
 /// but may be lower depending on the power limit.
 extern uint8_t  calculate_max_brightness_for_power_mW_ledset(ws2811_t *ledset, uint8_t target_brightness, uint32_t max_power_mW);
 
+/// @copybrief calculate_max_brightness_for_power_mW_ledset()
+/// Uses each pixel set's running sums instead of rescanning the LED data.
+/// @param sets the pixel sets attached to the LED channels
+/// @param count the number of entries in sets (NULL entries are skipped)
+/// @param target_brightness the brightness you'd ideally like to use
+/// @param max_power_mW the max power draw desired, in milliwatts
+/// @returns a limited brightness value. No higher than the target brightness,
+/// but may be lower depending on the power limit.
+extern uint8_t  calculate_max_brightness_for_power_mW_pixel_sets(rgb_pixel_set **sets, unsigned count, uint8_t target_brightness, uint32_t max_power_mW);
+
 /*
 /// Determines the highest brightness level you can use and still stay under
 /// the specified power budget for all sets of LEDs. 
@@ -41,4 +41,9 @@ typedef enum {
 
 extern ws2811_led_t hsv_to_led(uint8_t hue, uint8_t saturation, uint8_t value);
 
+/// Get the table of fully saturated, full brightness colours for every hue,
+/// i.e. hsv_rainbow_table()[hue] == hsv_to_led(hue, 255, 255)
+/// @returns a 256 entry table, built on first use
+extern const ws2811_led_t *hsv_rainbow_table(void);
+
 #endif
\ No newline at end of file
@@ -523,7 +523,7 @@ CHSV& nblend( CHSV& existing, const CHSV& overlay, fract8 amountOfOverlay,
 /// @param overlay the color array to blend into existing
 /// @param count the number of colors to process
 /// @param amountOfOverlay the fraction of overlay to blend into existing
-void  nblend( CRGB* existing, CRGB* overlay, uint16_t count, fract8 amountOfOverlay);
+void  nblend( CRGB* existing, CRGB* overlay, uint16_t count, uint8_t amountOfOverlay);
 
 /// @copydoc nblend(CRGB*, CRGB*, uint16_t, fract8)
 /// @param directionCode the direction to travel around the color wheel
@@ -551,7 +551,7 @@ void  nblend( CHSV* existing, CHSV* overlay, uint16_t count, fract8 amountOfOver
 /// @param leds a pointer to the LED array to blur
 /// @param numLeds the number of LEDs to blur
 /// @param blur_amount the amount of blur to apply
-void blur1d( CRGB* leds, uint16_t numLeds, fract8 blur_amount);
+void blur1d( CRGB* leds, uint16_t numLeds, uint8_t blur_amount);
 
 /// Two-dimensional blur filter. 
 /// Spreads light to 8 XY neighbors.
@@ -572,7 +572,7 @@ void blur2d( CRGB* leds, uint8_t width, uint8_t height, fract8 blur_amount, cons
 
 /// Legacy version of blur2d, which does not require an XYMap but instead implicitly binds to XY() function.
 /// If you are hitting a linker error here, then use blur2d(..., const fl::XYMap& xymap) instead.
-void blur2d( CRGB* leds, uint8_t width, uint8_t height, fract8 blur_amount) FASTLED_DEPRECATED("Use blur2d(..., const fl::XYMap& xymap) instead");
+void blur2d( CRGB* leds, uint8_t width, uint8_t height, uint8_t blur_amount) FASTLED_DEPRECATED("Use blur2d(..., const fl::XYMap& xymap) instead");
 
 
 /// Perform a blur1d() on every row of a rectangular matrix
@@ -2029,6 +2029,84 @@ extern CRGB ColorFromPalette_ext( const CRGBPalette16 pal,
 #define ColorFromPalette(pal, index, brightness) ColorFromPalette_ext(pal, index, brightness, LINEARBLEND)
 #define ColorFromPalette_bright(pal, index) ColorFromPalette_ext(pal, index, 255, LINEARBLEND)
 
+/// Bulk functions for LED arrays.
+/// These work on all four bytes of each LED (white included) and use NEON
+/// on aarch64, 16 LEDs at a time, with the same results as the scalar code.
+
+/// Scale the brightness of an array of LEDs all at once
+/// @param leds a pointer to the LED array to scale
+/// @param num_leds the number of LEDs to scale
+/// @param scale the scale value for each LED, in n/256 units
+extern void nscale8_leds(CRGB *leds, uint16_t num_leds, uint8_t scale);
+
+/// Reduce the brightness of an array of pixels all at once
+/// @param leds a pointer to the LED array to fade
+/// @param num_leds the number of LEDs to fade
+/// @param fadeBy how much to fade each LED, in 1/256ths
+extern void fadeToBlackBy_leds(CRGB *leds, uint16_t num_leds, uint8_t fadeBy);
+
+/// Destructively merges one LED array into another
+/// @param existing the LED array to blend into (modified in place)
+/// @param overlay the LED array to blend in
+/// @param count the number of LEDs to blend
+/// @param amountOfOverlay the fraction of overlay to blend in, 0-255
+extern void nblend_leds(CRGB *existing, const CRGB *overlay, uint16_t count, uint8_t amountOfOverlay);
+
+/// Computes the blend of two LED arrays into a third
+/// @param src1 the first LED array to blend
+/// @param src2 the second LED array to blend
+/// @param dest the LED array to write the result to, may be src1 or src2
+/// @param count the number of LEDs to blend
+/// @param amountOfsrc2 the fraction of src2 to blend in, 0-255
+extern void blend_leds(const CRGB *src1, const CRGB *src2, CRGB *dest, uint16_t count, uint8_t amountOfsrc2);
+
+/// One-dimensional blur filter. Spreads light to 2 LEDs on each side.
+/// Each LED keeps 255 - blur_amount of itself and gets blur_amount / 2 of
+/// each neighbour.
+/// @param leds a pointer to the LED array to blur
+/// @param numLeds the number of LEDs to blur
+/// @param blur_amount the amount of blur to apply
+extern void blur1d_leds(CRGB *leds, uint16_t numLeds, uint8_t blur_amount);
+
+/// Two-dimensional blur filter, blur1d_leds() along the rows and then the
+/// columns. Spreads light to the 8 neighbours of each LED.
+/// @param leds a pointer to the LED array to blur, width * height LEDs row by row
+/// @param width the number of LEDs in a row
+/// @param height the number of rows
+/// @param blur_amount the amount of blur to apply
+/// @param scratch room for width LEDs, overwritten
+extern void blur2d_leds(CRGB *leds, uint16_t width, uint16_t height, uint8_t blur_amount, CRGB *scratch);
+
+/// Gamma adjustment functions.
+/// The curve for each gamma value is computed once into a 256 entry lookup
+/// table and cached, so repeated calls with the same gamma are table lookups.
+
+/// Get the cached lookup table for a gamma value, building it if needed
+/// @param gamma the gamma value
+/// @returns a 256 entry table of adjusted values, valid for the life of the
+/// program, or NULL if the cache is full (up to 8 gamma values are kept)
+extern const uint8_t *gamma_lut(float gamma);
+
+/// Applies a gamma adjustment to a color channel
+/// @param brightness the value of the color data
+/// @param gamma the gamma value to apply
+/// @returns the color data, adjusted for gamma
+extern uint8_t applyGamma_video(uint8_t brightness, float gamma);
+
+/// Destructively applies a gamma adjustment to a color array
+/// @param rgbarray pointer to an LED array to apply an adjustment to (modified in place)
+/// @param count the number of LEDs to modify
+/// @param gamma the gamma value to apply
+extern void napplyGamma_video(CRGB *rgbarray, uint16_t count, float gamma);
+
+/// Destructively applies a gamma adjustment to a color array, per channel
+/// @param rgbarray pointer to an LED array to apply an adjustment to (modified in place)
+/// @param count the number of LEDs to modify
+/// @param gammaR the gamma value to apply to the red channel
+/// @param gammaG the gamma value to apply to the green channel
+/// @param gammaB the gamma value to apply to the blue channel
+extern void napplyGamma_video_rgb(CRGB *rgbarray, uint16_t count, float gammaR, float gammaG, float gammaB);
+
 /*
 /// @brief Same as ColorFromPalette, but with uint16_t `index` to give greater precision.
 /// @author https://github.com/generalelectrix
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __INC_LED_MATRIX_H
+#define __INC_LED_MATRIX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mini_fastled.h"
+
+/// Framebuffer for a 2D LED panel made of several physical strips.
+///
+/// Drawing is done on a logical canvas of width x height LEDs stored row by row,
+/// so canvas[y * width + x] is the LED at (x, y) and the bulk functions in
+/// colorutils.h can be used on whole rows or the whole canvas. Each strip covers
+/// a rectangular tile of the canvas and sits on its own LED channel / SPI bus.
+/// The mapping from every physical LED back to its canvas position is computed
+/// once when the strip is added, so matrix_render() is a table lookup per LED,
+/// and the channels are then sent in parallel by FastLED_show().
+
+/// Layout flags for a tile, describing how its strip snakes through it
+#define MATRIX_PROGRESSIVE  0x00 ///< every row starts on the same side
+#define MATRIX_SERPENTINE   0x01 ///< every other row runs backwards
+#define MATRIX_COLUMN_MAJOR 0x02 ///< the strip runs along the columns instead of the rows
+#define MATRIX_FLIP_X       0x04 ///< the strip starts on the right hand side of the tile
+#define MATRIX_FLIP_Y       0x08 ///< the strip starts at the bottom of the tile
+
+/// Area of the canvas driven by one strip
+typedef struct led_matrix_tile
+{
+    uint16_t x;      ///< left column of the tile on the canvas
+    uint16_t y;      ///< top row of the tile on the canvas
+    uint16_t width;  ///< columns in the tile
+    uint16_t height; ///< rows in the tile
+    unsigned flags;  ///< MATRIX_xxx layout flags
+} led_matrix_tile;
+
+/// A canvas and the strips it is rendered to
+typedef struct led_matrix
+{
+    uint16_t width;
+    uint16_t height;
+    CRGB *canvas;                                ///< width * height LEDs, row by row
+    CRGB *scratch;                               ///< scratch row for matrix_blur2d()
+    int strip_count;
+    rgb_pixel_set strips[LED_STRIP_CHANNELS];    ///< physical LEDs of each strip
+    uint32_t *strip_lut[LED_STRIP_CHANNELS];     ///< canvas index of each physical LED
+} led_matrix;
+
+/// Set up a matrix and allocate its canvas (cleared to black)
+/// @param matrix the matrix to set up
+/// @param width number of columns in the canvas
+/// @param height number of rows in the canvas
+/// @returns true on success, false if the canvas can't be allocated
+extern bool matrix_init(led_matrix *matrix, uint16_t width, uint16_t height);
+
+/// Add a strip driving one tile of the canvas. The strip is registered with
+/// FastLED_addLeds() and takes the next free LED channel.
+/// @param matrix the matrix to add the strip to
+/// @param strip_type the strip colour layout, one of the WS2811_STRIP_xxx constants
+/// @param strip_pin the SPI MOSI pin the strip is connected to (LED_CHANNEL_n_DATA_PIN)
+/// @param tile the area of the canvas covered by the strip, one LED per tile position
+/// @returns true on success, false if the tile doesn't fit on the canvas or no channel is free
+extern bool matrix_add_strip(led_matrix *matrix, unsigned strip_type, unsigned strip_pin, const led_matrix_tile *tile);
+
+/// Get the canvas LED at a position
+/// @returns a pointer to the LED, or NULL if (x, y) is outside the canvas
+static inline CRGB *matrix_xy(led_matrix *matrix, uint16_t x, uint16_t y)
+{
+    if ((x >= matrix->width) || (y >= matrix->height))
+    {
+        return NULL;
+    }
+    return &matrix->canvas[((uint32_t)y * matrix->width) + x];
+}
+
+/// Copy the canvas into the strips' LED buffers
+extern void matrix_render(led_matrix *matrix);
+
+/// Render the canvas and show it
+static inline void matrix_show(led_matrix *matrix)
+{
+    matrix_render(matrix);
+    FastLED_show();
+}
+
+/// Two-dimensional blur filter over the canvas. Spreads light to the 8 neighbours
+/// of each LED, see blur1d_leds().
+/// @param matrix the matrix to blur
+/// @param blur_amount the amount of blur to apply
+extern void matrix_blur2d(led_matrix *matrix, uint8_t blur_amount);
+
+/// Free the canvas and lookup tables. The strips' LED buffers belong to the LED
+/// channels and are freed by ws2811_fini().
+extern void matrix_cleanup(led_matrix *matrix);
+
+#endif
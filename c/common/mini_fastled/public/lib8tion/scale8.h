@@ -27,8 +27,9 @@
 /// Fast, efficient 8-bit scaling functions specifically
 /// designed for high-performance LED programming.
 ///
-/// For RaspBerry PI 4, some of these functions are now defines
-/// for the equivalent C expression.
+/// For RaspBerry PI 4, these are static inline C functions (or defines
+/// for the equivalent C expression) so per-pixel loops don't pay for a
+/// call on every byte.
 
 /// Scale one byte by a second one, which is treated as
 /// the numerator of a fraction whose denominator is 256.
@@ -38,7 +39,10 @@
 /// @param scale scale factor, in n/256 units
 /// @returns scaled value
 
-#define scale8(i, s) ((i * s) >> 8)
+static inline uint8_t scale8(uint8_t i, fract8 scale)
+{
+    return ((uint16_t)i * (uint16_t)scale) >> 8;
+}
 
 /// The "video" version of scale8() guarantees that the output will
 /// be only be zero if one or both of the inputs are zero.
@@ -50,7 +54,10 @@
 /// @returns scaled value
 /// @see scale8()
 
-#define scale8_video(i, scale) (((int)i * (int)scale) >> 8) + ((i && scale) ? 1 : 0)
+static inline uint8_t scale8_video(uint8_t i, fract8 scale)
+{
+    return (((uint16_t)i * (uint16_t)scale) >> 8) + ((i && scale) ? 1 : 0);
+}
 
 /// These functions are more efficient for scaling multiple
 /// bytes at once, but require calling cleanup_R1() afterwards.
@@ -64,7 +71,7 @@
 /// @returns scaled value
 /// @see scale8()
 
-#define scale8_LEAVING_R1_DIRTY(i, s) ((i * s) >> 8)
+#define scale8_LEAVING_R1_DIRTY(i, s) scale8(i, s)
 
 /// In place modifying version of scale8() that does not clean up the R1
 /// register on AVR. If you are doing several "scale8()'s" in a row, use this,
@@ -87,7 +94,7 @@
 /// @returns scaled value
 /// @see scale8_video()
 
-#define scale8_video_LEAVING_R1_DIRTY(i, scale) (((int)i * (int)scale) >> 8) + ((i && scale) ? 1 : 0)
+#define scale8_video_LEAVING_R1_DIRTY(i, scale) scale8_video(i, scale)
 
 /// In place modifying version of scale8_video() that does not clean up the R1
 /// register on AVR. If you are doing several "scale8_video()'s" in a row, use
@@ -116,7 +123,12 @@
 /// @param b third value to scale
 /// @param scale scale factor, in n/256 units
 
-extern void nscale8x3(uint8_t *red, uint8_t *green, uint8_t *blue, fract8 scale);
+static inline void nscale8x3(uint8_t *red, uint8_t *green, uint8_t *blue, fract8 scale)
+{
+    *red = scale8(*red, scale);
+    *green = scale8(*green, scale);
+    *blue = scale8(*blue, scale);
+}
 
 /// Scale three one-byte values by a fourth one, which is treated as
 /// the numerator of a fraction whose demominator is 256.
@@ -131,7 +143,12 @@ extern void nscale8x3(uint8_t *red, uint8_t *green, uint8_t *blue, fract8 scale)
 /// @param b third value to scale
 /// @param scale scale factor, in n/256 units
 
-extern void nscale8x3_video(uint8_t *red, uint8_t *green, uint8_t *blue, fract8 scale);
+static inline void nscale8x3_video(uint8_t *red, uint8_t *green, uint8_t *blue, fract8 scale)
+{
+    *red = scale8_video(*red, scale);
+    *green = scale8_video(*green, scale);
+    *blue = scale8_video(*blue, scale);
+}
 
 /// Scale two one-byte values by a third one, which is treated as
 /// the numerator of a fraction whose demominator is 256.
@@ -143,7 +160,11 @@ extern void nscale8x3_video(uint8_t *red, uint8_t *green, uint8_t *blue, fract8
 /// @param j second value to scale
 /// @param scale scale factor, in n/256 units
 
-extern void nscale8x2(uint8_t *i, uint8_t *j, fract8 scale);
+static inline void nscale8x2(uint8_t *i, uint8_t *j, fract8 scale)
+{
+    *i = scale8(*i, scale);
+    *j = scale8(*j, scale);
+}
 
 /// Scale two one-byte values by a third one, which is treated as
 /// the numerator of a fraction whose demominator is 256.
@@ -157,7 +178,46 @@ extern void nscale8x2(uint8_t *i, uint8_t *j, fract8 scale);
 /// @param j second value to scale
 /// @param scale scale factor, in n/256 units
 
-extern void nscale8x2_video(uint8_t *i, uint8_t *j, fract8 scale);
+static inline void nscale8x2_video(uint8_t *i, uint8_t *j, fract8 scale)
+{
+    *i = scale8_video(*i, scale);
+    *j = scale8_video(*j, scale);
+}
+
+/// Add one byte to another, saturating at 0xFF
+/// @param i first byte to add
+/// @param j second byte to add
+/// @returns the sum of i + j, capped at 0xFF
+
+static inline uint8_t qadd8(uint8_t i, uint8_t j)
+{
+    unsigned int t = i + j;
+    return (t > 255) ? 255 : t;
+}
+
+/// Subtract one byte from another, saturating at 0x00
+/// @param i byte to subtract from
+/// @param j byte to subtract
+/// @returns i - j with a floor of 0
+
+static inline uint8_t qsub8(uint8_t i, uint8_t j)
+{
+    int t = i - j;
+    return (t < 0) ? 0 : t;
+}
+
+/// Blend a variable proportion (0-255) of one byte to another.
+/// @param a the starting byte value
+/// @param b the byte value to blend toward
+/// @param amountOfB the proportion (0-255) of b to blend
+/// @returns a byte value between a and b, inclusive
+
+static inline uint8_t blend8(uint8_t a, uint8_t b, uint8_t amountOfB)
+{
+    uint16_t partial = (a * (uint16_t)(255 - amountOfB)) + (b * (uint16_t)amountOfB);
+
+    return partial >> 8;
+}
 
 /// Scale a 16-bit unsigned value by an 8-bit value, which is treated
 /// as the numerator of a fraction whose denominator is 256.
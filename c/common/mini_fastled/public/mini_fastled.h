@@ -16,6 +16,7 @@
 
 // adapted from the FastLED library (https://fastled.io/)
 
+#include <stdbool.h>
 #include <sys/neutrino.h>
 #include "rpi_ws281x.h"
 #include "color.h"
@@ -74,12 +75,20 @@ typedef struct rgb_pixel_set
     int length;
     ws2811_led_t *leds;
 
+    // running colour sums used for power limiting, kept current by the helpers below
+    // (write leds[] directly only after clearing power_valid, see FastLED_setPowerTracking)
+    uint32_t power_red;
+    uint32_t power_green;
+    uint32_t power_blue;
+    bool power_valid;
+
     ws2811_led_t *(*get)(struct rgb_pixel_set *rps, unsigned index);
     void (*copyFrom)(struct rgb_pixel_set *rps_to, int to_start, int to_end,
                      struct rgb_pixel_set *rps_from, int from_start, int from_end);
     void (*nscale8)(struct rgb_pixel_set *rps, uint8_t scale);
     void (*fadeToBlackBy)(struct rgb_pixel_set *rps, uint8_t fadefactor);
     void (*fill_rainbow)(struct rgb_pixel_set *rps, uint8_t initialhue, uint8_t deltahue);
+    void (*fill_rainbow_circular)(struct rgb_pixel_set *rps, uint8_t initialhue, bool reversed);
 } rgb_pixel_set;
 
 extern void nscale8(struct rgb_pixel_set *rps, uint8_t scale);
@@ -88,6 +97,11 @@ extern void fadeToBlackBy(struct rgb_pixel_set *rps, uint8_t fadefactor);
 /// @param initialhue the starting hue for the rainbow
 /// @param deltahue how many hue values to advance for each LED
 extern void fill_rainbow(struct rgb_pixel_set *rps, uint8_t initialhue, uint8_t deltahue);
+/// Fill all of the LEDs with a rainbow of colors, so that the hues
+/// are evenly distributed around the full circle of the set.
+/// @param initialhue the starting hue for the rainbow
+/// @param reversed whether to progress through the rainbow hues backwards
+extern void fill_rainbow_circular(struct rgb_pixel_set *rps, uint8_t initialhue, bool reversed);
 extern ws2811_led_t *get(struct rgb_pixel_set *rps, unsigned index);
 extern void copyFrom(struct rgb_pixel_set *rps_to, int to_start, int to_end,
                      struct rgb_pixel_set *rps_from, int from_start, int from_end);
@@ -103,7 +117,8 @@ extern ws2811_t ledset;
                                       .copyFrom = copyFrom,             \
                                       .nscale8 = nscale8,               \
                                       .fadeToBlackBy = fadeToBlackBy,   \
-                                      .fill_rainbow = fill_rainbow}
+                                      .fill_rainbow = fill_rainbow,     \
+                                      .fill_rainbow_circular = fill_rainbow_circular}
 
 /// Update all our controllers with the current led colors
 #define FastLED_show() FastLED_showAt(FastLED_getBrightness())
@@ -123,7 +138,14 @@ extern void FastLED_showAt(uint8_t brightness);
 /// @param write_data whether or not to write out to the leds as well
 extern void FastLED_clear(bool write_data);
 
-extern void FastLED_addLeds(unsigned strip_type, unsigned strip_pin, rgb_pixel_set *leds, unsigned number_leds);
+/// Add an LED strip on the next free channel. There is one channel per SPI bus
+/// (LED_STRIP_CHANNELS in total) and each channel is sent on its own bus.
+/// @param strip_type the strip colour layout, one of the WS2811_STRIP_xxx constants
+/// @param strip_pin the SPI MOSI pin the strip is connected to (LED_CHANNEL_n_DATA_PIN)
+/// @param leds the pixel set for the strip, allocated here if its leds are NULL
+/// @param number_leds the number of LEDs in the strip
+/// @returns true on success, false if every channel is already in use
+extern bool FastLED_addLeds(unsigned strip_type, unsigned strip_pin, rgb_pixel_set *leds, unsigned number_leds);
 
 /// Get the current global brightness setting
 /// @returns the current global brightness value
@@ -142,6 +164,27 @@ extern void FastLED_setMaxPowerInVoltsAndMilliamps(uint8_t volts, uint32_t milli
 /// @param milliwatts the max power draw desired, in milliwatts
 extern void FastLED_setMaxPowerInMilliWatts(uint32_t milliwatts);
 
+/// Use the pixel sets' running colour sums for power limiting instead of rescanning
+/// every LED on each show. Only enable this if the LED data is written through the
+/// pixel set helpers (get, copyFrom, nscale8, fadeToBlackBy, fill_rainbow, fill_rainbow_circular, FastLED_clear),
+/// or if power_valid is cleared after writing leds[] directly.
+/// @param enable true to use the running sums, false to rescan on every show
+extern void FastLED_setPowerTracking(bool enable);
+
+/// Set the maximum refresh rate. Calls to show() faster than this rate sleep until
+/// the next frame deadline instead of spinning. Call this _after_ adding all of your leds.
+/// @param refresh maximum refresh rate in hz, 0 for no limit
+extern void FastLED_setMaxRefreshRate(uint16_t refresh);
+
+/// Get the number of frames/second being written out, measured over the last second
+/// @returns the most recently computed FPS value
+extern uint16_t FastLED_getFPS();
+
+/// Get the worst deviation from the frame period seen over the last second. The period is
+/// the refresh rate period, or the time the strips need per frame if that is longer
+/// @returns the frame jitter in µs, 0 without a refresh rate limit
+extern uint32_t FastLED_getFrameJitter();
+
 /// Set a global color correction.  Sets the color correction for all added led strips,
 /// overriding whatever previous color correction those controllers may have had.
 /// @param correction A CRGB value describing the color correction.
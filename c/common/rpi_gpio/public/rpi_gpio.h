@@ -60,6 +60,30 @@
 #define GPIO26 26
 #define GPIO27 27
 
+/* Bulk (masked) messages, one bit per GPIO pin like the BCM GPSET/GPCLR/GPLEV registers.
+   Resource managers that don't handle them get one message per pin instead. */
+#ifndef RPI_GPIO_WRITE_MASK
+#define RPI_GPIO_WRITE_MASK 0x100
+#endif
+#ifndef RPI_GPIO_READ_MASK
+#define RPI_GPIO_READ_MASK 0x101
+#endif
+
+#define GPIO_MASK(gpio_pin) (1u << (gpio_pin))
+#define GPIO_ALL_MASK ((1u << GPIO_COUNT) - 1)
+
+typedef struct
+{
+    struct _io_msg hdr;
+    uint32_t mask;   // pins affected
+    uint32_t value;  // level of each masked pin, 1 for high
+} rpi_gpio_mask_msg_t;
+
+/* Peripheral base mapped for direct register access (BCM2711, RaspberryPi 4) */
+#ifndef RPI_GPIO_DIRECT_PERIPHERALS
+#define RPI_GPIO_DIRECT_PERIPHERALS RPI_4_PERIPHERALS
+#endif
+
 /* GPIO pin configuration*/
 enum gpio_config_t
 {
@@ -189,6 +213,49 @@ int rpi_gpio_output(int gpio_pin, unsigned level);
  */
 int rpi_gpio_input(int gpio_pin, unsigned *level);
 
+/**
+ * Set several GPIO pins high/low in one message
+ *
+ * @param    mask   pins to change (@ref GPIO_MASK)
+ * @param    value  new level of each pin in mask, bit set for high
+ *
+ * @returns  GPIO_SUCCESS                  on success
+ *           GPIO_ERROR_NOT_CONNECTED      if the GPIO resource manager not available to connect to
+ *           GPIO_ERROR_MSG_NOT_SENT       if command message is not sent to the GPIO resource manager
+ *           GPIO_ERROR_INPUT_OUT_OF_RANGE mask contains pins above GPIO_COUNT
+ */
+int rpi_gpio_output_mask(uint32_t mask, uint32_t value);
+
+/**
+ * Read the level of several GPIO pins in one message
+ *
+ * @param    mask   pins to read (@ref GPIO_MASK)
+ * @param    value  level of each pin in mask, bit set for high (output)
+ *
+ * @returns  GPIO_SUCCESS                  on success
+ *           GPIO_ERROR_NOT_CONNECTED      if the GPIO resource manager not available to connect to
+ *           GPIO_ERROR_MSG_NOT_SENT       if command message is not sent to the GPIO resource manager
+ *           GPIO_ERROR_INPUT_OUT_OF_RANGE mask contains pins above GPIO_COUNT
+ */
+int rpi_gpio_input_mask(uint32_t mask, uint32_t *value);
+
+/**
+ * Route level reads/writes of some pins straight to the mapped GPIO registers
+ *
+ * rpi_gpio_output/rpi_gpio_input and the mask variants then cost one register
+ * store/load for these pins instead of a resource manager round trip. Pin setup,
+ * pulls, events and PWM still go through the resource manager, which stays the
+ * default for every pin not in the mask. The process needs the rights to map
+ * physical memory.
+ *
+ * @param    mask  pins to access directly (@ref GPIO_MASK), 0 to go back to messages only
+ *
+ * @returns  GPIO_SUCCESS                  on success
+ *           GPIO_ERROR_NOT_CONNECTED      if the GPIO registers could not be mapped
+ *           GPIO_ERROR_INPUT_OUT_OF_RANGE mask contains pins above GPIO_COUNT
+ */
+int rpi_gpio_set_direct_access(uint32_t mask);
+
 /**
  * Report on a GPIO event asynchronously
  *
@@ -206,7 +273,10 @@ int rpi_gpio_input(int gpio_pin, unsigned *level);
 int rpi_gpio_add_event_detect(int gpio_pin, int coid, unsigned event, unsigned event_id);
 
 /**
- * Cleanup GPIO API resources
+ * Cleanup GPIO API resources, including the direct register mapping
+ *
+ * Direct accesses already in progress on other threads finish before the
+ * registers are unmapped; calls made after this go through the resource manager.
  *
  * @returns  GPIO_SUCCESS                  on success
  *           GPIO_ERROR_NOT_CONNECTED      if resource manager not available to connect to
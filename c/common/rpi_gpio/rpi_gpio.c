@@ -14,18 +14,37 @@
  * limitations under the License.
  */
 
+#include <errno.h>
 #include <fcntl.h>
 #include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/neutrino.h>
+
+// Keep the register pointer private to this library, apps may define their own rpi_gpio_regs
+#define __RPI_GPIO_REGS rpi_gpio_direct_regs
 #include "public/rpi_gpio.h"
 
+// Mapped GPIO registers, NULL until direct access is enabled
+uint32_t volatile *rpi_gpio_direct_regs = NULL;
+
+// Pins whose level reads/writes bypass the resource manager
+static atomic_uint gpio_direct_mask = 0;
+
+// Direct accesses in progress, rpi_gpio_cleanup waits for them before unmapping
+static atomic_uint gpio_direct_users = 0;
+
 // File descriptor to communicate with resource manager
 static int gpio_fd = -1;
 
 // Mutex protecting the GPIO message file descriptor
-static pthread_mutex_t gpio_fd_mutex;
+static pthread_mutex_t gpio_fd_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Cleared once the resource manager rejects a bulk message, so later calls go per pin.
+// Any thread may clear it, so it is atomic; a stale read only costs one more rejected message.
+static atomic_int gpio_mask_supported = 1;
 
 // Connect to the GPIO resource manager
 static int gpio_msg_connect()
@@ -103,12 +122,61 @@ static int gpio_msg_register_event(struct sigevent *event)
     return GPIO_SUCCESS;
 }
 
+// Start a direct access: returns the pins that may use the mapped registers until gpio_direct_end()
+static inline uint32_t gpio_direct_begin(void)
+{
+    // Counted before the mask is read, so cleanup either sees this access or clears the mask first
+    atomic_fetch_add(&gpio_direct_users, 1);
+    return atomic_load(&gpio_direct_mask);
+}
+
+static inline void gpio_direct_end(void)
+{
+    atomic_fetch_sub_explicit(&gpio_direct_users, 1, memory_order_release);
+}
+
+int rpi_gpio_set_direct_access(uint32_t mask)
+{
+    if (mask & ~GPIO_ALL_MASK)
+    {
+        return GPIO_ERROR_INPUT_OUT_OF_RANGE;
+    }
+
+    pthread_mutex_lock(&gpio_fd_mutex);
+
+    if (mask && !rpi_gpio_map_regs(RPI_GPIO_DIRECT_PERIPHERALS))
+    {
+        pthread_mutex_unlock(&gpio_fd_mutex);
+        perror("mmap");
+        return GPIO_ERROR_NOT_CONNECTED;
+    }
+
+    atomic_store(&gpio_direct_mask, mask);
+
+    pthread_mutex_unlock(&gpio_fd_mutex);
+
+    return GPIO_SUCCESS;
+}
+
 int rpi_gpio_cleanup()
 {
     int status = GPIO_SUCCESS;
 
     pthread_mutex_lock(&gpio_fd_mutex);
 
+    // New accesses go through the resource manager, ones in progress finish on the mapping
+    atomic_store(&gpio_direct_mask, 0);
+    while (atomic_load(&gpio_direct_users) != 0)
+    {
+        sched_yield();
+    }
+
+    if (rpi_gpio_direct_regs != NULL)
+    {
+        rpi_gpio_unmap_regs();
+        rpi_gpio_direct_regs = NULL;
+    }
+
     if (gpio_fd != -1)
     {
         status = close(gpio_fd);
@@ -265,6 +333,23 @@ int rpi_gpio_get_setup(int gpio_pin, unsigned *configuration)
 
 int rpi_gpio_output(int gpio_pin, unsigned level)
 {
+    // Direct register access: a single store to GPSET0/GPCLR0
+    uint32_t direct = gpio_direct_begin();
+    if (gpio_pin >= 0 && gpio_pin < GPIO_COUNT && (direct & GPIO_MASK(gpio_pin)))
+    {
+        int status = GPIO_ERROR_INPUT_OUT_OF_RANGE;
+
+        if (level == GPIO_LOW || level == GPIO_HIGH)
+        {
+            rpi_gpio_write(gpio_pin, level == GPIO_HIGH);
+            status = GPIO_SUCCESS;
+        }
+
+        gpio_direct_end();
+        return status;
+    }
+    gpio_direct_end();
+
     // Connect to the GPIO resource manager, if not connected already
     if (gpio_msg_connect())
     {
@@ -310,6 +395,16 @@ int rpi_gpio_output(int gpio_pin, unsigned level)
 
 int rpi_gpio_input(int gpio_pin, unsigned *level)
 {
+    // Direct register access: a single load of GPLEV0
+    uint32_t direct = gpio_direct_begin();
+    if (gpio_pin >= 0 && gpio_pin < GPIO_COUNT && (direct & GPIO_MASK(gpio_pin)))
+    {
+        *level = rpi_gpio_read(gpio_pin) ? GPIO_HIGH : GPIO_LOW;
+        gpio_direct_end();
+        return GPIO_SUCCESS;
+    }
+    gpio_direct_end();
+
     // Connect to the GPIO resource manager, if not connected already
     if (gpio_msg_connect())
     {
@@ -354,6 +449,171 @@ int rpi_gpio_input(int gpio_pin, unsigned *level)
     return GPIO_SUCCESS;
 }
 
+// Send a bulk message; returns 1 if the resource manager doesn't handle it
+static int gpio_send_mask_msg(rpi_gpio_mask_msg_t *msg, int *status)
+{
+    pthread_mutex_lock(&gpio_fd_mutex);
+
+    int err = MsgSend(gpio_fd, msg, sizeof(*msg), msg, sizeof(*msg));
+
+    pthread_mutex_unlock(&gpio_fd_mutex);
+
+    if (err == -1 && (errno == ENOSYS || errno == EINVAL))
+    {
+        atomic_store_explicit(&gpio_mask_supported, 0, memory_order_relaxed);
+        return 1;
+    }
+
+    if (err != GPIO_SUCCESS)
+    {
+        perror("MsgSend(mask)");
+        *status = GPIO_ERROR_MSG_NOT_SENT;
+    }
+    else
+    {
+        *status = GPIO_SUCCESS;
+    }
+
+    return 0;
+}
+
+int rpi_gpio_output_mask(uint32_t mask, uint32_t value)
+{
+    uint32_t direct;
+    int status;
+
+    if (mask & ~GPIO_ALL_MASK)
+    {
+        return GPIO_ERROR_INPUT_OUT_OF_RANGE;
+    }
+
+    // Direct pins: one store to each of GPSET0 and GPCLR0
+    direct = mask & gpio_direct_begin();
+    if (direct)
+    {
+        if (value & direct)
+        {
+            rpi_gpio_direct_regs[RPI_GPIO_REG_GPSET0] = value & direct;
+        }
+        if (~value & direct)
+        {
+            rpi_gpio_direct_regs[RPI_GPIO_REG_GPCLR0] = ~value & direct;
+        }
+
+        mask &= ~direct;
+    }
+    gpio_direct_end();
+
+    if (mask == 0)
+    {
+        return GPIO_SUCCESS;
+    }
+
+    // Connect to the GPIO resource manager, if not connected already
+    if (gpio_msg_connect())
+    {
+        perror("gpio_msg_connect");
+        return GPIO_ERROR_NOT_CONNECTED;
+    }
+
+    if (atomic_load_explicit(&gpio_mask_supported, memory_order_relaxed))
+    {
+        // Set and clear all masked pins at once
+        rpi_gpio_mask_msg_t msg = {
+            .hdr.type = _IO_MSG,
+            .hdr.subtype = RPI_GPIO_WRITE_MASK,
+            .hdr.mgrid = RPI_GPIO_IOMGR,
+            .mask = mask,
+            .value = value & mask};
+
+        if (gpio_send_mask_msg(&msg, &status) == 0)
+        {
+            return status;
+        }
+    }
+
+    for (int gpio_pin = 0; gpio_pin < GPIO_COUNT; gpio_pin++)
+    {
+        if (mask & GPIO_MASK(gpio_pin))
+        {
+            status = rpi_gpio_output(gpio_pin, (value & GPIO_MASK(gpio_pin)) ? GPIO_HIGH : GPIO_LOW);
+            if (status)
+            {
+                return status;
+            }
+        }
+    }
+
+    return GPIO_SUCCESS;
+}
+
+int rpi_gpio_input_mask(uint32_t mask, uint32_t *value)
+{
+    int status;
+
+    if (mask & ~GPIO_ALL_MASK)
+    {
+        return GPIO_ERROR_INPUT_OUT_OF_RANGE;
+    }
+
+    // All pins direct: one load of GPLEV0
+    uint32_t direct = gpio_direct_begin();
+    if (direct && (mask & direct) == mask)
+    {
+        *value = rpi_gpio_direct_regs[RPI_GPIO_REG_GPLEV0] & mask;
+        gpio_direct_end();
+        return GPIO_SUCCESS;
+    }
+    gpio_direct_end();
+
+    // Connect to the GPIO resource manager, if not connected already
+    if (gpio_msg_connect())
+    {
+        perror("gpio_msg_connect");
+        return GPIO_ERROR_NOT_CONNECTED;
+    }
+
+    if (atomic_load_explicit(&gpio_mask_supported, memory_order_relaxed))
+    {
+        // Read the level register once
+        rpi_gpio_mask_msg_t msg = {
+            .hdr.type = _IO_MSG,
+            .hdr.subtype = RPI_GPIO_READ_MASK,
+            .hdr.mgrid = RPI_GPIO_IOMGR,
+            .mask = mask};
+
+        if (gpio_send_mask_msg(&msg, &status) == 0)
+        {
+            if (status == GPIO_SUCCESS)
+            {
+                *value = msg.value & mask;
+            }
+            return status;
+        }
+    }
+
+    *value = 0;
+    for (int gpio_pin = 0; gpio_pin < GPIO_COUNT; gpio_pin++)
+    {
+        if (mask & GPIO_MASK(gpio_pin))
+        {
+            unsigned level;
+
+            status = rpi_gpio_input(gpio_pin, &level);
+            if (status)
+            {
+                return status;
+            }
+            if (level == GPIO_HIGH)
+            {
+                *value |= GPIO_MASK(gpio_pin);
+            }
+        }
+    }
+
+    return GPIO_SUCCESS;
+}
+
 int rpi_gpio_add_event_detect(int gpio_pin, int coid, unsigned event, unsigned event_id)
 {
     // Connect to the GPIO resource manager, if not connected already
@@ -25,6 +25,25 @@
 #define I2C_ERROR_ALLOC_FAILED -2
 #define I2C_ERROR_OPERATION_FAILED -3
 #define I2C_ERROR_CLEANING_UP -4
+#define I2C_ERROR_BAD_ARGUMENT -5
+
+/* Transaction operations */
+#define SMBUS_TRANSACTION_READ  0
+#define SMBUS_TRANSACTION_WRITE 1
+
+/* Transaction flags */
+#define SMBUS_TRANSACTION_AUTO_INCREMENT 0x01 // may share a transfer with the previous entry if its register follows on
+
+/* One register read or write in a transaction list */
+typedef struct
+{
+    uint8_t i2c_address;   // I2C address
+    uint8_t op;            // SMBUS_TRANSACTION_READ or SMBUS_TRANSACTION_WRITE
+    uint8_t flags;         // SMBUS_TRANSACTION_* flags
+    uint8_t register_val;  // first register
+    uint8_t *buffer;       // data to write, or buffer to store read data
+    uint8_t size;          // size of buffer
+} smbus_transaction_t;
 
 /* the I2C receive data message structure (allocate extra spaces for data bytes) */
 struct i2c_recv_data_msg_t
@@ -102,6 +121,27 @@ int smbus_write_byte_data(unsigned bus_number, uint8_t i2c_address, uint8_t regi
  */
 int smbus_write_block_data(unsigned bus_number, uint8_t i2c_address, uint8_t register_val, const uint8_t *block_buffer, uint8_t block_size);
 
+/**
+ * Runs a list of register reads/writes, for one or more addresses, as one transaction
+ *
+ * The bus is locked for the whole list, so no other caller's transfers are
+ * interleaved. Consecutive entries of the same kind to the same address are
+ * sent as one block transfer when the later entry has
+ * SMBUS_TRANSACTION_AUTO_INCREMENT set and its register continues where the
+ * previous one ended; only set it for devices that auto-increment the register
+ * address. The list stops at the first failed transfer.
+ *
+ * @param    bus_number          I2C bus number
+ * @param    transactions        entries to run, in order
+ * @param    transaction_count   number of entries
+ *
+ * @returns  I2C_SUCCESS                 on success,
+ *           I2C_ERROR_NOT_CONNECTED     if the i2C device is not available to connect to
+ *           I2C_ERROR_BAD_ARGUMENT      invalid entry in the list
+ *           I2C_ERROR_OPERATION_FAILED  I2C operation failed
+ */
+int smbus_transaction(unsigned bus_number, const smbus_transaction_t *transactions, unsigned transaction_count);
+
 /**
  * Clean up I2C API resources
  *
@@ -30,10 +30,33 @@
 #define MIN_WRITE_BYTES     2 // register (1) + data (1)
 #define MIN_RAW_WRITE_BYTES 1  // only data, no register
 
+#define MAX_MSG_BYTES       (1 + UINT8_MAX) // register (1) + largest block
+
 static int smbus_fd[MAX_I2C_BUSES] = { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
 
 // Mutex protecting the smbus device file descriptors
-static pthread_mutex_t smbus_fd_mutex;
+static pthread_mutex_t smbus_fd_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Mutex per bus, held across a whole transaction so other callers can't interleave
+static pthread_mutex_t smbus_bus_mutex[MAX_I2C_BUSES] = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_MUTEX_INITIALIZER };
+
+/* Receive message sized for the largest transfer, so it can live on the stack */
+typedef struct
+{
+    i2c_sendrecv_t hdr;
+    uint8_t bytes[MAX_MSG_BYTES];
+} smbus_recv_msg_t;
+
+/* Send message sized for the largest transfer, so it can live on the stack */
+typedef struct
+{
+    i2c_send_t hdr;
+    uint8_t bytes[MAX_MSG_BYTES];
+} smbus_send_msg_t;
 
 /* Open the i2C bus device */
 static
@@ -41,18 +64,25 @@ int open_smbus_fd(unsigned bus_number)
 {
     char smbus_device_name[15] = { 0 };
 
+    if (bus_number >= MAX_I2C_BUSES)
+    {
+        return I2C_ERROR_NOT_CONNECTED;
+    }
+
     pthread_mutex_lock(&smbus_fd_mutex);
 
     sprintf(smbus_device_name, I2C_FILENAME_FORMAT, bus_number);
 
     if (smbus_fd[bus_number] == -1)
     {
-        smbus_fd[bus_number] = open(smbus_device_name, O_RDWR);
-        if (smbus_fd[bus_number] < 0)
+        int fd = open(smbus_device_name, O_RDWR);
+        if (fd < 0)
         {
+            pthread_mutex_unlock(&smbus_fd_mutex);
             perror("open");
             return I2C_ERROR_NOT_CONNECTED;
         }
+        smbus_fd[bus_number] = fd;
     }
 
     pthread_mutex_unlock(&smbus_fd_mutex);
@@ -64,6 +94,11 @@ int open_smbus_fd(unsigned bus_number)
 static
 int close_smbus_fd(unsigned bus_number)
 {
+    if (bus_number >= MAX_I2C_BUSES)
+    {
+        return I2C_ERROR_NOT_CONNECTED;
+    }
+
     pthread_mutex_lock(&smbus_fd_mutex);
 
     if (smbus_fd[bus_number] != -1)
@@ -71,6 +106,7 @@ int close_smbus_fd(unsigned bus_number)
         int err = close(smbus_fd[bus_number]);
         if (err != EOK)
         {
+            pthread_mutex_unlock(&smbus_fd_mutex);
             perror("close");
             return I2C_ERROR_NOT_CONNECTED;
         }
@@ -82,109 +118,61 @@ int close_smbus_fd(unsigned bus_number)
     return I2C_SUCCESS;
 }
 
-int smbus_read_byte_data(unsigned bus_number, uint8_t i2c_address, uint8_t register_val, uint8_t *value)
+/* Send msg->bytes[0..send_len) then read recv_len bytes back into msg->bytes */
+static
+int smbus_sendrecv_msg(unsigned bus_number, uint8_t i2c_address, smbus_recv_msg_t *msg, uint32_t send_len, uint32_t recv_len)
 {
-    // error variable
     int err;
-
-    if (open_smbus_fd(bus_number))
-    {
-        perror("open_smbus_fd");
-        return I2C_ERROR_NOT_CONNECTED;
-    }
-
-    // Allocate memory for the message
-    struct i2c_recv_data_msg_t *msg = NULL;
-    msg = malloc(sizeof(struct i2c_recv_data_msg_t) + MIN_READ_BYTES); // allocate enough memory for both the calling information and received data
-    if (!msg)
-    {
-        perror("alloc failed");
-        return I2C_ERROR_ALLOC_FAILED;
-    }
-
-    // Assign which register
-    msg->bytes[0] = register_val;
+    int status; // status information about the devctl() call
 
     // Assign the I2C device and format of message
     msg->hdr.slave.addr = i2c_address;
     msg->hdr.slave.fmt = I2C_ADDRFMT_7BIT;
-    msg->hdr.send_len = 1;
-    msg->hdr.recv_len = 1;
+    msg->hdr.send_len = send_len;
+    msg->hdr.recv_len = recv_len;
     msg->hdr.stop = 1;
 
     // Send the I2C message
-    int status; // status information about the devctl() call
-    err = devctl(smbus_fd[bus_number], DCMD_I2C_SENDRECV, msg, sizeof(*msg) + 1, (&status));
+    err = devctl(smbus_fd[bus_number], DCMD_I2C_SENDRECV, msg, sizeof(msg->hdr) + (send_len > recv_len ? send_len : recv_len), &status);
     if (err != EOK)
     {
-        free(msg);
         fprintf(stderr, "error with devctl: %s\n", strerror(err));
         return I2C_ERROR_OPERATION_FAILED;
     }
 
-    // return the read data
-    *value = msg->bytes[0];
-
-    // Free allocated message
-    free(msg);
-
     return I2C_SUCCESS;
 }
 
-int smbus_read_block_data(unsigned bus_number, uint8_t i2c_address, uint8_t register_val, uint8_t *block_buffer, uint8_t block_size)
+/* Send msg->bytes[0..len) */
+static
+int smbus_send_msg(unsigned bus_number, uint8_t i2c_address, smbus_send_msg_t *msg, uint32_t len)
 {
     int err;
-
-    if (open_smbus_fd(bus_number))
-    {
-        perror("open_smbus_fd");
-        return I2C_ERROR_NOT_CONNECTED;
-    }
-
-    if (block_size < MIN_READ_BYTES) {
-        block_size = MIN_READ_BYTES;
-    }
-
-    // Allocate memory for the message
-    struct i2c_recv_data_msg_t *msg = NULL;
-    msg = malloc(sizeof(struct i2c_recv_data_msg_t) + block_size); // allocate enough memory for both the calling information and received data
-    if (!msg)
-    {
-        perror("alloc failed");
-        return I2C_ERROR_ALLOC_FAILED;
-    }
-
-    // Assign which register
-    msg->bytes[0] = register_val;
+    int status; // status information about the devctl() call
 
     // Assign the I2C device and format of message
     msg->hdr.slave.addr = i2c_address;
     msg->hdr.slave.fmt = I2C_ADDRFMT_7BIT;
-    msg->hdr.send_len = 1;
-    msg->hdr.recv_len = block_size;
+    msg->hdr.len = len;
     msg->hdr.stop = 1;
 
     // Send the I2C message
-    int status; // status information about the devctl() call
-    err = devctl(smbus_fd[bus_number], DCMD_I2C_SENDRECV, msg, sizeof(struct i2c_recv_data_msg_t) + block_size, (&status));
+    err = devctl(smbus_fd[bus_number], DCMD_I2C_SEND, msg, sizeof(msg->hdr) + len, &status);
     if (err != EOK)
     {
-        free(msg);
         fprintf(stderr, "error with devctl: %s\n", strerror(err));
         return I2C_ERROR_OPERATION_FAILED;
     }
 
-    // Save the read data
-    memcpy(block_buffer, msg->bytes, block_size);
-
-    // Free allocated message
-    free(msg);
-
     return I2C_SUCCESS;
 }
 
-int smbus_write_byte_data(unsigned bus_number, uint8_t i2c_address, uint8_t register_val, const uint8_t value)
+/* Register read with an optional register, under the bus lock */
+static
+int smbus_read(unsigned bus_number, uint8_t i2c_address, const uint8_t *register_val, uint8_t *block_buffer, uint8_t block_size)
 {
+    smbus_recv_msg_t msg;
+    uint32_t send_len = 0;
     int err;
 
     if (open_smbus_fd(bus_number))
@@ -193,42 +181,32 @@ int smbus_write_byte_data(unsigned bus_number, uint8_t i2c_address, uint8_t regi
         return I2C_ERROR_NOT_CONNECTED;
     }
 
-    // Allocate memory for the message
-    struct i2c_send_data_msg_t *msg = NULL;
-    msg = malloc(sizeof(struct i2c_send_data_msg_t) + MIN_WRITE_BYTES); // allocate enough memory for both the calling information and received data
-    if (!msg)
+    // Assign which register
+    if (register_val)
     {
-        perror("alloc failed");
-        return I2C_ERROR_ALLOC_FAILED;
+        msg.bytes[0] = *register_val;
+        send_len = 1;
     }
 
-    // Assign which register gets what value
-    msg->bytes[0] = register_val;
-    msg->bytes[1] = value;
+    pthread_mutex_lock(&smbus_bus_mutex[bus_number]);
+    err = smbus_sendrecv_msg(bus_number, i2c_address, &msg, send_len, block_size);
+    pthread_mutex_unlock(&smbus_bus_mutex[bus_number]);
 
-    // Assign the I2C device and format of message
-    msg->hdr.slave.addr = i2c_address;
-    msg->hdr.slave.fmt = I2C_ADDRFMT_7BIT;
-    msg->hdr.len = MIN_WRITE_BYTES;
-    msg->hdr.stop = 1;
-
-    // Send the I2C message
-    err = devctl(smbus_fd[bus_number], DCMD_I2C_SEND, msg, sizeof(struct i2c_send_data_msg_t) + MIN_WRITE_BYTES, NULL);
-    if (err != EOK)
+    if (err == I2C_SUCCESS)
     {
-        free(msg);
-        fprintf(stderr, "error with devctl: %s\n", strerror(err));
-        return I2C_ERROR_OPERATION_FAILED;
+        // Save the read data
+        memcpy(block_buffer, msg.bytes, block_size);
     }
 
-    // Free allocated memory
-    free(msg);
-
-    return I2C_SUCCESS;
+    return err;
 }
 
-int smbus_write_block_data(unsigned bus_number, uint8_t i2c_address, uint8_t register_val, const uint8_t *block_buffer, uint8_t block_size)
+/* Register write with an optional register, under the bus lock */
+static
+int smbus_write(unsigned bus_number, uint8_t i2c_address, const uint8_t *register_val, const uint8_t *block_buffer, uint8_t block_size)
 {
+    smbus_send_msg_t msg;
+    uint32_t len = 0;
     int err;
 
     if (open_smbus_fd(bus_number))
@@ -237,65 +215,64 @@ int smbus_write_block_data(unsigned bus_number, uint8_t i2c_address, uint8_t reg
         return I2C_ERROR_NOT_CONNECTED;
     }
 
-    if (block_size < MIN_WRITE_BYTES) {
-        block_size = MIN_WRITE_BYTES;
-    }
-
-    // Allocate memory for the message
-    struct i2c_send_data_msg_t *msg = NULL;
-    msg = malloc(sizeof(struct i2c_send_data_msg_t) + block_size + 1); // allocate enough memory for both the calling information and received data
-    if (!msg)
+    // Assign which register gets what value
+    if (register_val)
     {
-        perror("alloc failed");
-        return I2C_ERROR_ALLOC_FAILED;
+        msg.bytes[len++] = *register_val;
     }
+    memcpy(&msg.bytes[len], block_buffer, block_size);
+    len += block_size;
 
-    // Assign which register gets what value
-    msg->bytes[0] = register_val;
-    // Add the write data
-    memcpy(&msg->bytes[1], block_buffer, block_size);
+    pthread_mutex_lock(&smbus_bus_mutex[bus_number]);
+    err = smbus_send_msg(bus_number, i2c_address, &msg, len);
+    pthread_mutex_unlock(&smbus_bus_mutex[bus_number]);
 
-    // Assign the I2C device and format of message
-    msg->hdr.slave.addr = i2c_address;
-    msg->hdr.slave.fmt = I2C_ADDRFMT_7BIT;
-    msg->hdr.len = block_size + 1;
-    msg->hdr.stop = 1;
+    return err;
+}
 
-    // Send the I2C message
-    int status; // status information about the devctl() call
-    err = devctl(smbus_fd[bus_number], DCMD_I2C_SEND, msg, sizeof(struct i2c_send_data_msg_t) + block_size + 1, (&status));
-    if (err != EOK)
-    {
-        free(msg);
-        fprintf(stderr, "error with devctl: %s\n", strerror(err));
-        return I2C_ERROR_OPERATION_FAILED;
-    }
+int smbus_read_byte_data(unsigned bus_number, uint8_t i2c_address, uint8_t register_val, uint8_t *value)
+{
+    return smbus_read(bus_number, i2c_address, &register_val, value, MIN_READ_BYTES);
+}
 
-    // Free allocated message
-    free(msg);
+int smbus_read_block_data(unsigned bus_number, uint8_t i2c_address, uint8_t register_val, uint8_t *block_buffer, uint8_t block_size)
+{
+    if (block_size < MIN_READ_BYTES) {
+        block_size = MIN_READ_BYTES;
+    }
 
-    return I2C_SUCCESS;
+    return smbus_read(bus_number, i2c_address, &register_val, block_buffer, block_size);
 }
 
-int smbus_cleanup(unsigned bus_number)
+int smbus_write_byte_data(unsigned bus_number, uint8_t i2c_address, uint8_t register_val, const uint8_t value)
 {
-    int status;
+    return smbus_write(bus_number, i2c_address, &register_val, &value, 1);
+}
 
-    status = close_smbus_fd(bus_number);
-    if (status)
-    {
-        perror("close_smbus_fd");
-        status = I2C_ERROR_CLEANING_UP;
+int smbus_write_block_data(unsigned bus_number, uint8_t i2c_address, uint8_t register_val, const uint8_t *block_buffer, uint8_t block_size)
+{
+    if (block_size < MIN_WRITE_BYTES) {
+        block_size = MIN_WRITE_BYTES;
     }
 
-    return I2C_SUCCESS;
+    return smbus_write(bus_number, i2c_address, &register_val, block_buffer, block_size);
 }
 
+/* Entries can share one devctl when they continue the previous entry's register run */
+static
+int smbus_can_merge(const smbus_transaction_t *prev, const smbus_transaction_t *next, uint32_t run_size)
+{
+    return (next->flags & SMBUS_TRANSACTION_AUTO_INCREMENT) &&
+           next->op == prev->op &&
+           next->i2c_address == prev->i2c_address &&
+           next->register_val == (uint8_t)(prev->register_val + prev->size) &&
+           run_size + next->size <= UINT8_MAX;
+}
 
-int smbus_read_byte(unsigned bus_number, uint8_t i2c_address, uint8_t *value)
+int smbus_transaction(unsigned bus_number, const smbus_transaction_t *transactions, unsigned transaction_count)
 {
-    // error variable
-    int err;
+    int err = I2C_SUCCESS;
+    unsigned i;
 
     if (open_smbus_fd(bus_number))
     {
@@ -303,177 +280,117 @@ int smbus_read_byte(unsigned bus_number, uint8_t i2c_address, uint8_t *value)
         return I2C_ERROR_NOT_CONNECTED;
     }
 
-    // Allocate memory for the message
-    struct i2c_recv_data_msg_t *msg = NULL;
-    msg = malloc(sizeof(struct i2c_recv_data_msg_t) + MIN_READ_BYTES); // allocate enough memory for both the calling information and received data
-    if (!msg)
+    if (transactions == NULL)
     {
-        perror("alloc failed");
-        return I2C_ERROR_ALLOC_FAILED;
+        return I2C_ERROR_BAD_ARGUMENT;
     }
 
-    // Assign the I2C device and format of message
-    msg->hdr.slave.addr = i2c_address;
-    msg->hdr.slave.fmt = I2C_ADDRFMT_7BIT;
-    msg->hdr.send_len = 0; // no register to send
-    msg->hdr.recv_len = 1; // read 1 byte
-    msg->hdr.stop = 1;
-
-    // Send the I2C message
-    int status; // status information about the devctl() call
-    err = devctl(smbus_fd[bus_number], DCMD_I2C_SENDRECV, msg, sizeof(*msg) + 1, (&status));
-    if (err != EOK)
+    for (i = 0; i < transaction_count; i++)
     {
-        free(msg);
-        fprintf(stderr, "error with devctl: %s\n", strerror(err));
-        return I2C_ERROR_OPERATION_FAILED;
-    }
+        const smbus_transaction_t *t = &transactions[i];
 
-    // return the read data
-    *value = msg->bytes[0];
+        if (t->buffer == NULL || t->size < 1 || (t->op != SMBUS_TRANSACTION_READ && t->op != SMBUS_TRANSACTION_WRITE))
+        {
+            return I2C_ERROR_BAD_ARGUMENT;
+        }
+    }
 
-    // Free allocated message
-    free(msg);
+    pthread_mutex_lock(&smbus_bus_mutex[bus_number]);
 
-    return I2C_SUCCESS;
-}
+    i = 0;
+    while (i < transaction_count && err == I2C_SUCCESS)
+    {
+        const smbus_transaction_t *first = &transactions[i];
+        uint32_t run_size = first->size;
+        unsigned end = i + 1;
+        unsigned j;
 
-int smbus_read_block(unsigned bus_number, uint8_t i2c_address, uint8_t *block_buffer, uint8_t block_size)
-{
-    int err;
+        // Extend the run while the registers stay contiguous
+        while (end < transaction_count && smbus_can_merge(&transactions[end - 1], &transactions[end], run_size))
+        {
+            run_size += transactions[end].size;
+            end++;
+        }
 
-    if (open_smbus_fd(bus_number))
-    {
-        perror("open_smbus_fd");
-        return I2C_ERROR_NOT_CONNECTED;
-    }
+        if (first->op == SMBUS_TRANSACTION_READ)
+        {
+            smbus_recv_msg_t msg;
+            uint32_t offset = 0;
+
+            msg.bytes[0] = first->register_val;
+            err = smbus_sendrecv_msg(bus_number, first->i2c_address, &msg, 1, run_size);
+
+            // Scatter the block back to each entry
+            for (j = i; j < end && err == I2C_SUCCESS; j++)
+            {
+                memcpy(transactions[j].buffer, &msg.bytes[offset], transactions[j].size);
+                offset += transactions[j].size;
+            }
+        }
+        else
+        {
+            smbus_send_msg_t msg;
+            uint32_t len = 1;
 
-    if (block_size < MIN_READ_BYTES) {
-        block_size = MIN_READ_BYTES;
-    }
+            msg.bytes[0] = first->register_val;
 
-    // Allocate memory for the message
-    struct i2c_recv_data_msg_t *msg = NULL;
-    msg = malloc(sizeof(struct i2c_recv_data_msg_t) + block_size); // allocate enough memory for both the calling information and received data
-    if (!msg)
-    {
-        perror("alloc failed");
-        return I2C_ERROR_ALLOC_FAILED;
-    }
+            // Gather every entry of the run behind the one register byte
+            for (j = i; j < end; j++)
+            {
+                memcpy(&msg.bytes[len], transactions[j].buffer, transactions[j].size);
+                len += transactions[j].size;
+            }
 
-    // Assign the I2C device and format of message
-    msg->hdr.slave.addr = i2c_address;
-    msg->hdr.slave.fmt = I2C_ADDRFMT_7BIT;
-    msg->hdr.send_len = 0;
-    msg->hdr.recv_len = block_size;
-    msg->hdr.stop = 1;
+            err = smbus_send_msg(bus_number, first->i2c_address, &msg, len);
+        }
 
-    // Send the I2C message
-    int status; // status information about the devctl() call
-    err = devctl(smbus_fd[bus_number], DCMD_I2C_SENDRECV, msg, sizeof(struct i2c_recv_data_msg_t) + block_size, (&status));
-    if (err != EOK)
-    {
-        free(msg);
-        fprintf(stderr, "error with devctl: %s\n", strerror(err));
-        return I2C_ERROR_OPERATION_FAILED;
+        i = end;
     }
 
-    // Save the read data
-    memcpy(block_buffer, msg->bytes, block_size);
-
-    // Free allocated message
-    free(msg);
+    pthread_mutex_unlock(&smbus_bus_mutex[bus_number]);
 
-    return I2C_SUCCESS;
+    return err;
 }
 
-int smbus_write_byte(unsigned bus_number, uint8_t i2c_address, const uint8_t value)
+int smbus_cleanup(unsigned bus_number)
 {
-    int err;
+    int status;
 
-    if (open_smbus_fd(bus_number))
+    status = close_smbus_fd(bus_number);
+    if (status)
     {
-        perror("open_smbus_fd");
-        return I2C_ERROR_NOT_CONNECTED;
+        perror("close_smbus_fd");
+        status = I2C_ERROR_CLEANING_UP;
     }
 
-    // Allocate memory for the message
-    struct i2c_send_data_msg_t *msg = NULL;
-    msg = malloc(sizeof(struct i2c_send_data_msg_t) + MIN_RAW_WRITE_BYTES); // allocate enough memory for both the calling information and received data
-    if (!msg)
-    {
-        perror("alloc failed");
-        return I2C_ERROR_ALLOC_FAILED;
-    }
+    return I2C_SUCCESS;
+}
 
-    // Assign which register gets what value
-    msg->bytes[0] = value;
 
-    // Assign the I2C device and format of message
-    msg->hdr.slave.addr = i2c_address;
-    msg->hdr.slave.fmt = I2C_ADDRFMT_7BIT;
-    msg->hdr.len = MIN_RAW_WRITE_BYTES;
-    msg->hdr.stop = 1;
+int smbus_read_byte(unsigned bus_number, uint8_t i2c_address, uint8_t *value)
+{
+    return smbus_read(bus_number, i2c_address, NULL, value, MIN_READ_BYTES);
+}
 
-    // Send the I2C message
-    err = devctl(smbus_fd[bus_number], DCMD_I2C_SEND, msg, sizeof(struct i2c_send_data_msg_t) + MIN_RAW_WRITE_BYTES, NULL);
-    if (err != EOK)
-    {
-        free(msg);
-        fprintf(stderr, "error with devctl: %s\n", strerror(err));
-        return I2C_ERROR_OPERATION_FAILED;
+int smbus_read_block(unsigned bus_number, uint8_t i2c_address, uint8_t *block_buffer, uint8_t block_size)
+{
+    if (block_size < MIN_READ_BYTES) {
+        block_size = MIN_READ_BYTES;
     }
 
-    // Free allocated memory
-    free(msg);
+    return smbus_read(bus_number, i2c_address, NULL, block_buffer, block_size);
+}
 
-    return I2C_SUCCESS;
+int smbus_write_byte(unsigned bus_number, uint8_t i2c_address, const uint8_t value)
+{
+    return smbus_write(bus_number, i2c_address, NULL, &value, MIN_RAW_WRITE_BYTES);
 }
 
 int smbus_write_block(unsigned bus_number, uint8_t i2c_address, const uint8_t *block_buffer, uint8_t block_size)
 {
-    int err;
-
-    if (open_smbus_fd(bus_number))
-    {
-        perror("open_smbus_fd");
-        return I2C_ERROR_NOT_CONNECTED;
-    }
-
     if (block_size < MIN_RAW_WRITE_BYTES) {
         block_size = MIN_RAW_WRITE_BYTES;
     }
 
-    // Allocate memory for the message
-    struct i2c_send_data_msg_t *msg = NULL;
-    msg = malloc(sizeof(struct i2c_send_data_msg_t) + block_size); // allocate enough memory for both the calling information and received data
-    if (!msg)
-    {
-        perror("alloc failed");
-        return I2C_ERROR_ALLOC_FAILED;
-    }
-
-    // Add the write data
-    memcpy(msg->bytes, block_buffer, block_size);
-
-    // Assign the I2C device and format of message
-    msg->hdr.slave.addr = i2c_address;
-    msg->hdr.slave.fmt = I2C_ADDRFMT_7BIT;
-    msg->hdr.len = block_size;
-    msg->hdr.stop = 1;
-
-    // Send the I2C message
-    int status; // status information about the devctl() call
-    err = devctl(smbus_fd[bus_number], DCMD_I2C_SEND, msg, sizeof(struct i2c_send_data_msg_t) + block_size, (&status));
-    if (err != EOK)
-    {
-        free(msg);
-        fprintf(stderr, "error with devctl: %s\n", strerror(err));
-        return I2C_ERROR_OPERATION_FAILED;
-    }
-
-    // Free allocated message
-    free(msg);
-
-    return I2C_SUCCESS;
+    return smbus_write(bus_number, i2c_address, NULL, block_buffer, block_size);
 }
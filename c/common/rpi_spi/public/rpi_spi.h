@@ -44,6 +44,17 @@
 #define SPI_ERROR_BAD_ARGUMENT -2
 #define SPI_ERROR_OPERATION_FAILED -3
 
+/* Most transfers rpi_spi_write_read_batch accepts in one call */
+#define RPI_SPI_MAX_BATCH 16
+
+/* One entry of a batched exchange */
+typedef struct
+{
+    uint8_t *write_data_buffer;  // data to write
+    uint8_t *read_data_buffer;   // buffer to copy read data to (NULL if not required)
+    uint32_t data_size;          // size of both buffers
+} rpi_spi_transfer_t;
+
 /**
  * Query the SPI driver
  *
@@ -104,6 +115,60 @@ int rpi_spi_write_read_data(unsigned bus_number, unsigned device_number,
                             uint8_t *read_data_buffer,
                             uint32_t data_size);
 
+/**
+ * Write/read several buffers in one exchange (one devctl round trip)
+ *
+ * The buffers go out back to back as a single transfer, so chip select stays
+ * asserted across them. Nothing is copied: the write buffers are gathered into
+ * the message and the reply is scattered into the read buffers. Read data is
+ * positional, so it is only returned up to the first transfer without a read buffer.
+ *
+ * @param    bus_number          SPI bus number
+ * @param    device_number       SPI device number
+ * @param    transfers           transfers to perform, in order
+ * @param    transfer_count      number of transfers (1 to RPI_SPI_MAX_BATCH)
+ *
+ * @returns  SPI_SUCCESS                on success,
+ *           SPI_ERROR_NOT_CONNECTED    if the SPI device is not available to connect to
+ *           SPI_ERROR_BAD_ARGUMENT     invalid transfer list provided
+ *           SPI_ERROR_OPERATION_FAILED SPI operation failed
+ */
+int rpi_spi_write_read_batch(unsigned bus_number, unsigned device_number,
+                             const rpi_spi_transfer_t *transfers,
+                             unsigned transfer_count);
+
+/**
+ * Get the device's persistent exchange buffer to encode data into directly
+ *
+ * The buffer grows to at least data_size bytes and is kept until
+ * rpi_spi_cleanup_device. The returned pointer is only valid until the next
+ * call for the same device, and only one thread should use a device this way.
+ *
+ * @param    bus_number          SPI bus number
+ * @param    device_number       SPI device number
+ * @param    data_size           payload size required
+ *
+ * @returns  pointer to the payload on success, NULL on bad arguments or allocation failure
+ */
+uint8_t *rpi_spi_get_exchange_buffer(unsigned bus_number, unsigned device_number, uint32_t data_size);
+
+/**
+ * Write/read the first data_size bytes of the device's exchange buffer in place
+ *
+ * The read data replaces the written data in the buffer returned by
+ * rpi_spi_get_exchange_buffer.
+ *
+ * @param    bus_number          SPI bus number
+ * @param    device_number       SPI device number
+ * @param    data_size           number of bytes to exchange
+ *
+ * @returns  SPI_SUCCESS                on success,
+ *           SPI_ERROR_NOT_CONNECTED    if the SPI device is not available to connect to
+ *           SPI_ERROR_BAD_ARGUMENT     no exchange buffer of that size
+ *           SPI_ERROR_OPERATION_FAILED SPI operation failed
+ */
+int rpi_spi_exchange(unsigned bus_number, unsigned device_number, uint32_t data_size);
+
 /**
  * Cleanup from using the SPI device
  *
@@ -16,9 +16,12 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
+#include <devctl.h>
+#include <pthread.h>
 #include "public/rpi_spi.h"
 
 #define SPI_DEVICE_FILENAME_FORMAT "/dev/io-spi/spi%d/dev%d"
@@ -35,13 +38,22 @@ static int spi_device_fd[MAX_SPI_BUSES][MAX_SPI_BUS_DEVICES] = {
     {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1}};
 
 // Mutex protecting the SPI device file descriptors
-static pthread_mutex_t spi_fd_mutex;
+static pthread_mutex_t spi_fd_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Persistent exchange buffer per device, grown on demand and kept until cleanup
+static spi_xchng_t *spi_device_xchng[MAX_SPI_BUSES][MAX_SPI_BUS_DEVICES];
+static uint32_t spi_device_xchng_size[MAX_SPI_BUSES][MAX_SPI_BUS_DEVICES];
 
 /* Open the SPI device */
 static int
 open_spi_device_fd(unsigned bus_number, unsigned device_number)
 {
-    char spi_device_name[20] = {0};
+    char spi_device_name[32] = {0};
+
+    if (bus_number >= MAX_SPI_BUSES || device_number >= MAX_SPI_BUS_DEVICES)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
 
     sprintf(spi_device_name, SPI_DEVICE_FILENAME_FORMAT, bus_number, device_number);
 
@@ -49,12 +61,14 @@ open_spi_device_fd(unsigned bus_number, unsigned device_number)
 
     if (spi_device_fd[bus_number][device_number] == -1)
     {
-        spi_device_fd[bus_number][device_number] = open(spi_device_name, O_RDWR);
-        if (spi_device_fd[bus_number][device_number] < 0)
+        int fd = open(spi_device_name, O_RDWR);
+        if (fd < 0)
         {
+            pthread_mutex_unlock(&spi_fd_mutex);
             perror("open");
             return SPI_ERROR_NOT_CONNECTED;
         }
+        spi_device_fd[bus_number][device_number] = fd;
     }
 
     pthread_mutex_unlock(&spi_fd_mutex);
@@ -66,6 +80,11 @@ open_spi_device_fd(unsigned bus_number, unsigned device_number)
 static int
 close_spi_device_fd(unsigned bus_number, unsigned device_number)
 {
+    if (bus_number >= MAX_SPI_BUSES || device_number >= MAX_SPI_BUS_DEVICES)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
     pthread_mutex_lock(&spi_fd_mutex);
 
     if (spi_device_fd[bus_number][device_number] != -1)
@@ -73,12 +92,17 @@ close_spi_device_fd(unsigned bus_number, unsigned device_number)
         int err = close(spi_device_fd[bus_number][device_number]);
         if (err != EOK)
         {
+            pthread_mutex_unlock(&spi_fd_mutex);
             perror("close");
             return SPI_ERROR_NOT_CONNECTED;
         }
         spi_device_fd[bus_number][device_number] = -1;
     }
 
+    free(spi_device_xchng[bus_number][device_number]);
+    spi_device_xchng[bus_number][device_number] = NULL;
+    spi_device_xchng_size[bus_number][device_number] = 0;
+
     pthread_mutex_unlock(&spi_fd_mutex);
 
     return SPI_SUCCESS;
@@ -170,6 +194,24 @@ int rpi_spi_write_read_data(unsigned bus_number, unsigned device_number,
                             uint8_t *read_data_buffer,
                             uint32_t data_size)
 {
+    rpi_spi_transfer_t transfer = {
+        .write_data_buffer = write_data_buffer,
+        .read_data_buffer = read_data_buffer,
+        .data_size = data_size};
+
+    return rpi_spi_write_read_batch(bus_number, device_number, &transfer, 1);
+}
+
+int rpi_spi_write_read_batch(unsigned bus_number, unsigned device_number,
+                             const rpi_spi_transfer_t *transfers,
+                             unsigned transfer_count)
+{
+    iov_t send_iov[RPI_SPI_MAX_BATCH + 1];
+    iov_t reply_iov[RPI_SPI_MAX_BATCH + 1];
+    spi_xchng_t header;
+    spi_xchng_t reply_header;
+    uint32_t total_size = 0;
+    int reply_parts = 1;
     int err;
 
     if (open_spi_device_fd(bus_number, device_number))
@@ -178,55 +220,110 @@ int rpi_spi_write_read_data(unsigned bus_number, unsigned device_number,
         return SPI_ERROR_NOT_CONNECTED;
     }
 
-    if (data_size < 1)
+    if (transfers == NULL || transfer_count < 1 || transfer_count > RPI_SPI_MAX_BATCH)
     {
-        perror("invalid data size");
+        perror("invalid transfer list");
         return SPI_ERROR_BAD_ARGUMENT;
     }
 
-    if (write_data_buffer == NULL)
+    // Gather the header and every write buffer into one message, and scatter the
+    // reply straight into the read buffers, so nothing is allocated or copied
+    for (unsigned i = 0; i < transfer_count; i++)
     {
-        perror("invalid write data buffer pointer");
-        return SPI_ERROR_BAD_ARGUMENT;
-    }
+        if (transfers[i].data_size < 1)
+        {
+            perror("invalid data size");
+            return SPI_ERROR_BAD_ARGUMENT;
+        }
 
-    // Allocate memory for the message
-    spi_xchng_t *spi_xchng_msg = NULL;
-    spi_xchng_msg = malloc(sizeof(spi_xchng_t) + data_size); // allocate enough memory for the data
-    if (!spi_xchng_msg)
-    {
-        perror("alloc failed");
-        return -1;
+        if (transfers[i].write_data_buffer == NULL)
+        {
+            perror("invalid write data buffer pointer");
+            return SPI_ERROR_BAD_ARGUMENT;
+        }
+
+        SETIOV(&send_iov[i + 1], transfers[i].write_data_buffer, transfers[i].data_size);
+        total_size += transfers[i].data_size;
     }
 
-    // Add the data to write
-    spi_xchng_msg->nbytes = data_size;
-    for (int i = 0; i < data_size; i++)
+    // Read data is positional, so once a transfer has no read buffer the rest of the reply is dropped
+    for (unsigned i = 0; i < transfer_count && transfers[i].read_data_buffer != NULL; i++)
     {
-        spi_xchng_msg->data[i] = write_data_buffer[i];
+        SETIOV(&reply_iov[reply_parts], transfers[i].read_data_buffer, transfers[i].data_size);
+        reply_parts++;
     }
 
+    memset(&header, 0, sizeof(header));
+    header.nbytes = total_size;
+    SETIOV(&send_iov[0], &header, sizeof(header));
+    SETIOV(&reply_iov[0], &reply_header, sizeof(reply_header));
+
     // Send the SPI message
-    err = devctl(spi_device_fd[bus_number][device_number], DCMD_SPI_DATA_XCHNG, spi_xchng_msg, sizeof(spi_xchng_t) + data_size, NULL);
+    err = devctlv(spi_device_fd[bus_number][device_number], DCMD_SPI_DATA_XCHNG,
+                  transfer_count + 1, reply_parts, send_iov, reply_iov, NULL);
     if (err != EOK)
     {
-        free(spi_xchng_msg);
         fprintf(stderr, "error: %d\n", err);
-        perror("devctl");
+        perror("devctlv");
         return SPI_ERROR_OPERATION_FAILED;
     }
 
-    // Copy the read data (if a buffer is provided)
-    if (read_data_buffer != NULL)
+    return SPI_SUCCESS;
+}
+
+uint8_t *rpi_spi_get_exchange_buffer(unsigned bus_number, unsigned device_number, uint32_t data_size)
+{
+    spi_xchng_t *spi_xchng_msg;
+
+    if (bus_number >= MAX_SPI_BUSES || device_number >= MAX_SPI_BUS_DEVICES || data_size < 1)
+    {
+        return NULL;
+    }
+
+    // Grow only; the payload is reused for every exchange on this device
+    if (data_size > spi_device_xchng_size[bus_number][device_number])
     {
-        for (int i = 0; i < data_size; i++)
+        spi_xchng_msg = realloc(spi_device_xchng[bus_number][device_number], sizeof(spi_xchng_t) + data_size);
+        if (!spi_xchng_msg)
         {
-            read_data_buffer[i] = spi_xchng_msg->data[i];
+            perror("alloc failed");
+            return NULL;
         }
+
+        spi_device_xchng[bus_number][device_number] = spi_xchng_msg;
+        spi_device_xchng_size[bus_number][device_number] = data_size;
+    }
+
+    return spi_device_xchng[bus_number][device_number]->data;
+}
+
+int rpi_spi_exchange(unsigned bus_number, unsigned device_number, uint32_t data_size)
+{
+    spi_xchng_t *spi_xchng_msg;
+    int err;
+
+    if (open_spi_device_fd(bus_number, device_number))
+    {
+        perror("open_spi_device_fd");
+        return SPI_ERROR_NOT_CONNECTED;
+    }
+
+    spi_xchng_msg = spi_device_xchng[bus_number][device_number];
+    if (spi_xchng_msg == NULL || data_size < 1 || data_size > spi_device_xchng_size[bus_number][device_number])
+    {
+        perror("invalid data size");
+        return SPI_ERROR_BAD_ARGUMENT;
     }
 
-    // Free allocated message
-    free(spi_xchng_msg);
+    // Send the SPI message; the read data replaces the payload in place
+    spi_xchng_msg->nbytes = data_size;
+    err = devctl(spi_device_fd[bus_number][device_number], DCMD_SPI_DATA_XCHNG, spi_xchng_msg, sizeof(spi_xchng_t) + data_size, NULL);
+    if (err != EOK)
+    {
+        fprintf(stderr, "error: %d\n", err);
+        perror("devctl");
+        return SPI_ERROR_OPERATION_FAILED;
+    }
 
     return SPI_SUCCESS;
 }
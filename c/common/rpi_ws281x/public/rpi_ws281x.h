@@ -123,6 +123,7 @@ typedef struct ws2811_t
     uint64_t render_wait_time;                   //< time in µs before the next render can run
     struct ws2811_device *device;                //< Private data for driver use
     uint32_t freq;                               //< Required output frequency
+    int double_buffer;                           //< Send from a transmit thread while the next frame is encoded
     ws2811_channel_t channel[LED_STRIP_CHANNELS];
 } ws2811_t;
 
@@ -165,6 +166,11 @@ void ws2811_fini(ws2811_t *ws2811);
 /**
  * Render the pixel buffer from the user supplied LED arrays.
  * This will update all LEDs on both PWM channels.
+ * Each channel is encoded once and sent on its own SPI bus, in parallel with the others.
+ *
+ * With double_buffer set, the LEDs are encoded into a back buffer and handed to the
+ * transmit thread, so this only blocks while the previous frame is still being sent.
+ * The LED arrays may be modified again as soon as this returns.
  *
  * @param    ws2811  ws2811 instance pointer.
  *
@@ -174,6 +180,8 @@ ws2811_return_t ws2811_render(ws2811_t *ws2811);
 
 /**
  * Wait for any executing operation to complete before returning.
+ * With double_buffer set, this blocks until the last rendered frame has left the wire
+ * and reports any SPI error from sending it.
  *
  * @param    ws2811  ws2811 instance pointer.
  *
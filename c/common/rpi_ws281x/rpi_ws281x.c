@@ -43,11 +43,17 @@
 
 #include <fcntl.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/neutrino.h>
 
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "public/rpi_ws281x.h"
 
 // Driver mode definitions
@@ -78,10 +84,50 @@
 // Pad out to the nearest uint32 + 32-bits for idle low/high times the number of channels
 #define SPI_BYTE_COUNT(leds) (PREAMBLE_BYTES + ((LED_BIT_COUNT(leds) & ~0x7) + 4) + 4)
 
+// Per-channel encoding table: brightness, gamma and invert folded into the SPI
+// symbols for each wire position, so every color byte is one 64-bit store
+typedef struct
+{
+    uint64_t word[LED_COLORS][256];              //< 8 SPI symbols per input byte, wire order
+    uint8_t level[LED_COLORS][256];              //< brightness and gamma applied, before encoding
+    uint8_t gamma[256 * LED_COLORS];             //< gamma table the entries were built from
+    uint8_t brightness;
+    uint8_t invert_mask;
+    bool valid;
+} ws2811_encode_lut_t;
+
+// One SPI exchange handed to a channel's transmit thread
+typedef struct
+{
+    uint64_t wait_time;                          //< reset time in µs the line stays low after this exchange
+} ws2811_tx_job_t;
+
+// SPI buffers and transmit thread for one LED channel; each channel owns its bus
+typedef struct
+{
+    struct ws2811_t *ws2811;
+    int chan;
+    uint8_t *pxl_raw;                            //< buffer on the wire (or about to be)
+    uint8_t *pxl_back;                           //< buffer being encoded, double-buffered mode only
+    uint32_t byte_count;                         //< SPI_BYTE_COUNT of this channel's LEDs
+
+    bool tx_running;
+    pthread_t tx_thread;
+    pthread_mutex_t tx_lock;
+    pthread_cond_t tx_cond;
+    bool tx_pending;
+    bool tx_busy;
+    bool tx_stop;
+    ws2811_tx_job_t tx_job;
+    ws2811_return_t tx_result;
+    uint64_t tx_latch_until;
+} ws2811_spi_channel_t;
+
 typedef struct ws2811_device
 {
     int driver_mode;
-    uint8_t *pxl_raw;
+    ws2811_encode_lut_t lut[LED_STRIP_CHANNELS];
+    ws2811_spi_channel_t spi[LED_STRIP_CHANNELS];
     int spi_bus_number[LED_STRIP_CHANNELS];
     int spi_device_number[LED_STRIP_CHANNELS];
     int max_count;
@@ -106,11 +152,20 @@ static uint64_t get_microsecond_timestamp()
     return (uint64_t)t.tv_sec * 1000000 + t.tv_nsec / 1000;
 }
 
+static ws2811_return_t spi_transmit_start(ws2811_spi_channel_t *spi);
+static void spi_transmit_stop(ws2811_spi_channel_t *spi);
+
 static void ws2811_cleanup(ws2811_t *ws2811)
 {
     ws2811_device_t *device = ws2811->device;
     int chan;
 
+    // Stop every transmit thread before any buffer goes away
+    for (chan = 0; device && (chan < LED_STRIP_CHANNELS); chan++)
+    {
+        spi_transmit_stop(&device->spi[chan]);
+    }
+
     for (chan = 0; chan < LED_STRIP_CHANNELS; chan++)
     {
         if (ws2811->channel[chan].leds)
@@ -129,6 +184,12 @@ static void ws2811_cleanup(ws2811_t *ws2811)
         {
             rpi_spi_cleanup_device(device->spi_bus_number[chan], device->spi_device_number[chan]);
         }
+
+        if (device)
+        {
+            free(device->spi[chan].pxl_raw);
+            free(device->spi[chan].pxl_back);
+        }
     }
 
     if (device)
@@ -139,10 +200,17 @@ static void ws2811_cleanup(ws2811_t *ws2811)
     ws2811->device = NULL;
 }
 
+// A channel is sent only if it has LEDs and a bus to send them on
+static bool spi_channel_used(const ws2811_t *ws2811, int chan)
+{
+    return (ws2811->device->spi_bus_number[chan] != -1) && (ws2811->channel[chan].count > 0);
+}
+
 static ws2811_return_t spi_init(ws2811_t *ws2811)
 {
     int chan;
     ws2811_device_t *device = ws2811->device;
+    ws2811_return_t ret;
 
     // initialize SPI devices indicated in the provided configuration
     for (chan = 0; chan < LED_STRIP_CHANNELS; chan++)
@@ -156,45 +224,213 @@ static ws2811_return_t spi_init(ws2811_t *ws2811)
         }
     }
 
-    // Allocate SPI transmit buffer (same size as PCM)
-    device->pxl_raw = malloc(SPI_BYTE_COUNT(device->max_count));
-    if (device->pxl_raw == NULL)
+    // Allocate one SPI transmit buffer per channel (two when double-buffered), sized
+    // for that channel's LEDs, and start the thread that sends it on its bus
+    for (chan = 0; chan < LED_STRIP_CHANNELS; chan++)
     {
-        ws2811_cleanup(ws2811);
-        return WS2811_ERROR_OUT_OF_MEMORY;
+        ws2811_spi_channel_t *spi = &device->spi[chan];
+
+        if (!spi_channel_used(ws2811, chan))
+        {
+            continue;
+        }
+
+        spi->ws2811 = ws2811;
+        spi->chan = chan;
+        spi->byte_count = SPI_BYTE_COUNT(ws2811->channel[chan].count);
+
+        // The preamble and padding are never written again, so start from zero
+        spi->pxl_raw = calloc(1, spi->byte_count);
+        if (ws2811->double_buffer)
+        {
+            spi->pxl_back = calloc(1, spi->byte_count);
+        }
+
+        if ((spi->pxl_raw == NULL) || (ws2811->double_buffer && (spi->pxl_back == NULL)))
+        {
+            ws2811_cleanup(ws2811);
+            return WS2811_ERROR_OUT_OF_MEMORY;
+        }
+
+        if ((ret = spi_transmit_start(spi)) != WS2811_SUCCESS)
+        {
+            ws2811_cleanup(ws2811);
+            return ret;
+        }
     }
 
-    uint32_t *pxl_raw = (uint32_t *)device->pxl_raw;
-    int maxcount = device->max_count;
-    int wordcount = LED_COUNT(maxcount) / sizeof(uint32_t);
-    int i;
+    return WS2811_SUCCESS;
+}
+
+static ws2811_return_t spi_transfer(ws2811_t *ws2811, int chan)
+{
+    ws2811_spi_channel_t *spi = &ws2811->device->spi[chan];
 
-    for (i = 0; i < wordcount; i++)
+    if (rpi_spi_write_read_data(ws2811->device->spi_bus_number[chan], ws2811->device->spi_device_number[chan],
+                                spi->pxl_raw, NULL, spi->byte_count))
     {
-        pxl_raw[i] = 0x0;
+        return WS2811_ERROR_SPI_TRANSFER;
     }
 
     return WS2811_SUCCESS;
 }
 
-static ws2811_return_t spi_transfer(ws2811_t *ws2811, int chan)
+// Sends each buffer submitted for one channel and keeps its reset latch. The
+// channels run in parallel on their own buses, and in double-buffered mode the
+// caller encodes the next frame while this one is on the wire.
+static void *spi_transmit_thread(void *arg)
 {
-    // initialize SPI devices indicated in the provided configuration
-    for (chan = 0; chan < LED_STRIP_CHANNELS; chan++)
+    ws2811_spi_channel_t *spi = arg;
+
+    pthread_mutex_lock(&spi->tx_lock);
+    while (1)
     {
-        if (ws2811->device->spi_bus_number[chan] != -1)
+        ws2811_tx_job_t job;
+        ws2811_return_t ret;
+        uint64_t current_timestamp;
+
+        while (!spi->tx_pending && !spi->tx_stop)
         {
-            if (rpi_spi_write_read_data(ws2811->device->spi_bus_number[chan], ws2811->device->spi_device_number[chan],
-                                        ws2811->device->pxl_raw, NULL, SPI_BYTE_COUNT(ws2811->device->max_count)))
-            {
-                return WS2811_ERROR_SPI_TRANSFER;
-            }
+            pthread_cond_wait(&spi->tx_cond, &spi->tx_lock);
         }
+
+        if (!spi->tx_pending)
+        {
+            break;
+        }
+
+        job = spi->tx_job;
+        spi->tx_pending = false;
+        spi->tx_busy = true;
+        pthread_mutex_unlock(&spi->tx_lock);
+
+        current_timestamp = get_microsecond_timestamp();
+        if (spi->tx_latch_until > current_timestamp)
+        {
+            usleep(spi->tx_latch_until - current_timestamp);
+        }
+
+        // The exchange returns once the frame is on the wire, so only the reset is left to hold
+        ret = spi_transfer(spi->ws2811, spi->chan);
+        spi->tx_latch_until = get_microsecond_timestamp() + job.wait_time;
+
+        pthread_mutex_lock(&spi->tx_lock);
+        spi->tx_busy = false;
+        if (ret != WS2811_SUCCESS)
+        {
+            spi->tx_result = ret;
+        }
+        pthread_cond_broadcast(&spi->tx_cond);
+    }
+    pthread_mutex_unlock(&spi->tx_lock);
+
+    return NULL;
+}
+
+static ws2811_return_t spi_transmit_start(ws2811_spi_channel_t *spi)
+{
+    spi->tx_pending = false;
+    spi->tx_busy = false;
+    spi->tx_stop = false;
+    spi->tx_result = WS2811_SUCCESS;
+    spi->tx_latch_until = 0;
+
+    if (pthread_mutex_init(&spi->tx_lock, NULL) != 0)
+    {
+        return WS2811_ERROR_GENERIC;
     }
 
+    if (pthread_cond_init(&spi->tx_cond, NULL) != 0)
+    {
+        pthread_mutex_destroy(&spi->tx_lock);
+        return WS2811_ERROR_GENERIC;
+    }
+
+    if (pthread_create(&spi->tx_thread, NULL, spi_transmit_thread, spi) != 0)
+    {
+        pthread_cond_destroy(&spi->tx_cond);
+        pthread_mutex_destroy(&spi->tx_lock);
+        return WS2811_ERROR_GENERIC;
+    }
+
+    spi->tx_running = true;
     return WS2811_SUCCESS;
 }
 
+static void spi_transmit_stop(ws2811_spi_channel_t *spi)
+{
+    if (!spi->tx_running)
+    {
+        return;
+    }
+
+    // Anything already submitted is still sent before the thread exits
+    pthread_mutex_lock(&spi->tx_lock);
+    spi->tx_stop = true;
+    pthread_cond_broadcast(&spi->tx_cond);
+    pthread_mutex_unlock(&spi->tx_lock);
+
+    pthread_join(spi->tx_thread, NULL);
+    pthread_cond_destroy(&spi->tx_cond);
+    pthread_mutex_destroy(&spi->tx_lock);
+    spi->tx_running = false;
+}
+
+// Block until the channel's last submitted buffer has left the wire
+static ws2811_return_t spi_transmit_wait(ws2811_spi_channel_t *spi)
+{
+    ws2811_return_t ret;
+
+    if (!spi->tx_running)
+    {
+        return WS2811_SUCCESS;
+    }
+
+    pthread_mutex_lock(&spi->tx_lock);
+    while (spi->tx_pending || spi->tx_busy)
+    {
+        pthread_cond_wait(&spi->tx_cond, &spi->tx_lock);
+    }
+    ret = spi->tx_result;
+    spi->tx_result = WS2811_SUCCESS;
+    pthread_mutex_unlock(&spi->tx_lock);
+
+    return ret;
+}
+
+// Queue the encoded buffer, swapping it to the front when double-buffered
+static void spi_transmit_submit(ws2811_spi_channel_t *spi, const ws2811_tx_job_t *job)
+{
+    pthread_mutex_lock(&spi->tx_lock);
+    if (spi->pxl_back)
+    {
+        uint8_t *sent = spi->pxl_raw;
+
+        spi->pxl_raw = spi->pxl_back;
+        spi->pxl_back = sent;
+    }
+    spi->tx_job = *job;
+    spi->tx_pending = true;
+    pthread_cond_broadcast(&spi->tx_cond);
+    pthread_mutex_unlock(&spi->tx_lock);
+}
+
+// SPI bus driving a data pin, or -1 if the pin has no LED channel
+static int spi_bus_for_pin(int gpionum)
+{
+    switch (gpionum)
+    {
+    case LED_CHANNEL_0_DATA_PIN:
+        return LED_STRIP_SPI_BUS_1;
+    case LED_CHANNEL_1_DATA_PIN:
+        return LED_STRIP_SPI_BUS_2;
+    case LED_CHANNEL_2_DATA_PIN:
+        return LED_STRIP_SPI_BUS_3;
+    default:
+        return -1;
+    }
+}
+
 ws2811_return_t ws2811_init(ws2811_t *ws2811)
 {
     ws2811_device_t *device;
@@ -216,52 +452,44 @@ ws2811_return_t ws2811_init(ws2811_t *ws2811)
     }
 
     // the SPI support currently implemented should work on both RPI 4 and RPI 5 and related devices
-    // only support GPIO pins for SPI (for now)
-    if (ws2811->channel[0].gpionum == LED_CHANNEL_0_DATA_PIN || ws2811->channel[0].gpionum == LED_CHANNEL_1_DATA_PIN)
+    // only support GPIO pins for SPI (for now), one channel per SPI bus
+    for (chan = 0; chan < LED_STRIP_CHANNELS; chan++)
     {
-        ws2811->device->driver_mode = SPI;
-        if (ws2811->channel[0].gpionum == LED_CHANNEL_0_DATA_PIN)
-        {
-            device->spi_bus_number[0] = LED_STRIP_SPI_BUS_1;
-        }
-        else if (ws2811->channel[0].gpionum == LED_CHANNEL_1_DATA_PIN)
+        int bus;
+
+        if (ws2811->channel[chan].gpionum == -1)
         {
-            device->spi_bus_number[0] = LED_STRIP_SPI_BUS_2;
+            continue;
         }
-        else if (ws2811->channel[0].gpionum == LED_CHANNEL_2_DATA_PIN)
+
+        bus = spi_bus_for_pin(ws2811->channel[chan].gpionum);
+        if (bus == -1)
         {
-            device->spi_bus_number[0] = LED_STRIP_SPI_BUS_3;
+            free(ws2811->device);
+            ws2811->device = NULL;
+            return WS2811_ERROR_ILLEGAL_GPIO;
         }
-        device->spi_device_number[0] = LED_STRIP_SPI_DEVICE;
-    }
-    else
-    {
-        return WS2811_ERROR_ILLEGAL_GPIO;
-    }
 
-    if (ws2811->channel[1].gpionum != -1)
-    {
-        if (ws2811->channel[1].gpionum == LED_CHANNEL_0_DATA_PIN || ws2811->channel[1].gpionum == LED_CHANNEL_1_DATA_PIN)
+        for (int other = 0; other < chan; other++)
         {
-            ws2811->device->driver_mode = SPI;
-            if (ws2811->channel[1].gpionum == LED_CHANNEL_0_DATA_PIN)
-            {
-                device->spi_bus_number[1] = LED_STRIP_SPI_BUS_1;
-            }
-            else if (ws2811->channel[1].gpionum == LED_CHANNEL_1_DATA_PIN)
+            if (device->spi_bus_number[other] == bus)
             {
-                device->spi_bus_number[1] = LED_STRIP_SPI_BUS_2;
+                free(ws2811->device);
+                ws2811->device = NULL;
+                return WS2811_ERROR_ILLEGAL_GPIO;
             }
-            else if (ws2811->channel[1].gpionum == LED_CHANNEL_2_DATA_PIN)
-            {
-                device->spi_bus_number[1] = LED_STRIP_SPI_BUS_3;
-            }
-            device->spi_device_number[1] = LED_STRIP_SPI_DEVICE;
-        }
-        else
-        {
-            return WS2811_ERROR_ILLEGAL_GPIO;
         }
+
+        ws2811->device->driver_mode = SPI;
+        device->spi_bus_number[chan] = bus;
+        device->spi_device_number[chan] = LED_STRIP_SPI_DEVICE;
+    }
+
+    if (ws2811->device->driver_mode != SPI)
+    {
+        free(ws2811->device);
+        ws2811->device = NULL;
+        return WS2811_ERROR_ILLEGAL_GPIO;
     }
 
     device->max_count = 0;
@@ -273,9 +501,6 @@ ws2811_return_t ws2811_init(ws2811_t *ws2811)
         }
     }
 
-    // Initialize all pointers to NULL.  Any non-NULL pointers will be freed on cleanup.
-    device->pxl_raw = NULL;
-
     // Allocate the LED buffers
     for (chan = 0; chan < LED_STRIP_CHANNELS; chan++)
     {
@@ -361,412 +586,310 @@ void ws2811_fini(ws2811_t *ws2811)
     ws2811_cleanup(ws2811);
 }
 
-ws2811_return_t ws2811_render(ws2811_t *ws2811)
+// Expand one color byte into its 8 SPI symbols, MSB first, in memory order
+static uint64_t encode_color_byte(uint8_t value, uint8_t invert_mask)
 {
-    static uint8_t convert_table[256][8] =
-        {
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE, LED_ONE},
-
-            {LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO, LED_ONE},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ZERO},
-            {LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE, LED_ONE}
-
-        };
-    volatile uint8_t *pxl_raw = ws2811->device->pxl_raw;
-    int driver_mode = ws2811->device->driver_mode;
-    int i, l, chan;
-    unsigned j;
-    ws2811_return_t ret = WS2811_SUCCESS;
-    uint32_t protocol_time = 0;
-    static uint64_t previous_timestamp = 0;
+    uint8_t symbols[8];
+    uint64_t word;
+    int l;
 
-    // Wait for any previous operation to complete.
-    if ((ret = ws2811_wait(ws2811)) != WS2811_SUCCESS)
+    for (l = 0; l < 8; l++)
     {
-        return ret;
+        symbols[l] = ((value & (0x80 >> l)) ? LED_ONE : LED_ZERO) ^ invert_mask;
     }
 
-    if (ws2811->render_wait_time != 0)
+    memcpy(&word, symbols, sizeof(word));
+    return word;
+}
+
+// Rebuild the encoding table when brightness, invert or the gamma table changed
+static void encode_lut_update(const ws2811_channel_t *channel, ws2811_encode_lut_t *lut)
+{
+    const int scale = (channel->brightness & 0xff) + 1;
+    const uint8_t invert_mask = channel->invert ? 0xff : 0x00;
+    int j, value;
+
+    if (lut->valid &&
+        (lut->brightness == channel->brightness) &&
+        (lut->invert_mask == invert_mask) &&
+        (memcmp(lut->gamma, channel->gamma, sizeof(lut->gamma)) == 0))
     {
-        const uint64_t current_timestamp = get_microsecond_timestamp();
-        uint64_t time_diff = current_timestamp - previous_timestamp;
+        return;
+    }
 
-        if (ws2811->render_wait_time > time_diff)
+    for (j = 0; j < LED_COLORS; j++)
+    {
+        for (value = 0; value < 256; value++)
         {
-            usleep(ws2811->render_wait_time - time_diff);
+            uint8_t level = channel->gamma[((value * scale) >> 8) * LED_COLORS + j];
+
+            lut->level[j][value] = level;
+            lut->word[j][value] = encode_color_byte(level, invert_mask);
         }
     }
 
-    for (chan = 0; chan < LED_STRIP_CHANNELS; chan++)
-    {
-        ws2811_channel_t *channel = &ws2811->channel[chan];
+    memcpy(lut->gamma, channel->gamma, sizeof(lut->gamma));
+    lut->brightness = channel->brightness;
+    lut->invert_mask = invert_mask;
+    lut->valid = true;
+}
 
-        const int scale = (channel->brightness & 0xff) + 1;
-        uint8_t array_size = 3; // Assume 3 color LEDs, RGB
+#if defined(__aarch64__) && defined(__ARM_NEON)
+// 256 entry byte lookup from four 64 byte tables; out of range indices give 0
+static inline uint8x16_t lookup_level(const uint8x16x4_t table[4], uint8x16_t index)
+{
+    const uint8x16_t step = vdupq_n_u8(64);
+    uint8x16_t result = vqtbl4q_u8(table[0], index);
 
-        // If our shift mask includes the highest nibble, then we have 4 LEDs, RBGW.
-        if (channel->strip_type & SK6812_SHIFT_WMASK)
-        {
-            array_size = 4;
-        }
+    index = vsubq_u8(index, step);
+    result = vorrq_u8(result, vqtbl4q_u8(table[1], index));
+    index = vsubq_u8(index, step);
+    result = vorrq_u8(result, vqtbl4q_u8(table[2], index));
+    index = vsubq_u8(index, step);
+    result = vorrq_u8(result, vqtbl4q_u8(table[3], index));
 
-        // 1.25µs per bit
-        const uint32_t channel_protocol_time = channel->count * array_size * 8 * 1.25;
+    return result;
+}
 
-        // Only using the channel which takes the longest as both run in parallel
-        if (channel_protocol_time > protocol_time)
+// Each 64-bit half holds the 8 symbols of one LED
+static inline void store_led_pair(uint8_t *dst, int stride, uint32x4_t pair)
+{
+    uint8x16_t bytes = vreinterpretq_u8_u32(pair);
+
+    vst1_u8(dst, vget_low_u8(bytes));
+    vst1_u8(dst + stride, vget_high_u8(bytes));
+}
+
+// Encode 16 LEDs per iteration, returns the number of LEDs done
+static int encode_channel_neon(const ws2811_channel_t *channel, const ws2811_encode_lut_t *lut,
+                               const uint8_t shift[LED_COLORS], int array_size, uint8_t *out)
+{
+    const int stride = array_size * 8;
+    const uint8x16_t zero_symbol = vdupq_n_u8(LED_ZERO ^ lut->invert_mask);
+    const uint8x16_t one_bits = vdupq_n_u8(LED_ZERO ^ LED_ONE);
+    uint8x16x4_t table[LED_COLORS][4];
+    int i, j, k, l;
+
+    // The color bytes are picked from the LED words by lane, so shifts must be byte aligned
+    for (j = 0; j < array_size; j++)
+    {
+        if ((shift[j] & 0x7) || (shift[j] > 24))
         {
-            protocol_time = channel_protocol_time;
+            return 0;
         }
 
-        for (i = 0; i < channel->count; i++) // Led
+        for (k = 0; k < 4; k++)
         {
-            uint8_t color[LED_COLORS];
-            for (j = 0; j < array_size; j++) // Color
-            {
-                switch (j)
-                {
-                case 0: // red
-                    color[j] = channel->gamma[((((channel->leds[i] >> channel->rshift) & 0xff) * scale) >> 8) * LED_COLORS + j];
-                    break;
+            const uint8_t *base = &lut->level[j][k * 64];
 
-                case 1: // green
-                    color[j] = channel->gamma[((((channel->leds[i] >> channel->gshift) & 0xff) * scale) >> 8) * LED_COLORS + j];
-                    break;
+            table[j][k].val[0] = vld1q_u8(base);
+            table[j][k].val[1] = vld1q_u8(base + 16);
+            table[j][k].val[2] = vld1q_u8(base + 32);
+            table[j][k].val[3] = vld1q_u8(base + 48);
+        }
+    }
 
-                case 2: // blue
-                    color[j] = channel->gamma[((((channel->leds[i] >> channel->bshift) & 0xff) * scale) >> 8) * LED_COLORS + j];
-                    break;
+    for (i = 0; i + 16 <= channel->count; i += 16)
+    {
+        // val[n] holds bits 8n..8n+7 of 16 consecutive LEDs
+        const uint8x16x4_t bytes = vld4q_u8((const uint8_t *)&channel->leds[i]);
+        uint8_t *dst = out + i * stride;
 
-                case 3: // white
-                    color[j] = channel->gamma[((((channel->leds[i] >> channel->wshift) & 0xff) * scale) >> 8) * LED_COLORS + j];
-                    break;
-                }
-            }
-            // printf("led color: %x\n", channel->leds[i]);
-            // printf("color: %x %x %x %x\n", color[0], color[1], color[2], color[3]);
+        for (j = 0; j < array_size; j++)
+        {
+            const uint8x16_t level = lookup_level(table[j], bytes.val[shift[j] >> 3]);
+            uint8x16_t symbol[8];
 
-            for (j = 0; j < array_size; j++) // Color
+            for (l = 0; l < 8; l++)
             {
-                for (l = 0; l < 8; ++l)
-                {
-                    uint8_t val = convert_table[color[j]][l];
-                    if (channel->invert)
-                        val = ~val;
+                const uint8x16_t bit = vtstq_u8(level, vdupq_n_u8(0x80 >> l));
 
-                    pxl_raw[PREAMBLE_BYTES + i * array_size * 8 + j * 8 + l] = val;
-                }
+                symbol[l] = veorq_u8(zero_symbol, vandq_u8(bit, one_bits));
             }
+
+            // Transpose 8 symbols x 16 LEDs into 16 rows of 8 symbols
+            const uint8x16x2_t s01 = vzipq_u8(symbol[0], symbol[1]);
+            const uint8x16x2_t s23 = vzipq_u8(symbol[2], symbol[3]);
+            const uint8x16x2_t s45 = vzipq_u8(symbol[4], symbol[5]);
+            const uint8x16x2_t s67 = vzipq_u8(symbol[6], symbol[7]);
+
+            const uint16x8x2_t lo03 = vzipq_u16(vreinterpretq_u16_u8(s01.val[0]), vreinterpretq_u16_u8(s23.val[0]));
+            const uint16x8x2_t hi03 = vzipq_u16(vreinterpretq_u16_u8(s01.val[1]), vreinterpretq_u16_u8(s23.val[1]));
+            const uint16x8x2_t lo47 = vzipq_u16(vreinterpretq_u16_u8(s45.val[0]), vreinterpretq_u16_u8(s67.val[0]));
+            const uint16x8x2_t hi47 = vzipq_u16(vreinterpretq_u16_u8(s45.val[1]), vreinterpretq_u16_u8(s67.val[1]));
+
+            const uint32x4x2_t led0 = vzipq_u32(vreinterpretq_u32_u16(lo03.val[0]), vreinterpretq_u32_u16(lo47.val[0]));
+            const uint32x4x2_t led4 = vzipq_u32(vreinterpretq_u32_u16(lo03.val[1]), vreinterpretq_u32_u16(lo47.val[1]));
+            const uint32x4x2_t led8 = vzipq_u32(vreinterpretq_u32_u16(hi03.val[0]), vreinterpretq_u32_u16(hi47.val[0]));
+            const uint32x4x2_t led12 = vzipq_u32(vreinterpretq_u32_u16(hi03.val[1]), vreinterpretq_u32_u16(hi47.val[1]));
+
+            uint8_t *row = dst + j * 8;
+
+            store_led_pair(row + 0 * stride, stride, led0.val[0]);
+            store_led_pair(row + 2 * stride, stride, led0.val[1]);
+            store_led_pair(row + 4 * stride, stride, led4.val[0]);
+            store_led_pair(row + 6 * stride, stride, led4.val[1]);
+            store_led_pair(row + 8 * stride, stride, led8.val[0]);
+            store_led_pair(row + 10 * stride, stride, led8.val[1]);
+            store_led_pair(row + 12 * stride, stride, led12.val[0]);
+            store_led_pair(row + 14 * stride, stride, led12.val[1]);
         }
+    }
+
+    return i;
+}
+#endif
 
-        if (driver_mode == SPI)
+// Write the SPI symbols for every LED of a channel, starting after the preamble
+static void encode_channel(const ws2811_channel_t *channel, const ws2811_encode_lut_t *lut, int array_size,
+                           uint8_t *out)
+{
+    // Wire position j takes its byte from the LED word at this shift
+    const uint8_t shift[LED_COLORS] = {channel->rshift, channel->gshift, channel->bshift, channel->wshift};
+    const int stride = array_size * 8;
+    int i = 0;
+    int j;
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    i = encode_channel_neon(channel, lut, shift, array_size, out);
+#endif
+
+    for (; i < channel->count; i++)
+    {
+        const ws2811_led_t led = channel->leds[i];
+        uint8_t *dst = out + i * stride;
+
+        for (j = 0; j < array_size; j++)
         {
-            ret = spi_transfer(ws2811, chan);
-            if (ret)
-            {
-                break;
-            }
+            const uint64_t word = lut->word[j][(led >> shift[j]) & 0xff];
+
+            // The preamble leaves rows unaligned; memcpy compiles to a single store
+            memcpy(dst + j * 8, &word, sizeof(word));
+        }
+    }
+}
+
+// Number of color bytes per LED for the channel's strip type
+static int channel_array_size(const ws2811_channel_t *channel)
+{
+    // If our shift mask includes the highest nibble, then we have 4 LEDs, RBGW.
+    if (channel->strip_type & SK6812_SHIFT_WMASK)
+    {
+        return 4;
+    }
+
+    return 3; // Assume 3 color LEDs, RGB
+}
+
+ws2811_return_t ws2811_render(ws2811_t *ws2811)
+{
+    ws2811_device_t *device = ws2811->device;
+    int chan;
+    ws2811_return_t ret = WS2811_SUCCESS;
+    uint32_t protocol_time = 0;
+    ws2811_tx_job_t job;
+
+    if (device->driver_mode != SPI)
+    {
+        return WS2811_ERROR_GENERIC;
+    }
+
+    for (chan = 0; chan < LED_STRIP_CHANNELS; chan++)
+    {
+        const ws2811_channel_t *channel = &ws2811->channel[chan];
+
+        // 1.25µs per bit
+        const uint32_t channel_protocol_time = channel->count * channel_array_size(channel) * 8 * 1.25;
+
+        // Only using the channel which takes the longest as all run in parallel
+        if (channel_protocol_time > protocol_time)
+        {
+            protocol_time = channel_protocol_time;
         }
     }
 
     // LED_RESET_WAIT_TIME is added to allow enough time for the reset to occur.
-    previous_timestamp = get_microsecond_timestamp();
+    // Each transmit thread holds off its next exchange for the reset only, counted
+    // from the end of the transfer; callers that pace frames at render_wait_time
+    // (mini_fastled) are normally past it already.
     ws2811->render_wait_time = protocol_time + LED_RESET_WAIT_TIME;
+    job.wait_time = LED_RESET_WAIT_TIME;
+
+    // Encode each channel once and hand it to its bus, so channel 1 is encoded
+    // while channel 0 is already being sent
+    for (chan = 0; chan < LED_STRIP_CHANNELS; chan++)
+    {
+        ws2811_channel_t *channel = &ws2811->channel[chan];
+        ws2811_spi_channel_t *spi = &device->spi[chan];
+        ws2811_return_t chan_ret;
+        uint8_t *pxl_raw;
+
+        if (!spi->tx_running)
+        {
+            continue;
+        }
+
+        if (spi->pxl_back)
+        {
+            // Double-buffered: the back buffer is free, encode while the previous frame may still be
+            // on the wire and only wait for it before swapping
+            pxl_raw = spi->pxl_back;
+        }
+        else
+        {
+            // Single buffer: the previous frame was waited for before the last render returned
+            pxl_raw = spi->pxl_raw;
+        }
+
+        encode_lut_update(channel, &device->lut[chan]);
+        encode_channel(channel, &device->lut[chan], channel_array_size(channel), pxl_raw + PREAMBLE_BYTES);
+
+        if (spi->pxl_back && ((chan_ret = spi_transmit_wait(spi)) != WS2811_SUCCESS) && (ret == WS2811_SUCCESS))
+        {
+            ret = chan_ret;
+        }
+
+        spi_transmit_submit(spi, &job);
+    }
+
+    // Without double buffering the frame must have been sent before the LEDs are reused
+    if (!ws2811->double_buffer)
+    {
+        ws2811_return_t wait_ret = ws2811_wait(ws2811);
+
+        if (ret == WS2811_SUCCESS)
+        {
+            ret = wait_ret;
+        }
+    }
 
     return ret;
 }
 
 ws2811_return_t ws2811_wait(ws2811_t *ws2811)
 {
-    // Nothing to do for SPI but return error for other driver modes just in case
-    if (ws2811->device->driver_mode != SPI)
+    ws2811_device_t *device = ws2811->device;
+    ws2811_return_t ret = WS2811_SUCCESS;
+    int chan;
+
+    // Return error for other driver modes just in case
+    if (device->driver_mode != SPI)
     {
         return WS2811_ERROR_GENERIC;
     }
 
-    return WS2811_SUCCESS;
+    // Every bus has to finish; report the first failure
+    for (chan = 0; chan < LED_STRIP_CHANNELS; chan++)
+    {
+        ws2811_return_t chan_ret = spi_transmit_wait(&device->spi[chan]);
+
+        if ((chan_ret != WS2811_SUCCESS) && (ret == WS2811_SUCCESS))
+        {
+            ret = chan_ret;
+        }
+    }
+
+    return ret;
 }
 
 const char *ws2811_get_return_t_str(const ws2811_return_t state)
@@ -784,47 +907,29 @@ const char *ws2811_get_return_t_str(const ws2811_return_t state)
 
 void ws2811_init_gamma_lookup(ws2811_t *ws2811)
 {
+    static const int color_shift[LED_COLORS] = {LED_SHIFT_R, LED_SHIFT_G, LED_SHIFT_B, LED_SHIFT_W};
     int chan, counter;
-    uint8_t color_factor;
+    uint8_t color_factor[LED_COLORS];
     for (chan = 0; chan < LED_STRIP_CHANNELS; chan++)
     {
         ws2811_channel_t *channel = &ws2811->channel[chan];
 
         if (channel->gamma)
         {
+            // The correction/temperature factors only depend on the channel, not on the level
+            for (int j = 0; j < LED_COLORS; j++)
+            {
+                color_factor[j] = (uint8_t)(((double)((channel->color_correction >> color_shift[j]) & 0xff) *
+                                             (double)((channel->color_temperature >> color_shift[j]) & 0xff)) /
+                                            255.0);
+            }
+
             for (counter = 0; counter < 256; counter++)
             {
                 for (int j = 0; j < LED_COLORS; j++)
                 {
-                    switch (j)
-                    {
-                    case 0: // red
-                        color_factor = (uint8_t)(((double)((channel->color_correction >> LED_SHIFT_R) & 0xff) *
-                                                  (double)((channel->color_temperature >> LED_SHIFT_R) & 0xff)) /
-                                                 255.0);
-                        break;
-
-                    case 1: // green
-                        color_factor = (uint8_t)(((double)((channel->color_correction >> LED_SHIFT_G) & 0xff) *
-                                                  (double)((channel->color_temperature >> LED_SHIFT_G) & 0xff)) /
-                                                 255.0);
-                        break;
-
-                    case 2: // blue
-                        color_factor = (uint8_t)(((double)((channel->color_correction >> LED_SHIFT_B) & 0xff) *
-                                                  (double)((channel->color_temperature >> LED_SHIFT_B) & 0xff)) /
-                                                 255.0);
-                        break;
-
-                    case 3: // white
-                        color_factor = (uint8_t)(((double)((channel->color_correction >> LED_SHIFT_W) & 0xff) *
-                                                  (double)((channel->color_temperature >> LED_SHIFT_W) & 0xff)) /
-                                                 255.0);
-                        break;
-                    }
-
                     channel->gamma[counter * LED_COLORS + j] =
-                        (int)(pow((float)color_factor * (float)counter / (float)(255.00 * 255.0), channel->gamma_factor) * 255.00 + 0.5);
+                        (int)(pow((float)color_factor[j] * (float)counter / (float)(255.00 * 255.0), channel->gamma_factor) * 255.00 + 0.5);
                 }
             }
         }
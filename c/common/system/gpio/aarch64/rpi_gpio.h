@@ -114,7 +114,7 @@ rpi_gpio_get_select(uint32_t const gpio)
 {
     uint32_t const  reg = gpio / 10;
     uint32_t const  off = (gpio % 10) * 3;
-    return (rpi_gpio_regs[reg] >> off) & 7;
+    return (__RPI_GPIO_REGS[reg] >> off) & 7;
 }
 
 /**
@@ -2,18 +2,36 @@
 """
 Processing server - receives camera data and converts to MP4
 Runs on the processing machine (not QNX)
+
+One asyncio event loop accepts every camera and receives frame payloads
+straight into per-client shared-memory slots. Conversion, analysis and
+encoding run in worker processes, each owning the sessions assigned to it,
+so per-frame numpy/OpenCV work never competes with the receive loop for
+the GIL. Within a worker every session keeps its own decode, encode and
+analysis threads, so those stages overlap as they did per connection.
 """
 
+import asyncio
+import itertools
+import multiprocessing
 import os
+import queue
 import sys
+import shutil
+import signal
 import socket
+import subprocess
 import struct
 import threading
 import time
 import tempfile
 import argparse
-from typing import Optional, List, Tuple
+import json
+from collections import deque
+from multiprocessing import shared_memory
+from typing import Dict, Optional, List, Tuple
 import numpy as np
+from numpy.lib.stride_tricks import as_strided
 
 try:
     import cv2
@@ -21,11 +39,145 @@ except ImportError:
     print("Error: OpenCV (cv2) is required. Install with: pip install opencv-python")
     sys.exit(1)
 
+# Wire protocol (must match 6ix/c/stream_protocol.h)
+STREAM_PROTOCOL_MAGIC = 0x36495853  # "6IXS"
+STREAM_PROTOCOL_VERSION = 4
+STREAM_PROTOCOL_DEFAULT_PORT = 8080
+
+STREAM_MSG_FRAME = 1
+STREAM_MSG_END_OF_STREAM = 2
+STREAM_MSG_RESULT = 3
+STREAM_MSG_RESUME = 4
+
+STREAM_FLAG_RESUME = 0x1
+
+# Interrupted sessions are kept this long for the client to resume them
+RESUME_TIMEOUT_S = 120.0
+
+STREAM_RESULT_OK = 0
+STREAM_RESULT_ERROR = 1
+STREAM_RESULT_MAX_PAYLOAD = 64
+
+SESSION_HEADER = struct.Struct("!IHHIiIIQ")
+FRAME_HEADER = struct.Struct("!IIIIIIQ")
+RESULT_HEADER = struct.Struct("!IIII")
+
 # Frame type constants (must match client)
 CAMERA_FRAMETYPE_YCBYCR = 0
 CAMERA_FRAMETYPE_CBYCRY = 1
 CAMERA_FRAMETYPE_RGB8888 = 2
 CAMERA_FRAMETYPE_BGR8888 = 3
+CAMERA_FRAMETYPE_GRAY8 = 4  # luma-only output of the client preprocessing stage
+CAMERA_FRAMETYPE_JPEG = 5  # one encoded image per frame
+CAMERA_FRAMETYPE_H264 = 6  # Annex B bitstream chunks
+
+# Compressed frame types are stored as received and remuxed, never re-encoded
+COMPRESSED_STREAM_FORMATS = {
+    CAMERA_FRAMETYPE_JPEG: ("mjpeg", ".mjpeg"),
+    CAMERA_FRAMETYPE_H264: ("h264", ".h264"),
+}
+
+# Raw frame types: (bytes per pixel, cv2 conversion to BGR)
+RAW_FRAME_CONVERSIONS = {
+    CAMERA_FRAMETYPE_YCBYCR: (2, cv2.COLOR_YUV2BGR_YUY2),
+    CAMERA_FRAMETYPE_CBYCRY: (2, cv2.COLOR_YUV2BGR_UYVY),
+    CAMERA_FRAMETYPE_RGB8888: (4, cv2.COLOR_RGBA2BGR),
+    CAMERA_FRAMETYPE_BGR8888: (4, cv2.COLOR_BGRA2BGR),
+    CAMERA_FRAMETYPE_GRAY8: (1, cv2.COLOR_GRAY2BGR),
+}
+
+
+class Tracer:
+    """Latency spans in per-thread rings, exported as a Chrome trace.
+
+    Same model as 6ix/c/trace.c: every thread appends completed spans to its
+    own bounded deque, so recording never takes a lock, and dump_chrome()
+    writes the most recent spans of every thread. Timestamps come from
+    time.monotonic_ns().
+    """
+
+    def __init__(self, ring_size: int = 4096):
+        self.enabled = False
+        self.ring_size = ring_size
+        self.local = threading.local()
+        self.rings = []  # (thread id, thread name, ring)
+        self.rings_lock = threading.Lock()  # only taken for a thread's first span
+
+    def ring(self) -> deque:
+        ring = getattr(self.local, "ring", None)
+        if ring is None:
+            ring = deque(maxlen=self.ring_size)
+            self.local.ring = ring
+            thread = threading.current_thread()
+            with self.rings_lock:
+                self.rings.append((thread.ident, thread.name, ring))
+        return ring
+
+    def record(self, name: str, start_ns: int, end_ns: int, arg: int = 0):
+        """Record a completed span on the calling thread"""
+        if self.enabled:
+            self.ring().append((name, start_ns, max(start_ns, end_ns), arg))
+
+    def extend(self, ident: int, thread_name: str, spans: list):
+        """Add spans recorded by another process, e.g. a frame worker"""
+        if not self.enabled or not spans:
+            return
+        with self.rings_lock:
+            for ring_ident, _, ring in self.rings:
+                if ring_ident == ident:
+                    break
+            else:
+                ring = deque(maxlen=self.ring_size)
+                self.rings.append((ident, thread_name, ring))
+        ring.extend(spans)
+
+    def snapshot(self) -> List[Tuple[int, str, list]]:
+        with self.rings_lock:
+            rings = list(self.rings)
+        # deque.copy() runs under the GIL, so a writer can't interleave
+        return [(ident, name, ring.copy()) for ident, name, ring in rings]
+
+    def summary(self, since_ns: int) -> str:
+        """Count, mean and max per span name for spans starting after since_ns"""
+        stats = {}
+        for _, _, ring in self.snapshot():
+            for name, start_ns, end_ns, _ in ring:
+                if start_ns >= since_ns:
+                    stats.setdefault(name, []).append(end_ns - start_ns)
+        return ", ".join(
+            f"{name} n={len(durations)} mean={sum(durations) / len(durations) / 1e6:.2f}ms "
+            f"max={max(durations) / 1e6:.2f}ms"
+            for name, durations in sorted(stats.items())
+        )
+
+    def dump_chrome(self, path: str):
+        """Write every ring as a Chrome trace (chrome://tracing, Perfetto)"""
+        pid = os.getpid()
+        events = []
+        for ident, thread_name, ring in self.snapshot():
+            events.append(
+                {"name": "thread_name", "ph": "M", "pid": pid, "tid": ident,
+                 "args": {"name": thread_name}}
+            )
+            for name, start_ns, end_ns, arg in ring:
+                events.append(
+                    {"name": name, "ph": "X", "pid": pid, "tid": ident,
+                     "ts": start_ns / 1000.0, "dur": (end_ns - start_ns) / 1000.0,
+                     "args": {"arg": arg}}
+                )
+        with open(path, "w") as trace_file:
+            json.dump({"displayTimeUnit": "ms", "traceEvents": events}, trace_file)
+
+
+TRACER = Tracer()
+
+
+# Worker process messages
+TASK_FRAME = 1
+TASK_FINISH = 2
+TASK_DETACH = 3
+RESULT_RELEASE = 1
+RESULT_FINISHED = 2
 
 
 class FrameBuffer:
@@ -40,254 +192,944 @@ class FrameBuffer:
         self.stride = stride
         self.data = data
         self.timestamp = time.time()
+        self.sequence = 0
+
+
+class FrameSlot:
+    """Shared-memory buffer that one frame payload is received into.
+
+    Workers attach to the block by name, so the payload crosses the process
+    boundary without being copied or pickled. The block only grows; a frame
+    that doesn't fit replaces it with one of the next power of two size, so
+    slowly growing frames don't replace it every time.
+    """
+
+    def __init__(self, slot_id: int):
+        self.slot_id = slot_id
+        self.shm: Optional[shared_memory.SharedMemory] = None
+
+    def reserve(self, size: int) -> Tuple[memoryview, Optional[str]]:
+        """View of 'size' bytes, and the name of the block it replaced, if any"""
+        replaced = None
+        if self.shm is None or self.shm.size < size:
+            if self.shm is not None:
+                replaced = self.shm.name
+            self.close()
+            capacity = 1 << max(size - 1, 0).bit_length()
+            self.shm = shared_memory.SharedMemory(create=True, size=capacity)
+        return self.shm.buf[:size], replaced
+
+    def close(self):
+        if self.shm is not None:
+            self.shm.close()
+            self.shm.unlink()
+            self.shm = None
+
+
+def attach_shared_memory(name: str) -> shared_memory.SharedMemory:
+    """Attach to a block owned by the server process.
+
+    Workers are spawned by the server and share its resource tracker, so the
+    block stays registered once and is only unlinked by FrameSlot.close().
+    """
+    return shared_memory.SharedMemory(name=name)
+
+
+class SessionInfo:
+    """Environment data from the session header"""
+
+    def __init__(
+        self,
+        temperature: float,
+        pressure: float,
+        button_press_time: float,
+        flags: int = 0,
+        session_id: int = 0,
+    ):
+        self.temperature = temperature
+        self.pressure = pressure
+        self.button_press_time = button_press_time
+        self.button_release_time = None
+        self.flags = flags
+        self.session_id = session_id
+
+
+class ClientSession:
+    """Server-side state of one recording, kept across resumed connections.
+
+    Each session owns queue_depth frame slots. A frame is only received once
+    a slot is free, so a camera whose worker falls behind stops being read
+    and TCP flow control pushes back on that camera alone.
+    """
+
+    def __init__(self, key: int, info: SessionInfo, worker: int, queue_depth: int):
+        self.key = key
+        self.info = info
+        self.worker = worker
+        self.received_count = 0
+        self.slots = [FrameSlot(slot_id) for slot_id in range(queue_depth)]
+        self.free_slots: asyncio.Queue = asyncio.Queue()
+        for slot in self.slots:
+            self.free_slots.put_nowait(slot)
+        self.finished: Optional[asyncio.Future] = None
+        self.suspended_at = 0.0
+
+    def close(self):
+        for slot in self.slots:
+            slot.close()
+
+
+class FramePipeline:
+    """Decode, encode and analysis stages for one session, in a worker process.
+
+    The worker's main thread attaches each task's slot and hands it over:
+
+        tasks -> decode_queue -> decode -> encode_queue -> encode
+              -> analysis_queue -> analysis
+
+    decode_queue is bounded by the session's slots; the other queues hold
+    queue_depth frames. A slot goes back to the server as soon as its
+    payload is no longer needed: after decode for raw frames, which are
+    converted into pooled BGR arrays, after encode for compressed ones,
+    which are stored as received. The analysis stage closes the recording
+    and reports the finish once the end marker reaches it, so every release
+    is on the results queue before it.
+    """
+
+    def __init__(self, key: int, results, queue_depth: int, preview_frames: int):
+        self.key = key
+        self.results = results
+        self.pid = os.getpid()
+        self.frame_count = 0
+        self.failed = False
+        self.preview = deque(maxlen=preview_frames) if preview_frames > 0 else None
+        self.attached: Dict[str, shared_memory.SharedMemory] = {}
+        self.spans = deque()  # appended by every stage, sent with the next result
+
+        self.video_writer = None
+        self.output_path = None
+        self.bitstream = None
+        self.bitstream_path = None
+        self.bitstream_format = None
+
+        self.free_outputs = queue.Queue()
+        self.decode_queue = queue.Queue()
+        self.encode_queue = queue.Queue(queue_depth)
+        self.analysis_queue = queue.Queue(queue_depth)
+
+        self.workers = [
+            threading.Thread(target=self.decode_worker, name="decode", daemon=True),
+            threading.Thread(target=self.encode_worker, name="encode", daemon=True),
+            threading.Thread(target=self.analysis_worker, name="analysis", daemon=True),
+        ]
+        for worker in self.workers:
+            worker.start()
+        self.finished = False
+
+    def attach(self, name: str) -> shared_memory.SharedMemory:
+        shm = self.attached.get(name)
+        if shm is None:
+            shm = attach_shared_memory(name)
+            self.attached[name] = shm
+        return shm
+
+    def detach(self, name: str):
+        """Unmap a block the server replaced; its slot was released already"""
+        shm = self.attached.pop(name, None)
+        if shm is not None:
+            shm.close()
+
+    def submit(self, slot_id: int, frame_buffer: FrameBuffer, view: memoryview):
+        self.decode_queue.put((slot_id, frame_buffer, view))
+
+    def finish(self):
+        """Let the end marker flow through every stage; analysis reports it"""
+        if self.finished:
+            return
+        self.finished = True
+        self.decode_queue.put(None)
+
+    def join(self):
+        for worker in self.workers:
+            worker.join()
+
+    def take_spans(self) -> list:
+        spans = []
+        while True:
+            try:
+                spans.append(self.spans.popleft())
+            except IndexError:
+                return spans
+
+    def release(self, slot_id: int, frame_buffer: FrameBuffer, view: memoryview):
+        """Hand a slot back to the server"""
+        # Views into the block must be gone before it can be closed
+        frame_buffer.data = None
+        view.release()
+        self.results.put((RESULT_RELEASE, self.key, slot_id, self.pid, self.take_spans()))
+
+    def acquire_output(self, height: int, width: int) -> np.ndarray:
+        """Take a BGR array from the pool, dropping any of a stale size"""
+        while True:
+            try:
+                output = self.free_outputs.get_nowait()
+            except queue.Empty:
+                return np.empty((height, width, 3), dtype=np.uint8)
+            if output.shape == (height, width, 3):
+                return output
+
+    def decode_worker(self):
+        """Turn received payloads into BGR frames for encode and analysis"""
+        while True:
+            item = self.decode_queue.get()
+            if item is None:
+                self.encode_queue.put(None)
+                return
+
+            slot_id, frame_buffer, view = item
+            cv_frame = None
+            pooled = False
+            start_ns = time.monotonic_ns()
+            try:
+                if frame_buffer.frametype in COMPRESSED_STREAM_FORMATS:
+                    # JPEGs are cheap to decode for analysis; H.264 is not decoded here
+                    if frame_buffer.frametype == CAMERA_FRAMETYPE_JPEG:
+                        cv_frame = cv2.imdecode(
+                            np.frombuffer(frame_buffer.data, dtype=np.uint8),
+                            cv2.IMREAD_COLOR,
+                        )
+                else:
+                    output = self.acquire_output(frame_buffer.height, frame_buffer.width)
+                    cv_frame = convert_to_opencv_frame(frame_buffer, output)
+                    pooled = cv_frame is not None
+            except Exception as e:
+                print(f"\nDecode error: {e}")
+            self.spans.append(("decode", start_ns, time.monotonic_ns(), frame_buffer.sequence))
+
+            # The payload has been converted, the slot can be refilled
+            if frame_buffer.frametype not in COMPRESSED_STREAM_FORMATS:
+                self.release(slot_id, frame_buffer, view)
+                slot_id = None
+
+            self.encode_queue.put((slot_id, frame_buffer, view, cv_frame, pooled))
+
+    def encode_worker(self):
+        """Write frames to the recording: raw frames are encoded, compressed ones stored"""
+        while True:
+            item = self.encode_queue.get()
+            if item is None:
+                self.analysis_queue.put(None)
+                return
+
+            slot_id, frame_buffer, view, cv_frame, pooled = item
+            start_ns = time.monotonic_ns()
+            try:
+                if frame_buffer.frametype in COMPRESSED_STREAM_FORMATS:
+                    # Encoded frames go to disk untouched and are remuxed at the end
+                    if self.bitstream is None:
+                        self.bitstream_format, extension = COMPRESSED_STREAM_FORMATS[
+                            frame_buffer.frametype
+                        ]
+                        self.output_path = create_output_path(self.key)
+                        self.bitstream_path = os.path.splitext(self.output_path)[0] + extension
+                        self.bitstream = open(self.bitstream_path, "wb")
+                        print(f"Started recording to: {self.bitstream_path}")
+                    self.bitstream.write(frame_buffer.data)
+                    self.frame_count += 1
+
+                elif cv_frame is not None:
+                    # Initialize video writer on first frame
+                    if self.video_writer is None:
+                        self.output_path = create_output_path(self.key)
+                        fourcc = cv2.VideoWriter_fourcc(*"mp4v")
+                        self.video_writer = cv2.VideoWriter(
+                            self.output_path,
+                            fourcc,
+                            30.0,  # FPS
+                            (frame_buffer.width, frame_buffer.height),
+                        )
+                        print(f"Started recording to: {self.output_path}")
+
+                    self.video_writer.write(cv_frame)
+                    self.frame_count += 1
+            except Exception as e:
+                print(f"\nEncode error: {e}")
+                self.failed = True
+            self.spans.append(("encode", start_ns, time.monotonic_ns(), frame_buffer.sequence))
+
+            if slot_id is not None:
+                self.release(slot_id, frame_buffer, view)
+            if cv_frame is None:
+                continue
+            self.analysis_queue.put((frame_buffer, cv_frame, pooled))
+
+    def analysis_worker(self):
+        """Run per-frame analysis and keep the preview buffer"""
+        while True:
+            item = self.analysis_queue.get()
+            if item is None:
+                break
+
+            frame_buffer, cv_frame, pooled = item
+            start_ns = time.monotonic_ns()
+            try:
+                analysis = process_frame(cv_frame, frame_buffer)
+                if self.preview is not None:
+                    self.preview.append((cv_frame.copy(), analysis))
+            except Exception as e:
+                print(f"\nAnalysis error: {e}")
+            self.spans.append(("analysis", start_ns, time.monotonic_ns(), frame_buffer.sequence))
+
+            if pooled:
+                self.free_outputs.put(cv_frame)
+
+        start_ns = time.monotonic_ns()
+        self.close_outputs()
+        self.spans.append(("finish", start_ns, time.monotonic_ns(), self.frame_count))
+        self.results.put(
+            (RESULT_FINISHED, self.key, self.frame_count, self.failed, self.pid, self.take_spans())
+        )
+
+    def close_outputs(self):
+        """Close the output files and detach from the session's slots"""
+        if self.bitstream:
+            self.bitstream.close()
+            remux_bitstream(self.bitstream_path, self.bitstream_format, self.output_path)
+
+        if self.video_writer:
+            self.video_writer.release()
+            if self.output_path and os.path.exists(self.output_path):
+                file_size = os.path.getsize(self.output_path) / (1024 * 1024)  # MB
+                print(
+                    f"\nVideo saved: {self.output_path} ({file_size:.1f} MB, {self.frame_count} frames)"
+                )
+
+        for shm in self.attached.values():
+            shm.close()
+        self.attached.clear()
+
+
+def frame_worker(tasks, results, queue_depth: int, preview_frames: int):
+    """Worker process: runs the pipelines of the sessions assigned to it.
+
+    Tasks for one session always go to the same worker, in order. This
+    thread only attaches slots and feeds each session's stage threads, so a
+    slow session never holds up the others on the same worker, and the
+    finish is reported by the pipeline itself after its last release.
+    """
+    # Ctrl-C reaches the whole process group; the server stops us in order
+    signal.signal(signal.SIGINT, signal.SIG_IGN)
+
+    pid = os.getpid()
+    pipelines: Dict[int, FramePipeline] = {}
+    finishing: List[FramePipeline] = []
+
+    while True:
+        task = tasks.get()
+        if task is None:
+            break
+
+        if task[0] == TASK_FRAME:
+            (
+                _,
+                key,
+                slot_id,
+                name,
+                frametype,
+                width,
+                height,
+                stride,
+                size,
+                timestamp,
+                sequence,
+            ) = task
+            pipeline = pipelines.get(key)
+            if pipeline is None:
+                pipeline = pipelines[key] = FramePipeline(
+                    key, results, queue_depth, preview_frames
+                )
+
+            view = pipeline.attach(name).buf[:size]
+            frame_buffer = FrameBuffer(frametype, width, height, stride, view)
+            frame_buffer.timestamp = timestamp
+            frame_buffer.sequence = sequence
+            pipeline.submit(slot_id, frame_buffer, view)
+
+        elif task[0] == TASK_DETACH:
+            _, key, name = task
+            pipeline = pipelines.get(key)
+            if pipeline is not None:
+                pipeline.detach(name)
+
+        elif task[0] == TASK_FINISH:
+            key = task[1]
+            pipeline = pipelines.pop(key, None)
+            if pipeline is None:
+                results.put((RESULT_FINISHED, key, 0, False, pid, []))
+                continue
+            pipeline.finish()
+            finishing = [p for p in finishing if any(w.is_alive() for w in p.workers)]
+            finishing.append(pipeline)
+
+    # Close every recording still open before the process exits
+    for pipeline in pipelines.values():
+        pipeline.finish()
+    for pipeline in finishing + list(pipelines.values()):
+        pipeline.join()
+
+
+def convert_to_opencv_frame(
+    frame_buffer: FrameBuffer, output: Optional[np.ndarray] = None
+) -> Optional[np.ndarray]:
+    """Convert frame buffer to a BGR image.
+
+    The payload is viewed in place with the row stride applied through
+    as_strided, so padding is skipped without copying. If 'output' is a
+    BGR array of the right size, the result is written into it.
+    """
+    conversion = RAW_FRAME_CONVERSIONS.get(frame_buffer.frametype)
+    if conversion is None:
+        print(f"Unsupported frame type: {frame_buffer.frametype}")
+        return None
+
+    bytes_per_pixel, color_code = conversion
+    width = frame_buffer.width
+    height = frame_buffer.height
+    stride = frame_buffer.stride
+    if height == 0 or width == 0 or stride < width * bytes_per_pixel:
+        print(f"Bad frame layout: {width}x{height} stride={stride}")
+        return None
+
+    required = (height - 1) * stride + width * bytes_per_pixel
+    if len(frame_buffer.data) < required:
+        print(f"Short frame: {len(frame_buffer.data)} of {required} bytes")
+        return None
+
+    try:
+        data_array = np.frombuffer(frame_buffer.data, dtype=np.uint8, count=required)
+        if bytes_per_pixel == 1:
+            source = as_strided(
+                data_array, shape=(height, width), strides=(stride, 1), writeable=False
+            )
+        else:
+            source = as_strided(
+                data_array,
+                shape=(height, width, bytes_per_pixel),
+                strides=(stride, bytes_per_pixel, 1),
+                writeable=False,
+            )
+
+        if output is None or output.shape != (height, width, 3):
+            output = np.empty((height, width, 3), dtype=np.uint8)
+        return cv2.cvtColor(source, color_code, dst=output)
+
+    except Exception as e:
+        print(f"Error converting frame: {e}")
+        return None
+
+
+def remux_bitstream(bitstream_path: str, stream_format: str, output_path: str):
+    """Wrap a received bitstream in an MP4 container without re-encoding"""
+    ffmpeg = shutil.which("ffmpeg")
+    if ffmpeg is None:
+        print(f"\nffmpeg not found, keeping raw stream: {bitstream_path}")
+        return
+
+    result = subprocess.run(
+        [
+            ffmpeg,
+            "-loglevel",
+            "error",
+            "-y",
+            "-f",
+            stream_format,
+            "-framerate",
+            "30",  # FPS
+            "-i",
+            bitstream_path,
+            "-c",
+            "copy",
+            output_path,
+        ],
+        capture_output=True,
+        text=True,
+    )
+    if result.returncode != 0:
+        print(f"\nRemux failed, keeping raw stream {bitstream_path}: {result.stderr.strip()}")
+        return
+
+    os.remove(bitstream_path)
+    file_size = os.path.getsize(output_path) / (1024 * 1024)  # MB
+    print(f"\nVideo saved: {output_path} ({file_size:.1f} MB)")
+
+
+def create_output_path(key: int) -> str:
+    """Create output path for MP4 file, unique per session"""
+    timestamp = time.strftime("%Y%m%d_%H%M%S")
+    filename = f"camera_recording_{timestamp}_{key}.mp4"
+
+    # Try to save in current directory, fallback to temp
+    try:
+        output_path = os.path.join(os.getcwd(), filename)
+        # Test write access
+        with open(output_path, "w") as test_file:
+            pass
+        os.remove(output_path)
+        return output_path
+    except:
+        return os.path.join(tempfile.gettempdir(), filename)
+
+
+def process_frame(cv_frame: np.ndarray, frame_buffer: FrameBuffer) -> dict:
+    """Process frame and return analysis results"""
+    # For now, just return basic frame information
+    # This is where you would add your actual analysis logic
+
+    analysis = {
+        "timestamp": frame_buffer.timestamp,
+        "width": frame_buffer.width,
+        "height": frame_buffer.height,
+        "frametype": frame_buffer.frametype,
+        "mean_intensity": float(np.mean(cv_frame)),
+        "std_intensity": float(np.std(cv_frame)),
+        # Add more analysis results here as needed
+    }
+
+    return analysis
 
 
 class ProcessingServer:
-    def __init__(self, host: str = "0.0.0.0", port: int = 8888):
+    def __init__(
+        self,
+        host: str = "0.0.0.0",
+        port: int = STREAM_PROTOCOL_DEFAULT_PORT,
+        queue_depth: int = 8,
+        preview_frames: int = 0,
+        trace_path: Optional[str] = None,
+        workers: int = 1,
+        backlog: int = 128,
+    ):
         self.host = host
         self.port = port
+        self.queue_depth = queue_depth
+        self.preview_frames = preview_frames
+        self.trace_path = trace_path
+        self.worker_count = max(1, workers)
+        self.backlog = backlog
         self.socket = None
         self.running = False
-        self.client_handlers = []
+        self.loop: Optional[asyncio.AbstractEventLoop] = None
+
+        self.session_keys = itertools.count(1)
+        self.sessions: Dict[int, ClientSession] = {}  # by session key
+        self.worker_load = [0] * self.worker_count  # sessions per worker
+        self.workers = []
+        self.worker_tasks = []
+        self.results = None
+        self.results_thread = None
+
+        # session_id -> interrupted ClientSession, waiting to be resumed
+        self.suspended: Dict[int, ClientSession] = {}
+        # session_id -> (finished at, status, frame count, payload) of the
+        # result last sent, for a client that lost it to ask again
+        self.completed: Dict[int, Tuple[float, int, int, bytes]] = {}
 
     def start_server(self):
         """Start the processing server"""
         try:
-            self.socket = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
-            self.socket.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
-            self.socket.bind((self.host, self.port))
-            self.socket.listen(5)
-            self.running = True
+            asyncio.run(self.serve())
+        except Exception as e:
+            print(f"Failed to start server: {e}")
+        finally:
+            self.cleanup()
 
-            print(f"Processing server started on {self.host}:{self.port}")
-            print("Waiting for camera client connections...")
+    async def serve(self):
+        """Accept camera connections until stopped"""
+        self.loop = asyncio.get_running_loop()
+        self.start_workers()
 
-            while self.running:
-                try:
-                    client_socket, client_address = self.socket.accept()
-                    print(f"Client connected from {client_address}")
-
-                    # Handle client in separate thread
-                    handler = threading.Thread(
-                        target=self.handle_client,
-                        args=(client_socket, client_address),
-                        daemon=True,
-                    )
-                    handler.start()
-                    self.client_handlers.append(handler)
+        self.socket = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self.socket.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self.socket.bind((self.host, self.port))
+        self.socket.listen(self.backlog)
+        self.socket.setblocking(False)
+        self.running = True
 
-                except socket.error as e:
-                    if self.running:
-                        print(f"Socket error: {e}")
-                        break
+        print(f"Processing server started on {self.host}:{self.port} with {self.worker_count} workers")
+        print("Waiting for camera client connections...")
 
-        except Exception as e:
-            print(f"Failed to start server: {e}")
+        while self.running:
+            try:
+                client_socket, client_address = await self.loop.sock_accept(self.socket)
+            except OSError as e:
+                if self.running:
+                    print(f"Socket error: {e}")
+                break
+
+            client_socket.setblocking(False)
+            client_socket.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            print(f"Client connected from {client_address}")
+            self.loop.create_task(self.handle_client(client_socket, client_address))
+
+    def start_workers(self):
+        """Start the frame workers and the thread that forwards their results"""
+        context = multiprocessing.get_context("spawn")
+        self.results = context.Queue()
+        for _ in range(self.worker_count):
+            tasks = context.Queue()
+            worker = context.Process(
+                target=frame_worker,
+                args=(tasks, self.results, self.queue_depth, self.preview_frames),
+                daemon=True,
+            )
+            worker.start()
+            self.workers.append(worker)
+            self.worker_tasks.append(tasks)
+
+        self.results_thread = threading.Thread(
+            target=self.forward_results, name="results", daemon=True
+        )
+        self.results_thread.start()
+
+    def forward_results(self):
+        """Hand worker results to the event loop.
+
+        cleanup() joins the workers after the loop has closed, and they
+        still post results on their way out. Those are dropped, but the
+        queue keeps being drained until the None that follows the joins,
+        so no worker blocks flushing its end of the queue.
+        """
+        while True:
+            result = self.results.get()
+            if result is None:
+                return
+            if self.loop.is_closed():
+                continue
+            try:
+                self.loop.call_soon_threadsafe(self.on_result, result)
+            except RuntimeError:
+                # Closed between the check and the call
+                pass
+
+    def on_result(self, result: tuple):
+        """Return a slot to its session or complete a finish request"""
+        if result[0] == RESULT_RELEASE:
+            _, key, slot_id, pid, spans = result
+            session = self.sessions.get(key)
+            if session is not None:
+                session.free_slots.put_nowait(session.slots[slot_id])
+        else:
+            _, key, frame_count, failed, pid, spans = result
+            session = self.sessions.get(key)
+            if session is not None and session.finished and not session.finished.done():
+                session.finished.set_result((frame_count, failed))
+        TRACER.extend(pid, f"worker-{pid}", spans)
+
+    def open_session(self, info: SessionInfo) -> ClientSession:
+        """Assign a new session to the least loaded worker"""
+        worker = min(range(self.worker_count), key=self.worker_load.__getitem__)
+        self.worker_load[worker] += 1
+        session = ClientSession(next(self.session_keys), info, worker, self.queue_depth)
+        self.sessions[session.key] = session
+        return session
+
+    async def finish_session(self, session: ClientSession) -> Tuple[int, bool]:
+        """Flush the session's worker, close its recording and free its slots"""
+        session.finished = self.loop.create_future()
+        self.worker_tasks[session.worker].put((TASK_FINISH, session.key))
+        try:
+            frame_count, failed = await session.finished
         finally:
-            self.cleanup()
+            self.sessions.pop(session.key, None)
+            self.worker_load[session.worker] -= 1
+            session.close()
+        return frame_count, failed
 
-    def handle_client(
+    async def handle_client(
         self, client_socket: socket.socket, client_address: Tuple[str, int]
     ):
-        """Handle individual client connection"""
-        frames = []
-        video_writer = None
-        output_path = None
+        """Handle individual client connection.
+
+        This coroutine only drains the socket; decode, encode and analysis
+        run in the session's worker process.
+        """
+        status = STREAM_RESULT_ERROR
+        session = None
+        disconnected = False
+        session_ns = time.monotonic_ns()
 
         try:
+            self.expire_suspended()
+            info = await self.receive_session_header(client_socket)
+            if info is None:
+                return
+
+            if info.flags & STREAM_FLAG_RESUME:
+                session = self.suspended.pop(info.session_id, None)
+                if session is None and info.session_id in self.completed:
+                    await self.resend_result(client_socket, info.session_id)
+                    return
+                if session is None:
+                    # The client starts over with a fresh session
+                    print(f"Cannot resume unknown session {info.session_id}")
+                    await self.send_analysis_result(
+                        client_socket, STREAM_RESULT_ERROR, 0, b"", STREAM_MSG_RESUME
+                    )
+                    return
+                print(f"Session {info.session_id} resumed at frame {session.received_count}")
+                await self.send_analysis_result(
+                    client_socket,
+                    STREAM_RESULT_OK,
+                    session.received_count,
+                    b"",
+                    STREAM_MSG_RESUME,
+                )
+            else:
+                print(f"Session started: T={info.temperature:.2f} P={info.pressure:.2f}")
+                session = self.open_session(info)
+
+            tasks = self.worker_tasks[session.worker]
             while self.running:
-                # Receive frame header (updated to match C structure)
-                header_data = self.receive_exact(
-                    client_socket, 28
-                )  # 5 * 4 bytes + 1 * 8 bytes
+                receive_ns = time.monotonic_ns()
+                header_data = await self.receive_exact(client_socket, FRAME_HEADER.size)
                 if not header_data:
+                    print("\nConnection closed before end of stream")
+                    disconnected = True
                     break
 
-                frametype, width, height, stride, data_size, timestamp_us = (
-                    struct.unpack("!IIIIIQ", header_data)
-                )
+                (
+                    msg_type,
+                    frametype,
+                    width,
+                    height,
+                    stride,
+                    data_size,
+                    timestamp_us,
+                ) = FRAME_HEADER.unpack(header_data)
 
-                # Receive frame data
-                frame_data = self.receive_exact(client_socket, data_size)
-                if not frame_data:
+                if msg_type == STREAM_MSG_END_OF_STREAM:
+                    session.info.button_release_time = timestamp_us / 1000000.0
+                    status = STREAM_RESULT_OK
                     break
 
-                frame_buffer = FrameBuffer(frametype, width, height, stride, frame_data)
-                frame_buffer.timestamp = (
-                    timestamp_us / 1000000.0
-                )  # Convert microseconds to seconds
+                if msg_type != STREAM_MSG_FRAME:
+                    print(f"\nUnexpected message type {msg_type}, dropping session")
+                    break
 
-                # Convert frame to OpenCV format
-                cv_frame = self.convert_to_opencv_frame(frame_buffer)
-                if cv_frame is not None:
-                    frames.append(cv_frame)
+                # Waits while every slot is with the worker, which stops reading
+                # this camera's socket and pushes back on it through TCP
+                slot = await session.free_slots.get()
+                view, replaced = slot.reserve(data_size)
+                if replaced is not None:
+                    # The worker would otherwise keep the old block mapped
+                    tasks.put((TASK_DETACH, session.key, replaced))
+                if not await self.receive_into(client_socket, view):
+                    view.release()
+                    session.free_slots.put_nowait(slot)
+                    disconnected = True
+                    break
+                view.release()
 
-                    # Initialize video writer on first frame
-                    if video_writer is None:
-                        output_path = self.create_output_path()
-                        fourcc = cv2.VideoWriter_fourcc(*"mp4v")
-                        video_writer = cv2.VideoWriter(
-                            output_path,
-                            fourcc,
-                            30.0,  # FPS
-                            (frame_buffer.width, frame_buffer.height),
-                        )
-                        print(f"Started recording to: {output_path}")
+                received_ns = time.monotonic_ns()
+                TRACER.record("receive", receive_ns, received_ns, session.received_count)
 
-                    # Write frame to video
-                    video_writer.write(cv_frame)
+                # Capture to arrival, only meaningful with NTP-synced clocks
+                timestamp = timestamp_us / 1000000.0
+                transit_ns = int((time.time() - timestamp) * 1e9)
+                if transit_ns >= 0:
+                    TRACER.record(
+                        "transit", received_ns - transit_ns, received_ns, session.received_count
+                    )
 
-                    # Process frame and send analysis back
-                    analysis_result = self.process_frame(cv_frame, frame_buffer)
-                    self.send_analysis_result(client_socket, analysis_result)
+                tasks.put(
+                    (
+                        TASK_FRAME,
+                        session.key,
+                        slot.slot_id,
+                        slot.shm.name,
+                        frametype,
+                        width,
+                        height,
+                        stride,
+                        data_size,
+                        timestamp,
+                        session.received_count,
+                    )
+                )
+                session.received_count += 1
 
                 print(
-                    f"\rReceived frame {len(frames)} ({width}x{height}, type={frametype})     ",
+                    f"\rReceived frame {session.received_count} ({width}x{height}, type={frametype})     ",
                     end="",
                     flush=True,
                 )
 
+            # Keep a resumable session's worker state for the reconnect
+            if disconnected and session.info.session_id != 0 and self.running:
+                self.suspend_session(session)
+                session = None
+                return
+
+            # Let the worker drain before reporting, so the count is final
+            frame_count, failed = await self.finish_session(session)
+            closed, session = session, None
+            if failed:
+                status = STREAM_RESULT_ERROR
+
+            # One result per session, after the end-of-stream marker
+            if status == STREAM_RESULT_OK:
+                if closed.info.session_id != 0:
+                    self.completed[closed.info.session_id] = (
+                        time.monotonic(), status, frame_count, b"DONE"
+                    )
+                await self.send_analysis_result(client_socket, status, frame_count, b"DONE")
+
         except Exception as e:
             print(f"\nError handling client {client_address}: {e}")
 
         finally:
-            if video_writer:
-                video_writer.release()
-                if output_path and os.path.exists(output_path):
-                    file_size = os.path.getsize(output_path) / (1024 * 1024)  # MB
-                    print(
-                        f"\nVideo saved: {output_path} ({file_size:.1f} MB, {len(frames)} frames)"
-                    )
+            if session is not None:
+                await self.finish_session(session)
 
             client_socket.close()
             print(f"Client {client_address} disconnected")
 
-    def receive_exact(self, sock: socket.socket, size: int) -> Optional[bytes]:
-        """Receive exactly 'size' bytes from socket"""
-        data = b""
-        while len(data) < size:
-            try:
-                chunk = sock.recv(size - len(data))
-                if not chunk:
-                    return None
-                data += chunk
-            except socket.error:
-                return None
-        return data
+            if TRACER.enabled:
+                TRACER.record("session", session_ns, time.monotonic_ns())
+                print(f"Latency: {TRACER.summary(session_ns)}")
+                self.dump_trace()
 
-    def convert_to_opencv_frame(
-        self, frame_buffer: FrameBuffer
-    ) -> Optional[np.ndarray]:
-        """Convert frame buffer to OpenCV format"""
-        try:
-            if frame_buffer.frametype == CAMERA_FRAMETYPE_RGB8888:
-                # RGB8888 -> BGR (OpenCV uses BGR)
-                data_array = np.frombuffer(frame_buffer.data, dtype=np.uint8)
-                # Reshape and handle stride
-                frame = data_array[: frame_buffer.height * frame_buffer.stride].reshape(
-                    frame_buffer.height, frame_buffer.stride
-                )
-                # Extract RGB data (ignore alpha channel)
-                rgb_frame = frame[:, : frame_buffer.width * 4].reshape(
-                    frame_buffer.height, frame_buffer.width, 4
-                )[:, :, :3]
-                # Convert RGB to BGR
-                bgr_frame = cv2.cvtColor(rgb_frame, cv2.COLOR_RGB2BGR)
-                return bgr_frame
-
-            elif frame_buffer.frametype == CAMERA_FRAMETYPE_BGR8888:
-                # BGR8888 -> BGR (remove alpha)
-                data_array = np.frombuffer(frame_buffer.data, dtype=np.uint8)
-                frame = data_array[: frame_buffer.height * frame_buffer.stride].reshape(
-                    frame_buffer.height, frame_buffer.stride
-                )
-                # Extract BGR data (ignore alpha channel)
-                bgr_frame = frame[:, : frame_buffer.width * 4].reshape(
-                    frame_buffer.height, frame_buffer.width, 4
-                )[:, :, :3]
-                return bgr_frame
-
-            elif frame_buffer.frametype == CAMERA_FRAMETYPE_YCBYCR:
-                # YUV422 -> BGR
-                data_array = np.frombuffer(frame_buffer.data, dtype=np.uint8)
-                yuv_frame = data_array[
-                    : frame_buffer.height * frame_buffer.stride
-                ].reshape(frame_buffer.height, frame_buffer.stride)
-                # This is simplified - actual YUV422 conversion is more complex
-                # For now, just take the Y channel and replicate
-                y_data = yuv_frame[:, ::2]  # Y samples
-                gray_frame = cv2.resize(
-                    y_data, (frame_buffer.width, frame_buffer.height)
-                )
-                bgr_frame = cv2.cvtColor(gray_frame, cv2.COLOR_GRAY2BGR)
-                return bgr_frame
-
-            elif frame_buffer.frametype == CAMERA_FRAMETYPE_CBYCRY:
-                # Similar to YCBYCR but different ordering
-                data_array = np.frombuffer(frame_buffer.data, dtype=np.uint8)
-                yuv_frame = data_array[
-                    : frame_buffer.height * frame_buffer.stride
-                ].reshape(frame_buffer.height, frame_buffer.stride)
-                # Simplified conversion
-                y_data = yuv_frame[:, 1::2]  # Y samples (different offset)
-                gray_frame = cv2.resize(
-                    y_data, (frame_buffer.width, frame_buffer.height)
-                )
-                bgr_frame = cv2.cvtColor(gray_frame, cv2.COLOR_GRAY2BGR)
-                return bgr_frame
+    def suspend_session(self, session: ClientSession):
+        """Park an interrupted session until it is resumed or expires"""
+        session.suspended_at = time.monotonic()
+        previous = self.suspended.pop(session.info.session_id, None)
+        self.suspended[session.info.session_id] = session
+        if previous is not None:
+            self.loop.create_task(self.finish_session(previous))
+        print(
+            f"Session {session.info.session_id} suspended after {session.received_count} frames"
+        )
 
-            else:
-                print(f"Unsupported frame type: {frame_buffer.frametype}")
-                return None
+    async def resend_result(self, client_socket: socket.socket, session_id: int):
+        """Resume a finished session: take its end of stream, repeat its result"""
+        _, status, frame_count, payload = self.completed[session_id]
+        print(f"Session {session_id} already finished, sending its result again")
+        await self.send_analysis_result(
+            client_socket, STREAM_RESULT_OK, frame_count, b"", STREAM_MSG_RESUME
+        )
 
-        except Exception as e:
-            print(f"Error converting frame: {e}")
+        # Every frame is in, so the client's next message is its end of stream
+        header_data = await self.receive_exact(client_socket, FRAME_HEADER.size)
+        if not header_data or FRAME_HEADER.unpack(header_data)[0] != STREAM_MSG_END_OF_STREAM:
+            print(f"Session {session_id} sent more frames after finishing, dropping it")
+            return
+        await self.send_analysis_result(client_socket, status, frame_count, payload)
+
+    def expire_suspended(self):
+        """Close sessions that were never resumed, forget old results"""
+        now = time.monotonic()
+        forgotten = [
+            session_id
+            for session_id, (finished_at, _, _, _) in self.completed.items()
+            if now - finished_at > RESUME_TIMEOUT_S
+        ]
+        for session_id in forgotten:
+            del self.completed[session_id]
+
+        expired = [
+            session_id
+            for session_id, session in self.suspended.items()
+            if now - session.suspended_at > RESUME_TIMEOUT_S
+        ]
+        for session_id in expired:
+            print(f"Session {session_id} was not resumed, closing its recording")
+            self.loop.create_task(self.finish_session(self.suspended.pop(session_id)))
+
+    async def receive_session_header(
+        self, client_socket: socket.socket
+    ) -> Optional[SessionInfo]:
+        """Receive and validate the session header"""
+        header_data = await self.receive_exact(client_socket, SESSION_HEADER.size)
+        if not header_data:
             return None
 
-    def create_output_path(self) -> str:
-        """Create output path for MP4 file"""
-        timestamp = time.strftime("%Y%m%d_%H%M%S")
-        filename = f"camera_recording_{timestamp}.mp4"
+        (
+            magic,
+            version,
+            header_size,
+            flags,
+            temperature_centi,
+            pressure_centi,
+            session_id,
+            button_press_time_us,
+        ) = SESSION_HEADER.unpack(header_data)
 
-        # Try to save in current directory, fallback to temp
-        try:
-            output_path = os.path.join(os.getcwd(), filename)
-            # Test write access
-            with open(output_path, "w") as test_file:
-                pass
-            os.remove(output_path)
-            return output_path
-        except:
-            return os.path.join(tempfile.gettempdir(), filename)
-
-    def process_frame(self, cv_frame: np.ndarray, frame_buffer: FrameBuffer) -> dict:
-        """Process frame and return analysis results"""
-        # For now, just return basic frame information
-        # This is where you would add your actual analysis logic
-
-        analysis = {
-            "timestamp": frame_buffer.timestamp,
-            "width": frame_buffer.width,
-            "height": frame_buffer.height,
-            "frametype": frame_buffer.frametype,
-            "mean_intensity": float(np.mean(cv_frame)),
-            "std_intensity": float(np.std(cv_frame)),
-            # Add more analysis results here as needed
-        }
-
-        return analysis
-
-    def send_analysis_result(self, client_socket: socket.socket, analysis: dict):
-        """Send analysis results back to client"""
+        if magic != STREAM_PROTOCOL_MAGIC or version != STREAM_PROTOCOL_VERSION:
+            print(f"Rejecting session: magic=0x{magic:08x} version={version}")
+            return None
+
+        # Newer minor revisions may append fields; skip what we don't know
+        if header_size > SESSION_HEADER.size:
+            if not await self.receive_exact(client_socket, header_size - SESSION_HEADER.size):
+                return None
+
+        return SessionInfo(
+            temperature_centi / 100.0,
+            pressure_centi / 100.0,
+            button_press_time_us / 1000000.0,
+            flags,
+            session_id,
+        )
+
+    async def receive_into(self, sock: socket.socket, view: memoryview) -> bool:
+        """Fill 'view' from the socket, False if the connection closed first"""
+        received = 0
+        while received < len(view):
+            try:
+                count = await self.loop.sock_recv_into(sock, view[received:])
+            except InterruptedError:
+                continue
+            except OSError:
+                return False
+            if count == 0:
+                return False
+            received += count
+        return True
+
+    async def receive_exact(self, sock: socket.socket, size: int) -> Optional[bytes]:
+        """Receive exactly 'size' bytes from socket"""
+        data = bytearray(size)
+        if not await self.receive_into(sock, memoryview(data)):
+            return None
+        return bytes(data)
+
+    async def send_analysis_result(
+        self,
+        client_socket: socket.socket,
+        status: int,
+        frames_received: int,
+        payload: bytes,
+        msg_type: int = STREAM_MSG_RESULT,
+    ):
+        """Send the session result (or a resume reply) back to client"""
         try:
-            # For now, just send a simple acknowledgment
-            # You can expand this to send actual analysis data
-            response = b"ACK"
-            client_socket.send(struct.pack("!I", len(response)))
-            client_socket.send(response)
+            payload = payload[:STREAM_RESULT_MAX_PAYLOAD]
+            header = RESULT_HEADER.pack(
+                msg_type, status, frames_received, len(payload)
+            )
+            await self.loop.sock_sendall(client_socket, header + payload)
         except Exception as e:
             print(f"Failed to send analysis result: {e}")
 
+    def dump_trace(self):
+        """Refresh the trace file with the spans recorded so far"""
+        if self.trace_path is None:
+            return
+        try:
+            TRACER.dump_chrome(self.trace_path)
+        except OSError as e:
+            print(f"Failed to write trace to {self.trace_path}: {e}")
+
     def stop_server(self):
         """Stop the server"""
         self.running = False
@@ -300,17 +1142,73 @@ class ProcessingServer:
     def cleanup(self):
         """Cleanup resources"""
         self.stop_server()
+
+        # Workers close every recording they still hold on the way out
+        for tasks in self.worker_tasks:
+            tasks.put(None)
+        for worker in self.workers:
+            worker.join()
+        self.workers = []
+        self.worker_tasks = []
+        if self.results_thread is not None:
+            self.results.put(None)
+            self.results_thread.join()
+            self.results_thread = None
+
+        for session in list(self.sessions.values()):
+            session.close()
+        self.sessions.clear()
+        self.suspended.clear()
+        self.completed.clear()
+        self.dump_trace()
         print("Server stopped")
 
 
 def main():
     parser = argparse.ArgumentParser(description="Camera processing server")
     parser.add_argument("--host", default="0.0.0.0", help="Server host address")
-    parser.add_argument("--port", type=int, default=8888, help="Server port")
+    parser.add_argument(
+        "--port", type=int, default=STREAM_PROTOCOL_DEFAULT_PORT, help="Server port"
+    )
+    parser.add_argument(
+        "--queue-depth",
+        type=int,
+        default=8,
+        help="Frames buffered per client before its socket stops being read",
+    )
+    parser.add_argument(
+        "--preview-frames",
+        type=int,
+        default=0,
+        help="Most recent analysed frames kept per session (0 disables)",
+    )
+    parser.add_argument(
+        "--workers",
+        type=int,
+        default=os.cpu_count() or 1,
+        help="Worker processes for conversion, analysis and encoding",
+    )
+    parser.add_argument(
+        "--backlog", type=int, default=128, help="Pending connections the listener queues"
+    )
+    parser.add_argument(
+        "--trace",
+        metavar="PATH",
+        help="Record latency spans and write them as a Chrome trace after each session",
+    )
 
     args = parser.parse_args()
 
-    server = ProcessingServer(args.host, args.port)
+    TRACER.enabled = args.trace is not None
+    server = ProcessingServer(
+        args.host,
+        args.port,
+        max(1, args.queue_depth),
+        args.preview_frames,
+        args.trace,
+        args.workers,
+        args.backlog,
+    )
 
     try:
         server.start_server()